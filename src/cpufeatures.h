@@ -0,0 +1,50 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 Hans-Peter Schadler <hps@abyle.org>
+**
+** This program is free software: you can redistribute it and/or modify it
+** under the terms of the GNU General Public License as published by the Free
+** Software Foundation, either version 3 of the License, or (at your option)
+** any later version.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT
+** ANY WARRANTY; without even the implied warranty of  MERCHANTABILITY or
+** FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+** more details.
+**
+** You should have received a copy of the GNU General Public License along with
+** this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+****************************************************************************/
+
+
+#pragma once
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    #define QWORLDPARSER_X86_SIMD
+#endif
+
+// Runtime detection of the instruction sets used by the SIMD kernels.
+// Kernels are compiled with target attributes, so the binary itself
+// does not require any of these extensions.
+class CpuFeatures
+{
+public:
+    static bool hasSse2()
+    {
+#ifdef QWORLDPARSER_X86_SIMD
+        return __builtin_cpu_supports("sse2");
+#else
+        return false;
+#endif
+    }
+
+    static bool hasAvx2()
+    {
+#ifdef QWORLDPARSER_X86_SIMD
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt");
+#else
+        return false;
+#endif
+    }
+};
@@ -20,15 +20,87 @@
 #pragma once
 
 #include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <functional>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
+#include "mesh.hpp"
 #include "point.hpp"
+#include "point2.hpp"
+#include "predicates.hpp"
+#include "spatialsort.hpp"
 #include "triangle.hpp"
+#include "vertexbuffer.hpp"
+
+// Incremental Bowyer-Watson triangulation. The triangles are kept with their
+// neighbours, a new point is located by walking from the last created triangle
+// towards it and the triangles whose circumcircle contains the point are found
+// by a flood fill over the neighbours of the containing triangle. Points equal
+// to an already inserted point are skipped.
+//
+// The orientation and in-circle tests use the exact predicates of Predicates,
+// so the triangulation only depends on the point coordinates and not on the
+// rounding of the tests. Points on a circumcircle, like the corners of a grid
+// cell, count as inside.
+//
+// Unless disabled with setSpatialSort(), the points are inserted in a biased
+// randomized order along a Hilbert curve (SpatialSort::brio()) instead of the
+// given order, which keeps the walks short and the working set in cache. The
+// triangles still carry the given points and ids.
+//
+// The result is a Mesh sharing the given points as its vertex array, its
+// triangles refer to the points by their position in that array.
+// Coordinates keep the precision of F. The working triangulation holds them
+// as Point2 without the ids, which stay with the mesh vertices.
+//
+// With setThreads() the points are split into vertical strips which are
+// triangulated concurrently. A triangle of a strip whose circumcircle stays
+// within the strip has no point of another strip inside and is a triangle of
+// the whole triangulation, unless a corner of the super triangle of all points
+// lies inside, which only happens at the hull. The rest lies along the strip borders: the points
+// not settled that way are triangulated once more together, and the triangles
+// of that pass outside the settled ones fill the gaps.
+//
+// Constraints are edges between two of the points which the triangulation has
+// to contain, like breaklines or the border of a segment. They are inserted
+// after the points by flipping the edges they cross, points lying on a
+// constraint split it. The triangles are then flipped back to Delaunay where
+// no constraint is in the way (constrained Delaunay triangulation). The
+// triangles of holes and, with setRemoveOutside(), those outside the
+// constraints are left out of the mesh. Constraints are inserted in one piece,
+// with them the strips of setThreads() are not used.
+//
+// With setEditable() the working triangulation is kept after triangulate(),
+// insert() and remove() then repair the triangles around the point and patch
+// the mesh in place: the triangles of the cavity are rewritten, new ones are
+// appended or fill freed slots and left over slots are filled with the last
+// triangles. getChangedTriangles() lists the mesh triangles written by the
+// last edit, the others keep their index. Constraints bound the cavity of an
+// inserted point, a point on a constraint splits it.
+//
+// The working state lives in buffers which are freed after each
+// triangulation. With a Workspace set they are taken from it and given back
+// with their capacity instead, so a series of triangulations, like one per
+// export segment, allocates only while the buffers still grow.
+class TinBuilder;
+template <class F> class StreamingDelaunay;
 
 template <class F>
 class Delaunay
 {
+    friend class TinBuilder;
+    friend class StreamingDelaunay<F>;
+
 public:
     Delaunay()
         :Delaunay(std::vector<Point<F> >{})
@@ -37,40 +109,348 @@ public:
     Delaunay(const std::vector<Point<F> > &points);
 
     void setPoints(const std::vector<Point<F> > &points) {
-        m_points = points;
-        m_triangles.clear();
-        std::cout << "Delaunnay new initialized with " << m_points.size() << " points" << std::endl;
+        m_mesh.setVertices(points);
+        std::cout << "Delaunnay new initialized with " << points.size() << " points" << std::endl;
+    }
+
+    // The x and y coordinates and the ids of the vertices, z is not used
+    void setPoints(const VertexBuffer<F>& vertices) {
+        setPoints(vertices.toPoints());
     }
 
+    // Insert the points in spatially coherent order (default) or in the given order
+    void setSpatialSort(const bool spatialSort) { m_spatialSort = spatialSort; }
+    bool getSpatialSort() const { return m_spatialSort; }
+
+    // Triangulate in up to threads strips concurrently, threads = 0 uses all hardware threads.
+    // Strips have at least MIN_STRIP_SIZE points, smaller inputs are triangulated in one piece.
+    void setThreads(const unsigned threads) { m_threads = threads; }
+    unsigned getThreads() const { return m_threads; }
+
+    static const unsigned MIN_STRIP_SIZE = 8192;
+
+    // Working buffers which can be kept across triangulations
+    class Workspace;
+
+    // Triangulate with the buffers of workspace and leave them there afterwards, nullptr frees
+    // them after each triangulation (default). A workspace serves one triangulation at a time.
+    void setWorkspace(Workspace* workspace) { m_workspace = workspace; }
+    Workspace* getWorkspace() const { return m_workspace; }
+
+    // Edges between the points with the given indices which the triangulation has to contain.
+    // Constraints crossing an earlier one are skipped.
+    void setConstraints(const std::vector<std::pair<unsigned, unsigned>>& constraints) { m_constraints = constraints; }
+    const std::vector<std::pair<unsigned, unsigned>>& getConstraints() const { return m_constraints; }
+
+    // Points inside holes, the triangles reachable from them without crossing a constraint are removed
+    void setHoles(const std::vector<Point<F>>& holes) { m_holes = holes; }
+    const std::vector<Point<F>>& getHoles() const { return m_holes; }
+
+    // Remove the triangles reachable from the convex hull without crossing a constraint
+    void setRemoveOutside(const bool removeOutside) { m_removeOutside = removeOutside; }
+    bool getRemoveOutside() const { return m_removeOutside; }
+
     void triangulate();
 
+    // Triangulation of the points, counter-clockwise
+    const Mesh<F>& getMesh() const { return m_mesh; }
+
+    // Keep the working triangulation after triangulate() for insert() and remove(), it is
+    // triangulated in one piece then
+    void setEditable(const bool editable) { m_editable = editable; }
+    bool getEditable() const { return m_editable; }
+
+    // Insert a point into an editable triangulation, it becomes the last mesh vertex.
+    // Returns false for a point equal to a vertex or outside the super triangle.
+    bool insert(const Point<F>& point);
+
+    // Remove the mesh vertex from an editable triangulation, the vertex itself stays in the
+    // mesh without triangles and the constraints ending at it are dropped. Returns false if
+    // it is not part of the triangulation.
+    bool remove(const uint32_t vertex);
+
+    // Mesh triangles created or rewritten by the last insert() or remove()
+    const std::vector<uint32_t>& getChangedTriangles() const { return m_changedTriangles; }
+
+    // Copies of the mesh triangles with their corner points
     std::vector<Triangle<Point<F>, F> > getTriangles() const;
 
+    // True if edge e (opposite corner e) of mesh triangle t lies on a constraint
+    bool isConstrainedEdge(const uint32_t t, const unsigned e) const {
+        return t < m_constrainedEdges.size() && (m_constrainedEdges[t] >> e) & 1;
+    }
+
 private:
+    // Working vertex, the ids are those of the mesh vertices at m_order
+    typedef Point2<F> Vertex;
+
+    // Triangle of the working triangulation. Vertices are indices into m_vertices in
+    // counter-clockwise order, neighbour[i] is the cell across the edge opposite vertex[i].
+    struct Cell {
+        unsigned vertex[3];
+        int neighbour[3];
+        bool alive;
+        bool removed;               // in a hole or outside the constraints
+        unsigned char constrained;  // bit e is set if edge e lies on a constraint
+
+        int indexOf(const unsigned v) const { return (vertex[0] == v) ? 0 : (vertex[1] == v) ? 1 : 2; }
+    };
+
+    // Edge of the cavity boundary, counter-clockwise as seen from the inserted point
+    struct BoundaryEdge {
+        unsigned from;
+        unsigned to;
+        int outside;        // cell beyond the edge, -1 on the border of the super triangle
+        int outsideEdge;    // index of the edge in the outside cell
+        bool removed;       // the cavity cell of the edge was in a hole or outside the constraints
+    };
+
+    // Edge of the polygon left by a removed vertex, with the cell on its outer side
+    struct PolygonEdge {
+        int cell;
+        int edge;
+        unsigned char constrained;
+    };
+
     void bowyerWatson();
 
-    std::vector<Point<F>> m_points;
-    std::vector<Triangle<Point<F>, F> > m_triangles;
+    // Building blocks of bowyerWatson(), also used by TinBuilder and StreamingDelaunay to insert points one by one
+    void initCells(const Triangle<Point<F>, F>& superTriangle, const std::size_t pointCount);
+    bool appendVertex(const Vertex& point);
+    void extractMesh();
+    void releaseCells();
+    bool isInnerCell(const std::size_t c) const {
+        const Cell& cell = m_cells[c];
+        return cell.alive && not cell.removed && cell.vertex[0] >= SUPER_VERTICES && cell.vertex[1] >= SUPER_VERTICES && cell.vertex[2] >= SUPER_VERTICES;
+    }
+    static Triangle<Point<F>, F> superTriangle(const F minX, const F minY, const F maxX, const F maxY);
+    void triangulateStrips(const unsigned strips);
+    static void partitionByX(const std::vector<Point<F>>& points, std::vector<unsigned>::iterator begin,
+                             std::vector<unsigned>::iterator end, const unsigned strips,
+                             std::vector<std::vector<unsigned>::iterator>& splits);
+    static bool isInsideSlab(const Vertex& a, const Vertex& b, const Vertex& c, const double lo, const double hi);
+
+    bool insertVertex(const unsigned v);
+    int locate(const Vertex& p);
+    void findCavity(const unsigned v, const int start);
+    void collectBoundary();
+    int newCell();
+
+    // Constrained triangulation on the cells after all points are inserted
+    void insertConstraints();
+    bool insertConstraint(unsigned a, const unsigned b);
+    int findVertex(const Vertex& p);
+    void vertexRing(const unsigned v);
+    int findEdge(const unsigned u, const unsigned v, int& edge);
+    void markConstrained(const unsigned u, const unsigned v);
+    void flip(const int c, const int e);
+    void restoreDelaunay();
+    void flipEdges(std::vector<std::pair<int, int>>& edges, std::vector<int>* flipped);
+    void removeRegions();
+
+    // Editing of the kept triangulation
+    void updateMesh();
+    void linkEdge(const int c, const int e, const PolygonEdge& edge);
+    int findEar(const std::vector<unsigned>& polygon, const bool emptyCircle) const;
+    static bool isAhead(const Vertex& a, const Vertex& b, const Vertex& c);
+
+    static double orient(const Vertex& a, const Vertex& b, const Vertex& c);
+    static double inCircle(const Vertex& a, const Vertex& b, const Vertex& c, const Vertex& d);
+
+    Mesh<F> m_mesh;
+    bool m_spatialSort;
+    unsigned m_threads;
+    std::vector<unsigned> m_skipped;      // mesh vertices skipped as duplicates
+    Workspace* m_workspace;
+    std::vector<std::pair<unsigned, unsigned>> m_constraints;
+    std::vector<Point<F>> m_holes;
+    bool m_removeOutside;
+    std::vector<uint8_t> m_constrainedEdges;  // per mesh triangle, bit e is set if edge e lies on a constraint
+    bool m_editable;
+    std::vector<unsigned> m_workingVertex;    // vertex in m_vertices of each mesh vertex, NO_VERTEX if not triangulated
+    std::vector<int32_t> m_cellTriangle;      // mesh triangle of each cell, Mesh::NO_NEIGHBOUR if none
+    std::vector<uint32_t> m_triangleCell;     // cell of each mesh triangle
+    std::vector<uint32_t> m_changedTriangles;
+    std::vector<int> m_touchedCells;          // cells changed by an edit
+    static const unsigned NO_VERTEX = std::numeric_limits<unsigned>::max();
     Triangle<Point<F>, F> constructSuperTriangle();
+
+    // working state of bowyerWatson(): the super triangle corners followed by the points in insertion order
+    static const unsigned SUPER_VERTICES = 3;
+    std::vector<Vertex> m_vertices;
+    std::vector<unsigned> m_order;        // position in the mesh vertices of the inserted point m_vertices[SUPER_VERTICES + i]
+    std::vector<Cell> m_cells;
+    std::vector<int> m_freeCells;
+    int m_lastCell;
+    uint32_t m_walkState;
+
+    std::vector<int> m_cavity;
+    std::vector<BoundaryEdge> m_boundary;
+    std::vector<int> m_newCells;
+    std::vector<unsigned> m_badStamp;     // cell is part of the current cavity if equal to m_stamp
+    std::vector<unsigned> m_testedStamp;  // cell was tested against the current point if equal to m_stamp
+    std::vector<int> m_startCell;         // new cell whose boundary edge starts at the vertex
+    std::vector<unsigned> m_startStamp;   // m_startCell entry is valid if equal to m_stamp
+    unsigned m_stamp;
+
+    std::vector<int> m_vertexCell;        // a cell around each vertex, kept while inserting the constraints
+    std::vector<int> m_ring;              // cells around a vertex, see vertexRing()
+    std::vector<std::pair<unsigned, unsigned>> m_splitConstraints;  // constraints the current point lies on
 };
 
+template <class F>
+const unsigned Delaunay<F>::NO_VERTEX;
+
+template <class F>
+class Delaunay<F>::Workspace
+{
+    friend class Delaunay<F>;
+
+public:
+    // Bytes held by the buffers, those of the strips included
+    std::size_t getMemoryUsage() const;
+
+    // Free the buffers
+    void release() { *this = Workspace(); }
+
+private:
+    // Exchange the buffers with the working state of delaunay
+    void swap(Delaunay<F>& delaunay);
+    Workspace& strip(const std::size_t s);
+
+    std::vector<Vertex> m_vertices;
+    std::vector<unsigned> m_order;
+    std::vector<Cell> m_cells;
+    std::vector<int> m_freeCells;
+    std::vector<int> m_cavity;
+    std::vector<BoundaryEdge> m_boundary;
+    std::vector<int> m_newCells;
+    std::vector<unsigned> m_badStamp;
+    std::vector<unsigned> m_testedStamp;
+    std::vector<int> m_startCell;
+    std::vector<unsigned> m_startStamp;
+    std::vector<int> m_vertexCell;
+    std::vector<int> m_ring;
+    std::vector<std::unique_ptr<Workspace>> m_strips;   // for the strips and the border pass of setThreads()
+};
+
+template <class F>
+std::size_t Delaunay<F>::Workspace::getMemoryUsage() const
+{
+    std::size_t bytes = m_vertices.capacity()*sizeof(Vertex)
+                      + m_order.capacity()*sizeof(unsigned)
+                      + m_cells.capacity()*sizeof(Cell)
+                      + m_freeCells.capacity()*sizeof(int)
+                      + m_cavity.capacity()*sizeof(int)
+                      + m_boundary.capacity()*sizeof(BoundaryEdge)
+                      + m_newCells.capacity()*sizeof(int)
+                      + m_badStamp.capacity()*sizeof(unsigned)
+                      + m_testedStamp.capacity()*sizeof(unsigned)
+                      + m_startCell.capacity()*sizeof(int)
+                      + m_startStamp.capacity()*sizeof(unsigned)
+                      + m_vertexCell.capacity()*sizeof(int)
+                      + m_ring.capacity()*sizeof(int);
+    for (const auto& strip : m_strips) {
+        bytes += strip->getMemoryUsage();
+    }
+    return bytes;
+}
+
+template <class F>
+void Delaunay<F>::Workspace::swap(Delaunay<F>& delaunay)
+{
+    m_vertices.swap(delaunay.m_vertices);
+    m_order.swap(delaunay.m_order);
+    m_cells.swap(delaunay.m_cells);
+    m_freeCells.swap(delaunay.m_freeCells);
+    m_cavity.swap(delaunay.m_cavity);
+    m_boundary.swap(delaunay.m_boundary);
+    m_newCells.swap(delaunay.m_newCells);
+    m_badStamp.swap(delaunay.m_badStamp);
+    m_testedStamp.swap(delaunay.m_testedStamp);
+    m_startCell.swap(delaunay.m_startCell);
+    m_startStamp.swap(delaunay.m_startStamp);
+    m_vertexCell.swap(delaunay.m_vertexCell);
+    m_ring.swap(delaunay.m_ring);
+}
+
+template <class F>
+typename Delaunay<F>::Workspace& Delaunay<F>::Workspace::strip(const std::size_t s)
+{
+    while (m_strips.size() <= s) {
+        m_strips.push_back(std::unique_ptr<Workspace>(new Workspace()));
+    }
+    return *m_strips[s];
+}
+
 template <class F>
 Delaunay<F>::Delaunay(const std::vector<Point<F> > &points) :
-    m_points(points)
+    m_mesh(points),
+    m_spatialSort(true),
+    m_threads(1),
+    m_workspace(nullptr),
+    m_removeOutside(false),
+    m_editable(false),
+    m_lastCell(-1),
+    m_walkState(2463534242u),
+    m_stamp(0)
 {
-    std::cout << "Delaunnay initialized with " << m_points.size() << " points" << std::endl;
+    if (not points.empty()) {
+        std::cout << "Delaunnay initialized with " << points.size() << " points" << std::endl;
+    }
 }
 
 template <class F>
 void Delaunay<F>::triangulate()
 {
-    bowyerWatson();
+    // the triangulation kept for editing is replaced
+    if (not m_cells.empty()) {
+        releaseCells();
+    }
+
+    unsigned threads = m_threads;
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    unsigned strips = std::min<std::size_t>(threads, m_mesh.getVertexCount()/MIN_STRIP_SIZE);
+    if (not m_constraints.empty() || not m_holes.empty() || m_removeOutside || m_editable) {
+        strips = 1;
+    }
+
+    if (strips > 1) {
+        triangulateStrips(strips);
+    } else {
+        bowyerWatson();
+    }
+
+    if (not m_skipped.empty()) {
+        std::cout << "Delaunay::triangulate(): Skipped " << m_skipped.size() << " duplicate points" << std::endl;
+    }
 }
 
 template <class F>
 std::vector<Triangle<Point<F>, F> > Delaunay<F>::getTriangles() const
 {
-    return m_triangles;
+    std::vector<Triangle<Point<F>, F> > triangles;
+    triangles.reserve(m_mesh.getTriangleCount());
+    for (uint32_t t = 0; t < m_mesh.getTriangleCount(); t++) {
+        triangles.push_back(m_mesh.getTriangle(t));
+    }
+    return triangles;
+}
+
+template <class F>
+inline double Delaunay<F>::orient(const Vertex& a, const Vertex& b, const Vertex& c)
+{
+    // > 0 if a, b, c are counter-clockwise, exact sign
+    return Predicates::orient2d(a, b, c);
+}
+
+template <class F>
+inline double Delaunay<F>::inCircle(const Vertex& a, const Vertex& b, const Vertex& c, const Vertex& d)
+{
+    // > 0 if d lies inside the circumcircle of the counter-clockwise triangle a, b, c, exact sign
+    return Predicates::incircle(a, b, c, d);
 }
 
 template <class F>
@@ -78,113 +458,1432 @@ void Delaunay<F>::bowyerWatson()
 {
 // https://en.wikipedia.org/wiki/Bowyer%E2%80%93Watson_algorithm
 //    function BowyerWatson (pointList)
-//       // pointList is a set of coordinates defining the points to be triangulated
 //       triangulation := empty triangle mesh data structure
 //       add super-triangle to triangulation // must be large enough to completely contain all the points in pointList
 //       for each point in pointList do // add all the points one at a time to the triangulation
-//          badTriangles := empty set
-//          for each triangle in triangulation do // first find all the triangles that are no longer valid due to the insertion
-//             if point is inside circumcircle of triangle
-//                add triangle to badTriangles
-//          polygon := empty set
-//          for each triangle in badTriangles do // find the boundary of the polygonal hole
-//             for each edge in triangle do
-//                if edge is not shared by any other triangles in badTriangles
-//                   add edge to polygon
-//          for each triangle in badTriangles do // remove them from the data structure
-//             remove triangle from triangulation
-//          for each edge in polygon do // re-triangulate the polygonal hole
-//             newTri := form a triangle from edge to point
-//             add newTri to triangulation
+//          find the triangle containing the point // walk from the last created triangle
+//          badTriangles := triangles whose circumcircle contains the point
+//                          // flood fill over the neighbours, they form a connected cavity
+//          polygon := edges of badTriangles next to a triangle which is not bad
+//          re-triangulate the polygonal hole with the point, reusing the slots of badTriangles
 //       for each triangle in triangulation // done inserting points, now clean up
 //          if triangle contains a vertex from original super-triangle
 //             remove triangle from triangulation
 //       return triangulation
 
-    m_triangles.clear();
-
-    Triangle<Point<F>, F> superTriangle = constructSuperTriangle();
-    std::cout << "Super Triangle coordinates:" << std::endl;
-    std::cout << superTriangle << std::endl;
-    m_triangles.push_back(superTriangle);
-
-    for (auto& p : m_points) {
-        std::vector<Triangle<Point<F>, F>> badTriangles;
-        std::vector<Edge<Point<F>>> edges;
-        // find bad triangles
-        for (auto t_it = m_triangles.begin(); t_it < m_triangles.end(); ++t_it) {
-            if (t_it->isInCircle(p)) {
-               badTriangles.push_back(*t_it);
-               edges.push_back((t_it->getEdge1()));
-               edges.push_back((t_it->getEdge2()));
-               edges.push_back((t_it->getEdge3()));
-               t_it->setIsBad(true);
-            }
-        }
-
-        m_triangles.erase(std::remove_if(begin(m_triangles), end(m_triangles),
-                                         [](Triangle<Point<F>, F>& t) {
-                                            return t.getIsBad();
-                                          }
-                                        ), end(m_triangles));
-
-        // find the boundary of the polygonal hole
-        for (auto edges_it1 = edges.begin(); edges_it1 < edges.end(); ++edges_it1) {
-            for (auto edges_it2 = edges.begin(); edges_it2 < edges.end(); ++edges_it2) {
-            // if edges are not shared by any other triangles in badTriangles add edge to polygon -> remove all edges which are shared
-                if (edges_it1 == edges_it2) {
+    m_mesh.clearTriangles();
+    m_skipped.clear();
+    m_constrainedEdges.clear();
+    m_changedTriangles.clear();
+
+    const std::vector<Point<F>>& points = m_mesh.getVertices();
+    if (points.empty()) {
+        return;
+    }
+
+    const unsigned pointCount = points.size();
+    initCells(constructSuperTriangle(), pointCount);
+    if (m_spatialSort) {
+        SpatialSort::brio(points, m_order);
+    } else {
+        m_order.resize(pointCount);
+        for (unsigned i = 0; i < pointCount; i++) {
+            m_order[i] = i;
+        }
+    }
+
+    // stored in insertion order, vertices created one after the other are close in memory too
+    for (const unsigned i : m_order) {
+        m_vertices.push_back(points[i]);
+    }
+    m_startCell.resize(m_vertices.size(), -1);
+    m_startStamp.resize(m_vertices.size(), 0);
+
+    for (unsigned v = SUPER_VERTICES; v < m_vertices.size(); v++) {
+        if (not insertVertex(v)) {
+            m_skipped.push_back(m_order[v - SUPER_VERTICES]);
+        }
+    }
+
+    if (not m_constraints.empty() || not m_holes.empty() || m_removeOutside) {
+        insertConstraints();
+    }
+
+    extractMesh();
+    if (not m_editable) {
+        releaseCells();
+        return;
+    }
+
+    m_workingVertex.assign(pointCount, NO_VERTEX);
+    for (unsigned v = SUPER_VERTICES; v < m_vertices.size(); v++) {
+        m_workingVertex[m_order[v - SUPER_VERTICES]] = v;
+    }
+    for (const unsigned i : m_skipped) {
+        m_workingVertex[i] = NO_VERTEX;
+    }
+}
+
+template <class F>
+void Delaunay<F>::initCells(const Triangle<Point<F>, F>& superTriangle, const std::size_t pointCount)
+{
+    if (m_workspace != nullptr) {
+        m_workspace->swap(*this);
+    }
+
+    m_cells.clear();
+    m_freeCells.clear();
+    m_badStamp.clear();
+    m_testedStamp.clear();
+    m_stamp = 0;
+
+    m_vertices.clear();
+    m_vertices.reserve(SUPER_VERTICES + pointCount);
+    m_vertices.push_back(superTriangle.getA());
+    m_vertices.push_back(superTriangle.getB());
+    m_vertices.push_back(superTriangle.getC());
+    m_startCell.assign(SUPER_VERTICES, -1);
+    m_startStamp.assign(SUPER_VERTICES, 0);
+
+    Cell super;
+    super.vertex[0] = 0;
+    super.vertex[1] = 1;
+    super.vertex[2] = 2;
+    if (orient(m_vertices[0], m_vertices[1], m_vertices[2]) < 0) {
+        std::swap(super.vertex[1], super.vertex[2]);
+    }
+    super.neighbour[0] = super.neighbour[1] = super.neighbour[2] = -1;
+    super.alive = true;
+    super.removed = false;
+    super.constrained = 0;
+    m_cells.push_back(super);
+    m_badStamp.push_back(0);
+    m_testedStamp.push_back(0);
+    m_lastCell = 0;
+}
+
+template <class F>
+bool Delaunay<F>::appendVertex(const Vertex& point)
+{
+    m_vertices.push_back(point);
+    m_startCell.push_back(-1);
+    m_startStamp.push_back(0);
+    if (not insertVertex(m_vertices.size() - 1)) {
+        m_vertices.pop_back();
+        m_startCell.pop_back();
+        m_startStamp.pop_back();
+        return false;
+    }
+    return true;
+}
+
+template <class F>
+void Delaunay<F>::extractMesh()
+{
+    //          if triangle contains a vertex from original super-triangle
+    //             remove triangle from triangulation
+    // The kept cells are numbered first, so the neighbours can be translated in the same pass.
+    std::vector<int32_t> meshTriangle(m_cells.size(), Mesh<F>::NO_NEIGHBOUR);
+    int32_t triangleCount = 0;
+    for (std::size_t c = 0; c < m_cells.size(); c++) {
+        if (isInnerCell(c)) {
+            meshTriangle[c] = triangleCount++;
+        }
+    }
+
+    m_mesh.clearTriangles();
+    m_mesh.reserveTriangles(triangleCount);
+    m_constrainedEdges.clear();
+    if (not m_constraints.empty()) {
+        m_constrainedEdges.reserve(triangleCount);
+    }
+    for (std::size_t c = 0; c < m_cells.size(); c++) {
+        if (meshTriangle[c] == Mesh<F>::NO_NEIGHBOUR) {
+            continue;
+        }
+        const Cell& cell = m_cells[c];
+        if (not m_constraints.empty()) {
+            m_constrainedEdges.push_back(cell.constrained);
+        }
+        const uint32_t t = m_mesh.addTriangle(m_order[cell.vertex[0] - SUPER_VERTICES], m_order[cell.vertex[1] - SUPER_VERTICES],
+                                              m_order[cell.vertex[2] - SUPER_VERTICES]);
+        for (unsigned e = 0; e < 3; e++) {
+            if (cell.neighbour[e] >= 0) {
+                m_mesh.setNeighbour(t, e, meshTriangle[cell.neighbour[e]]);
+            }
+        }
+    }
+
+    if (m_editable) {
+        m_cellTriangle.swap(meshTriangle);
+        m_triangleCell.resize(triangleCount);
+        for (std::size_t c = 0; c < m_cellTriangle.size(); c++) {
+            if (m_cellTriangle[c] != Mesh<F>::NO_NEIGHBOUR) {
+                m_triangleCell[m_cellTriangle[c]] = c;
+            }
+        }
+    }
+}
+
+template <class F>
+void Delaunay<F>::releaseCells()
+{
+    // Empty buffers go back to the workspace with their capacity, without one they are freed
+    m_vertices.clear();
+    m_order.clear();
+    m_cells.clear();
+    m_freeCells.clear();
+    m_cavity.clear();
+    m_boundary.clear();
+    m_newCells.clear();
+    m_badStamp.clear();
+    m_testedStamp.clear();
+    m_startCell.clear();
+    m_startStamp.clear();
+    m_vertexCell.clear();
+    m_ring.clear();
+    m_workingVertex.clear();
+    m_cellTriangle.clear();
+    m_triangleCell.clear();
+
+    Workspace released;
+    (m_workspace != nullptr ? *m_workspace : released).swap(*this);
+}
+
+template <class F>
+void Delaunay<F>::partitionByX(const std::vector<Point<F>>& points, std::vector<unsigned>::iterator begin,
+                               std::vector<unsigned>::iterator end, const unsigned strips,
+                               std::vector<std::vector<unsigned>::iterator>& splits)
+{
+    // Recursive median split, points with the same x stay in one strip so the strips don't overlap
+    if (strips <= 1 || end - begin < 2) {
+        return;
+    }
+
+    const unsigned leftStrips = strips/2;
+    auto middle = begin + (end - begin)*leftStrips/strips;
+    auto lessX = [&points](const unsigned a, const unsigned b) { return points[a].getX() < points[b].getX(); };
+    std::nth_element(begin, middle, end, lessX);
+    const F split = points[*middle].getX();
+    middle = std::partition(begin, middle, [&points, split](const unsigned a) { return points[a].getX() < split; });
+
+    partitionByX(points, begin, middle, leftStrips, splits);
+    splits.push_back(middle);
+    partitionByX(points, middle, end, strips - leftStrips, splits);
+}
+
+template <class F>
+bool Delaunay<F>::isInsideSlab(const Vertex& a, const Vertex& b, const Vertex& c, const double lo, const double hi)
+{
+    // circumcircle strictly between lo and hi, with a margin for the rounding of center and radius
+    const double bx = double(b.getX()) - a.getX();
+    const double by = double(b.getY()) - a.getY();
+    const double cx = double(c.getX()) - a.getX();
+    const double cy = double(c.getY()) - a.getY();
+    const double d = 2.0*(bx*cy - by*cx);
+    const double b2 = bx*bx + by*by;
+    const double c2 = cx*cx + cy*cy;
+    const double ux = (cy*b2 - by*c2)/d;
+    const double uy = (bx*c2 - cx*b2)/d;
+
+    const double centerX = a.getX() + ux;
+    const double radius = std::sqrt(ux*ux + uy*uy);
+    const double margin = 1e-9*(std::fabs(centerX) + radius);
+    return centerX - radius - margin > lo && centerX + radius + margin < hi;
+}
+
+template <class F>
+void Delaunay<F>::triangulateStrips(const unsigned strips)
+{
+    const std::vector<Point<F>>& points = m_mesh.getVertices();
+    const std::size_t pointCount = points.size();
+    const uint32_t NONE = std::numeric_limits<uint32_t>::max();
+
+    m_mesh.clearTriangles();
+    m_skipped.clear();
+    m_constrainedEdges.clear();
+
+    std::vector<unsigned> order(pointCount);
+    std::iota(order.begin(), order.end(), 0);
+    std::vector<std::vector<unsigned>::iterator> splits;
+    splits.push_back(order.begin());
+    partitionByX(points, order.begin(), order.end(), strips, splits);
+    splits.push_back(order.end());
+    // a split at the smallest x of its range, like in a column of equal x, leaves a strip empty
+    splits.erase(std::unique(splits.begin(), splits.end()), splits.end());
+
+    // Strip s holds the points order[begin[s]..begin[s + 1]). Its slab reaches from the
+    // largest x of all strips before to the smallest x of all strips after.
+    const unsigned stripCount = splits.size() - 1;
+    std::vector<std::size_t> begin;
+    for (const auto split : splits) {
+        begin.push_back(split - order.begin());
+    }
+    std::vector<double> slabLo(stripCount, -std::numeric_limits<double>::infinity());
+    std::vector<double> slabHi(stripCount, std::numeric_limits<double>::infinity());
+    for (unsigned s = 1; s < stripCount; s++) {
+        slabLo[s] = slabLo[s - 1];
+        for (std::size_t i = begin[s - 1]; i < begin[s]; i++) {
+            slabLo[s] = std::max<double>(slabLo[s], points[order[i]].getX());
+        }
+    }
+    for (unsigned s = stripCount - 1; s > 0; s--) {
+        slabHi[s - 1] = slabHi[s];
+        for (std::size_t i = begin[s]; i < begin[s + 1]; i++) {
+            slabHi[s - 1] = std::min<double>(slabHi[s - 1], points[order[i]].getX());
+        }
+    }
+
+    // Each strip has a super triangle of its own. Near the hull a triangle is part of the whole
+    // triangulation only if the circumcircle misses the corners of the super triangle of all points.
+    const Triangle<Point<F>, F> super = constructSuperTriangle();
+    const Vertex superCorners[3] = { super.getA(), super.getB(), super.getC() };
+
+    std::vector<Delaunay<F>> parts(stripCount);
+    std::vector<Workspace*> stripWorkspaces(stripCount + 1, nullptr);  // the last one for the border pass
+    if (m_workspace != nullptr) {
+        for (unsigned s = 0; s <= stripCount; s++) {
+            stripWorkspaces[s] = &m_workspace->strip(s);
+        }
+    }
+    std::vector<std::vector<char>> settled(stripCount);    // triangle of the strip is part of the result
+    std::vector<char> pending(pointCount, 0);               // point goes into the pass along the borders
+    std::vector<char> used(pointCount, 0);                  // point is a corner of a settled triangle
+    std::vector<std::vector<unsigned>> hullPoints(stripCount);
+
+    auto runStrips = [stripCount](const std::function<void(unsigned)>& work) {
+        std::vector<std::thread> workers;
+        for (unsigned s = 1; s < stripCount; s++) {
+            workers.push_back(std::thread(work, s));
+        }
+        work(0);
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    };
+
+    runStrips([&](const unsigned s) {
+        std::vector<Point<F>> stripPoints;
+        stripPoints.reserve(begin[s + 1] - begin[s]);
+        for (std::size_t i = begin[s]; i < begin[s + 1]; i++) {
+            stripPoints.push_back(points[order[i]]);
+        }
+        const double lo = slabLo[s];
+        const double hi = slabHi[s];
+
+        Delaunay<F>& part = parts[s];
+        part.m_spatialSort = m_spatialSort;
+        part.m_workspace = stripWorkspaces[s];
+        part.m_mesh.setVertices(std::move(stripPoints));
+        part.bowyerWatson();
+
+        const Mesh<F>& mesh = part.m_mesh;
+        const unsigned* global = &order[begin[s]];
+        settled[s].assign(mesh.getTriangleCount(), 0);
+        for (uint32_t t = 0; t < mesh.getTriangleCount(); t++) {
+            const uint32_t* corner = mesh.getTriangleIndices(t);
+            const Vertex a = mesh.getCorner(t, 0);
+            const Vertex b = mesh.getCorner(t, 1);
+            const Vertex c = mesh.getCorner(t, 2);
+            if (isInsideSlab(a, b, c, lo, hi) && inCircle(a, b, c, superCorners[0]) <= 0
+                    && inCircle(a, b, c, superCorners[1]) <= 0 && inCircle(a, b, c, superCorners[2]) <= 0) {
+                settled[s][t] = 1;
+                used[global[corner[0]]] = used[global[corner[1]]] = used[global[corner[2]]] = 1;
+            } else {
+                pending[global[corner[0]]] = pending[global[corner[1]]] = pending[global[corner[2]]] = 1;
+            }
+            for (unsigned e = 0; e < 3; e++) {
+                if (mesh.getNeighbour(t, e) == Mesh<F>::NO_NEIGHBOUR) {
+                    hullPoints[s].push_back(global[corner[(e + 1) % 3]]);
+                }
+            }
+        }
+    });
+
+    for (unsigned s = 0; s < stripCount; s++) {
+        for (const unsigned v : parts[s].m_skipped) {
+            m_skipped.push_back(order[begin[s] + v]);
+        }
+    }
+
+    // The points on the hull of a strip, collinear ones included, belong to the border pass as
+    // well: it fills the gaps between the strips and needs the hull edges of the strips
+    for (const auto& stripHull : hullPoints) {
+        for (const unsigned v : stripHull) {
+            pending[v] = 1;
+        }
+    }
+
+    // Points of no settled triangle belong to the border pass as well, unless they were duplicates
+    for (const unsigned v : m_skipped) {
+        used[v] = 1;
+    }
+    std::vector<Point<F>> borderPoints;
+    std::vector<unsigned> borderGlobal;
+    for (std::size_t v = 0; v < pointCount; v++) {
+        if (pending[v] || not used[v]) {
+            borderPoints.push_back(points[v]);
+            borderGlobal.push_back(v);
+        }
+    }
+
+    Delaunay<F> border;
+    border.m_spatialSort = m_spatialSort;
+    border.m_workspace = stripWorkspaces[stripCount];
+    border.m_mesh.setVertices(std::move(borderPoints));
+    border.bowyerWatson();
+    const Mesh<F>& borderMesh = border.m_mesh;
+
+    // Border triangles behind an edge of a settled triangle are covered by settled triangles.
+    // The directed edges of the settled triangles between border pass points mark them.
+    auto edgeKey = [](const uint64_t from, const uint64_t to) { return (from << 32) | to; };
+    std::unordered_set<uint64_t> settledEdges;
+    std::vector<std::size_t> firstSettled(stripCount + 1, 0);
+    for (unsigned s = 0; s < stripCount; s++) {
+        const Mesh<F>& mesh = parts[s].m_mesh;
+        const unsigned* global = &order[begin[s]];
+        firstSettled[s + 1] = firstSettled[s];
+        for (uint32_t t = 0; t < mesh.getTriangleCount(); t++) {
+            if (not settled[s][t]) {
+                continue;
+            }
+            firstSettled[s + 1]++;
+            for (unsigned e = 0; e < 3; e++) {
+                const unsigned from = global[mesh.getIndex(t, (e + 1) % 3)];
+                const unsigned to = global[mesh.getIndex(t, (e + 2) % 3)];
+                if ((pending[from] || not used[from]) && (pending[to] || not used[to])) {
+                    settledEdges.insert(edgeKey(from, to));
+                }
+            }
+        }
+    }
+
+    std::vector<char> covered(borderMesh.getTriangleCount(), 0);
+    std::vector<uint32_t> stack;
+    for (uint32_t t = 0; t < borderMesh.getTriangleCount(); t++) {
+        for (unsigned e = 0; e < 3 && not covered[t]; e++) {
+            if (settledEdges.count(edgeKey(borderGlobal[borderMesh.getIndex(t, (e + 1) % 3)], borderGlobal[borderMesh.getIndex(t, (e + 2) % 3)]))) {
+                covered[t] = 1;
+                stack.push_back(t);
+            }
+        }
+    }
+    while (not stack.empty()) {
+        const uint32_t t = stack.back();
+        stack.pop_back();
+        for (unsigned e = 0; e < 3; e++) {
+            const int32_t n = borderMesh.getNeighbour(t, e);
+            if (n == Mesh<F>::NO_NEIGHBOUR || covered[n]
+                    || settledEdges.count(edgeKey(borderGlobal[borderMesh.getIndex(t, (e + 1) % 3)], borderGlobal[borderMesh.getIndex(t, (e + 2) % 3)]))) {
+                continue;
+            }
+            covered[n] = 1;
+            stack.push_back(n);
+        }
+    }
+
+    // Result: the settled triangles strip by strip, then the uncovered border triangles
+    std::vector<uint32_t> borderTriangle(borderMesh.getTriangleCount(), NONE);
+    uint32_t triangleCount = firstSettled[stripCount];
+    for (uint32_t t = 0; t < borderMesh.getTriangleCount(); t++) {
+        if (not covered[t]) {
+            borderTriangle[t] = triangleCount++;
+        }
+    }
+    m_mesh.resizeTriangles(triangleCount);
+
+    std::vector<std::vector<std::pair<uint64_t, uint64_t>>> openEdges(stripCount);  // settled edges without settled neighbour
+    runStrips([&](const unsigned s) {
+        const Mesh<F>& mesh = parts[s].m_mesh;
+        const unsigned* global = &order[begin[s]];
+        std::vector<uint32_t> meshTriangle(mesh.getTriangleCount(), NONE);
+        uint32_t next = firstSettled[s];
+        for (uint32_t t = 0; t < mesh.getTriangleCount(); t++) {
+            if (settled[s][t]) {
+                meshTriangle[t] = next++;
+            }
+        }
+        for (uint32_t t = 0; t < mesh.getTriangleCount(); t++) {
+            if (meshTriangle[t] == NONE) {
+                continue;
+            }
+            const uint32_t* corner = mesh.getTriangleIndices(t);
+            m_mesh.setTriangle(meshTriangle[t], global[corner[0]], global[corner[1]], global[corner[2]]);
+            for (unsigned e = 0; e < 3; e++) {
+                const int32_t n = mesh.getNeighbour(t, e);
+                if (n != Mesh<F>::NO_NEIGHBOUR && meshTriangle[n] != NONE) {
+                    m_mesh.setNeighbour(meshTriangle[t], e, meshTriangle[n]);
+                } else {
+                    openEdges[s].push_back(std::make_pair(edgeKey(global[corner[(e + 1) % 3]], global[corner[(e + 2) % 3]]),
+                                                          3*uint64_t(meshTriangle[t]) + e));
+                }
+            }
+        }
+    });
+
+    std::unordered_map<uint64_t, uint64_t> openEdge;
+    for (const auto& stripEdges : openEdges) {
+        openEdge.insert(stripEdges.begin(), stripEdges.end());
+    }
+    for (uint32_t t = 0; t < borderMesh.getTriangleCount(); t++) {
+        if (borderTriangle[t] == NONE) {
+            continue;
+        }
+        const uint32_t* corner = borderMesh.getTriangleIndices(t);
+        m_mesh.setTriangle(borderTriangle[t], borderGlobal[corner[0]], borderGlobal[corner[1]], borderGlobal[corner[2]]);
+        for (unsigned e = 0; e < 3; e++) {
+            const int32_t n = borderMesh.getNeighbour(t, e);
+            if (n != Mesh<F>::NO_NEIGHBOUR && borderTriangle[n] != NONE) {
+                m_mesh.setNeighbour(borderTriangle[t], e, borderTriangle[n]);
+                continue;
+            }
+            // the settled triangle on the other side has the edge the other way round
+            const auto twin = openEdge.find(edgeKey(borderGlobal[corner[(e + 2) % 3]], borderGlobal[corner[(e + 1) % 3]]));
+            if (twin != openEdge.end()) {
+                m_mesh.setNeighbour(borderTriangle[t], e, twin->second/3);
+                m_mesh.setNeighbour(twin->second/3, twin->second % 3, borderTriangle[t]);
+            }
+        }
+    }
+}
+
+template <class F>
+bool Delaunay<F>::insertVertex(const unsigned v)
+{
+    const int start = locate(m_vertices[v]);
+    if (start < 0) {
+        return false;
+    }
+
+    const Vertex& p = m_vertices[v];
+    for (const unsigned corner : m_cells[start].vertex) {
+        if (m_vertices[corner] == p) {
+            return false;
+        }
+    }
+
+    findCavity(v, start);
+    collectBoundary();
+
+    // Re-triangulate the polygonal hole, every boundary edge forms a new triangle with the point
+    m_newCells.clear();
+    for (std::size_t i = 0; i < m_boundary.size(); i++) {
+        const BoundaryEdge& edge = m_boundary[i];
+        const int c = (i < m_cavity.size()) ? m_cavity[i] : newCell();
+
+        Cell& cell = m_cells[c];
+        cell.vertex[0] = edge.from;
+        cell.vertex[1] = edge.to;
+        cell.vertex[2] = v;
+        cell.neighbour[0] = -1;
+        cell.neighbour[1] = -1;
+        cell.neighbour[2] = edge.outside;
+        cell.alive = true;
+        cell.removed = edge.removed;
+        cell.constrained = (edge.outside >= 0 && (m_cells[edge.outside].constrained >> edge.outsideEdge) & 1) ? 4 : 0;
+
+        if (edge.outside >= 0) {
+            m_cells[edge.outside].neighbour[edge.outsideEdge] = c;
+        }
+
+        m_newCells.push_back(c);
+    }
+
+    // cavity cells which were not reused
+    for (std::size_t i = m_boundary.size(); i < m_cavity.size(); i++) {
+        m_cells[m_cavity[i]].alive = false;
+        m_freeCells.push_back(m_cavity[i]);
+    }
+
+    // Connect the new triangles around the point: the edge (to, v) of one triangle
+    // is the edge (v, from) of the triangle starting where it ends. The boundary
+    // vertices are distinct, so a table keyed on the start vertex finds it.
+    for (const int c : m_newCells) {
+        const unsigned from = m_cells[c].vertex[0];
+        m_startCell[from] = c;
+        m_startStamp[from] = m_stamp;
+    }
+    for (const int c : m_newCells) {
+        const unsigned to = m_cells[c].vertex[1];
+        if (m_startStamp[to] == m_stamp) {
+            const int next = m_startCell[to];
+            m_cells[c].neighbour[0] = next;
+            m_cells[next].neighbour[1] = c;
+        }
+    }
+
+    // the pieces of a constraint through the point are constraints as well
+    for (const std::pair<unsigned, unsigned>& constraint : m_splitConstraints) {
+        for (const int c : m_newCells) {
+            Cell& cell = m_cells[c];
+            if (cell.vertex[1] == constraint.first || cell.vertex[1] == constraint.second) {
+                cell.constrained |= 1;
+            }
+            if (cell.vertex[0] == constraint.first || cell.vertex[0] == constraint.second) {
+                cell.constrained |= 2;
+            }
+        }
+    }
+
+    m_lastCell = m_newCells.back();
+
+    return true;
+}
+
+template <class F>
+int Delaunay<F>::newCell()
+{
+    if (not m_freeCells.empty()) {
+        const int c = m_freeCells.back();
+        m_freeCells.pop_back();
+        return c;
+    }
+
+    m_cells.push_back(Cell());
+    m_badStamp.push_back(0);
+    m_testedStamp.push_back(0);
+    return m_cells.size() - 1;
+}
+
+template <class F>
+int Delaunay<F>::locate(const Vertex& p)
+{
+    // Visibility walk: step over an edge which has the point on its outer side until
+    // there is none. Starting with a random edge keeps the walk from cycling.
+
+    int c = m_lastCell;
+    for (std::size_t steps = 0; steps < m_cells.size(); steps++) {
+        m_walkState ^= m_walkState << 13;
+        m_walkState ^= m_walkState >> 17;
+        m_walkState ^= m_walkState << 5;
+        const int first = m_walkState % 3;
+
+        const Cell& cell = m_cells[c];
+        int next = c;
+        for (int k = 0; k < 3; k++) {
+            const int e = (first + k) % 3;
+            if (orient(m_vertices[cell.vertex[(e + 1) % 3]], m_vertices[cell.vertex[(e + 2) % 3]], p) < 0) {
+                next = cell.neighbour[e];
+                if (next >= 0) {
+                    break;
+                }
+            }
+        }
+
+        if (next == c) {
+            return c;
+        }
+        if (next < 0) {
+            break; // outside the super triangle, or the triangles in the way were taken out by StreamingDelaunay
+        }
+        c = next;
+    }
+
+    // the walk got stuck, fall back to looking at every triangle
+    for (std::size_t i = 0; i < m_cells.size(); i++) {
+        const Cell& cell = m_cells[i];
+        if (cell.alive
+                && orient(m_vertices[cell.vertex[0]], m_vertices[cell.vertex[1]], p) >= 0
+                && orient(m_vertices[cell.vertex[1]], m_vertices[cell.vertex[2]], p) >= 0
+                && orient(m_vertices[cell.vertex[2]], m_vertices[cell.vertex[0]], p) >= 0) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+template <class F>
+void Delaunay<F>::findCavity(const unsigned v, const int start)
+{
+    const Vertex& p = m_vertices[v];
+
+    m_stamp++;
+    m_cavity.clear();
+    m_cavity.push_back(start);
+    m_badStamp[start] = m_stamp;
+    m_splitConstraints.clear();
+
+    // the bad triangles are connected, only neighbours of bad triangles need a test
+    for (std::size_t i = 0; i < m_cavity.size(); i++) {
+        const Cell& cell = m_cells[m_cavity[i]];
+        for (int e = 0; e < 3; e++) {
+            const int n = cell.neighbour[e];
+            if (n < 0 || m_badStamp[n] == m_stamp || m_testedStamp[n] == m_stamp) {
+                continue;
+            }
+
+            // constraints bound the cavity, unless the point lies on one
+            if ((cell.constrained >> e) & 1) {
+                const unsigned from = cell.vertex[(e + 1) % 3];
+                const unsigned to = cell.vertex[(e + 2) % 3];
+                if (orient(m_vertices[from], m_vertices[to], p) != 0
+                        || not isAhead(m_vertices[from], m_vertices[to], p) || not isAhead(m_vertices[to], m_vertices[from], p)) {
                     continue;
                 }
+                m_splitConstraints.push_back(std::make_pair(from, to));
+            }
+            m_testedStamp[n] = m_stamp;
+
+            const Cell& neighbour = m_cells[n];
+            if (inCircle(m_vertices[neighbour.vertex[0]], m_vertices[neighbour.vertex[1]], m_vertices[neighbour.vertex[2]], p) >= 0) {
+                m_badStamp[n] = m_stamp;
+                m_cavity.push_back(n);
+            }
+        }
+    }
+}
+
+template <class F>
+void Delaunay<F>::collectBoundary()
+{
+    // With the exact predicates every boundary edge sees the point: a cell behind an
+    // edge whose circle holds the point is bad, so the edge is inside the cavity,
+    // unless the edge is a constraint. The cavity grows from the cell containing the
+    // point without crossing a constraint, which keeps the point on the inner side of
+    // those as well, the cavity is star-shaped and the new triangles are not flipped.
+    m_boundary.clear();
+    for (const int c : m_cavity) {
+        const Cell& cell = m_cells[c];
+        for (int e = 0; e < 3; e++) {
+            const int n = cell.neighbour[e];
+            if (n >= 0 && m_badStamp[n] == m_stamp) {
+                continue;
+            }
+
+            BoundaryEdge edge;
+            edge.from = cell.vertex[(e + 1) % 3];
+            edge.to = cell.vertex[(e + 2) % 3];
+            edge.outside = n;
+            edge.outsideEdge = -1;
+            edge.removed = cell.removed;
+            if (n >= 0) {
+                const Cell& outside = m_cells[n];
+                edge.outsideEdge = (outside.neighbour[0] == c) ? 0 : (outside.neighbour[1] == c) ? 1 : 2;
+            }
+            m_boundary.push_back(edge);
+        }
+    }
+}
+
+template <class F>
+void Delaunay<F>::insertConstraints()
+{
+    // a cell around every vertex, the constraints are walked from their end points
+    m_vertexCell.assign(m_vertices.size(), -1);
+    for (std::size_t c = 0; c < m_cells.size(); c++) {
+        if (m_cells[c].alive) {
+            for (const unsigned v : m_cells[c].vertex) {
+                m_vertexCell[v] = c;
+            }
+        }
+    }
+
+    // working vertex of every point, duplicates use the vertex of the point they equal
+    const std::size_t pointCount = m_mesh.getVertexCount();
+    std::vector<unsigned> inserted(pointCount, 0);
+    for (unsigned v = SUPER_VERTICES; v < m_vertices.size(); v++) {
+        inserted[m_order[v - SUPER_VERTICES]] = v;
+    }
+    auto vertexOf = [&](const unsigned i) -> int {
+        if (i >= pointCount) {
+            return -1;
+        }
+        const unsigned v = inserted[i];
+        return (m_vertexCell[v] >= 0) ? int(v) : findVertex(m_vertices[v]);
+    };
+
+    std::size_t skipped = 0;
+    for (const std::pair<unsigned, unsigned>& constraint : m_constraints) {
+        const int a = vertexOf(constraint.first);
+        const int b = vertexOf(constraint.second);
+        if (a < 0 || b < 0 || not insertConstraint(a, b)) {
+            skipped++;
+        }
+    }
+    if (skipped > 0) {
+        std::cout << "Delaunay::triangulate(): Skipped " << skipped << " invalid or crossing constraints" << std::endl;
+    }
+
+    restoreDelaunay();
+    removeRegions();
+}
 
-                if (*edges_it1 == *edges_it2) {
-                    edges_it2->setBadEdge(true);
+template <class F>
+bool Delaunay<F>::insertConstraint(unsigned a, const unsigned b)
+{
+    // Sloan's edge flipping: collect the edges the segment crosses, then flip them one by
+    // one, putting back edges which can't be flipped yet and new edges still crossing.
+    // A point on the segment splits it and the rest is inserted from there. The pieces are
+    // marked once all of them are in, a constraint skipped later on leaves no piece behind.
+    const Vertex& pb = m_vertices[b];
+    std::deque<std::pair<unsigned, unsigned>> crossing;
+    std::vector<std::pair<unsigned, unsigned>> pieces;
+    while (a != b) {
+        const Vertex& pa = m_vertices[a];
+
+        // the triangle around a which the segment leaves through the opposite edge (q, r)
+        int start = -1;
+        unsigned q = a;
+        unsigned r = a;
+        unsigned next = a;
+        vertexRing(a);
+        for (const int c : m_ring) {
+            const Cell& cell = m_cells[c];
+            const int i = cell.indexOf(a);
+            const unsigned cq = cell.vertex[(i + 1) % 3];
+            const unsigned cr = cell.vertex[(i + 2) % 3];
+            if (cq == b || cr == b) {
+                next = b;
+                break;
+            }
+            const double oq = orient(pa, m_vertices[cq], pb);
+            const double or_ = orient(pa, m_vertices[cr], pb);
+            if (oq == 0 && isAhead(pa, pb, m_vertices[cq])) {
+                next = cq;
+                break;
+            }
+            if (or_ == 0 && isAhead(pa, pb, m_vertices[cr])) {
+                next = cr;
+                break;
+            }
+            if (oq > 0 && or_ < 0) {
+                start = c;
+                q = cq;
+                r = cr;
+                break;
+            }
+        }
+        if (next != a) {
+            pieces.push_back(std::make_pair(a, next));
+            a = next;
+            continue;
+        }
+        if (start < 0) {
+            return false;
+        }
+
+        // walk along the segment, q stays on its right and r on its left
+        crossing.clear();
+        unsigned end = b;
+        int c = start;
+        for (;;) {
+            const Cell& cell = m_cells[c];
+            const int e = 3 - cell.indexOf(q) - cell.indexOf(r);
+            if ((cell.constrained >> e) & 1) {
+                return false;
+            }
+            crossing.push_back(std::make_pair(q, r));
+
+            const int n = cell.neighbour[e];
+            if (n < 0) {
+                return false;
+            }
+            const Cell& beyond = m_cells[n];
+            const unsigned s = beyond.vertex[3 - beyond.indexOf(q) - beyond.indexOf(r)];
+            if (s == b) {
+                break;
+            }
+            const double os = orient(pa, pb, m_vertices[s]);
+            if (os == 0) {
+                end = s;
+                break;
+            }
+            if (os > 0) {
+                r = s;
+            } else {
+                q = s;
+            }
+            c = n;
+        }
+
+        const Vertex& pe = m_vertices[end];
+        while (not crossing.empty()) {
+            const std::pair<unsigned, unsigned> edge = crossing.front();
+            crossing.pop_front();
+
+            int e = 0;
+            const int c = findEdge(edge.first, edge.second, e);
+            const Cell& cell = m_cells[c];
+            const Cell& beyond = m_cells[cell.neighbour[e]];
+            const unsigned p = cell.vertex[e];
+            const unsigned s = beyond.vertex[3 - beyond.indexOf(edge.first) - beyond.indexOf(edge.second)];
+
+            // only the diagonal of a convex quadrilateral can be flipped
+            if (orient(m_vertices[p], m_vertices[cell.vertex[(e + 1) % 3]], m_vertices[s]) <= 0
+                    || orient(m_vertices[p], m_vertices[s], m_vertices[cell.vertex[(e + 2) % 3]]) <= 0) {
+                crossing.push_back(edge);
+                continue;
+            }
+            flip(c, e);
+
+            const double op = orient(pa, pe, m_vertices[p]);
+            const double os = orient(pa, pe, m_vertices[s]);
+            if ((op > 0 && os < 0) || (op < 0 && os > 0)) {
+                crossing.push_back(std::make_pair(p, s));
+            }
+        }
+
+        pieces.push_back(std::make_pair(a, end));
+        a = end;
+    }
+
+    for (const std::pair<unsigned, unsigned>& piece : pieces) {
+        markConstrained(piece.first, piece.second);
+    }
+    return true;
+}
+
+template <class F>
+bool Delaunay<F>::isAhead(const Vertex& a, const Vertex& b, const Vertex& c)
+{
+    // c on the line through a and b lies on the side of b
+    return (double(c.getX()) - a.getX())*(double(b.getX()) - a.getX()) + (double(c.getY()) - a.getY())*(double(b.getY()) - a.getY()) > 0;
+}
+
+template <class F>
+int Delaunay<F>::findVertex(const Vertex& p)
+{
+    const int c = locate(p);
+    if (c < 0) {
+        return -1;
+    }
+    for (const unsigned corner : m_cells[c].vertex) {
+        if (m_vertices[corner] == p) {
+            return corner;
+        }
+    }
+    return -1;
+}
+
+template <class F>
+void Delaunay<F>::vertexRing(const unsigned v)
+{
+    // Turn around the vertex one way, and if the border of the super triangle
+    // is in the way, the other way from the start as well
+    m_ring.clear();
+    const int start = m_vertexCell[v];
+    int c = start;
+    for (;;) {
+        m_ring.push_back(c);
+        const int n = m_cells[c].neighbour[(m_cells[c].indexOf(v) + 2) % 3];
+        if (n == start) {
+            return;
+        }
+        if (n < 0) {
+            break;
+        }
+        c = n;
+    }
+    c = start;
+    for (;;) {
+        const int n = m_cells[c].neighbour[(m_cells[c].indexOf(v) + 1) % 3];
+        if (n < 0) {
+            return;
+        }
+        m_ring.push_back(n);
+        c = n;
+    }
+}
+
+template <class F>
+int Delaunay<F>::findEdge(const unsigned u, const unsigned v, int& edge)
+{
+    vertexRing(u);
+    for (const int c : m_ring) {
+        const Cell& cell = m_cells[c];
+        const int i = cell.indexOf(u);
+        if (cell.vertex[(i + 1) % 3] == v) {
+            edge = (i + 2) % 3;
+            return c;
+        }
+        if (cell.vertex[(i + 2) % 3] == v) {
+            edge = (i + 1) % 3;
+            return c;
+        }
+    }
+    return -1;
+}
+
+template <class F>
+void Delaunay<F>::markConstrained(const unsigned u, const unsigned v)
+{
+    int e = 0;
+    const int c = findEdge(u, v, e);
+    if (c < 0) {
+        return;
+    }
+    m_cells[c].constrained |= 1 << e;
+    const int n = m_cells[c].neighbour[e];
+    if (n >= 0) {
+        Cell& beyond = m_cells[n];
+        beyond.constrained |= 1 << (3 - beyond.indexOf(u) - beyond.indexOf(v));
+    }
+}
+
+template <class F>
+void Delaunay<F>::flip(const int c, const int e)
+{
+    // The triangles (p, q, r) and (s, r, q) on both sides of the edge (q, r) become
+    // (p, q, s) and (p, s, r). The outer edges keep their neighbours and constraint flags.
+    Cell& cell = m_cells[c];
+    const int n = cell.neighbour[e];
+    Cell& beyond = m_cells[n];
+
+    const unsigned p = cell.vertex[e];
+    const unsigned q = cell.vertex[(e + 1) % 3];
+    const unsigned r = cell.vertex[(e + 2) % 3];
+    const int f = 3 - beyond.indexOf(q) - beyond.indexOf(r);
+    const unsigned s = beyond.vertex[f];
+
+    const int nrp = cell.neighbour[(e + 1) % 3];
+    const int npq = cell.neighbour[(e + 2) % 3];
+    const int nqs = beyond.neighbour[(f + 1) % 3];
+    const int nsr = beyond.neighbour[(f + 2) % 3];
+    const unsigned char crp = (cell.constrained >> ((e + 1) % 3)) & 1;
+    const unsigned char cpq = (cell.constrained >> ((e + 2) % 3)) & 1;
+    const unsigned char cqs = (beyond.constrained >> ((f + 1) % 3)) & 1;
+    const unsigned char csr = (beyond.constrained >> ((f + 2) % 3)) & 1;
+
+    cell.vertex[0] = p;
+    cell.vertex[1] = q;
+    cell.vertex[2] = s;
+    cell.neighbour[0] = nqs;
+    cell.neighbour[1] = n;
+    cell.neighbour[2] = npq;
+    cell.constrained = cqs | (cpq << 2);
+
+    beyond.vertex[0] = p;
+    beyond.vertex[1] = s;
+    beyond.vertex[2] = r;
+    beyond.neighbour[0] = nsr;
+    beyond.neighbour[1] = nrp;
+    beyond.neighbour[2] = c;
+    beyond.constrained = csr | (crp << 1);
+
+    if (nqs >= 0) {
+        Cell& outside = m_cells[nqs];
+        outside.neighbour[(outside.neighbour[0] == n) ? 0 : (outside.neighbour[1] == n) ? 1 : 2] = c;
+    }
+    if (nrp >= 0) {
+        Cell& outside = m_cells[nrp];
+        outside.neighbour[(outside.neighbour[0] == c) ? 0 : (outside.neighbour[1] == c) ? 1 : 2] = n;
+    }
+
+    m_vertexCell[p] = c;
+    m_vertexCell[q] = c;
+    m_vertexCell[s] = c;
+    m_vertexCell[r] = n;
+}
+
+template <class F>
+void Delaunay<F>::restoreDelaunay()
+{
+    // Lawson flips: an edge which is not a constraint and has the opposite vertex of
+    // the neighbour inside the circumcircle is flipped, then the edges around it are checked.
+    std::vector<std::pair<int, int>> edges;
+    edges.reserve(3*m_cells.size());
+    for (std::size_t c = 0; c < m_cells.size(); c++) {
+        if (m_cells[c].alive) {
+            for (int e = 0; e < 3; e++) {
+                edges.push_back(std::make_pair(int(c), e));
+            }
+        }
+    }
+    flipEdges(edges, nullptr);
+}
+
+template <class F>
+void Delaunay<F>::flipEdges(std::vector<std::pair<int, int>>& edges, std::vector<int>* flipped)
+{
+    while (not edges.empty()) {
+        const int c = edges.back().first;
+        const int e = edges.back().second;
+        edges.pop_back();
+
+        const Cell& cell = m_cells[c];
+        const int n = cell.neighbour[e];
+        if (n < 0 || (cell.constrained >> e) & 1) {
+            continue;
+        }
+        const Cell& beyond = m_cells[n];
+        const unsigned s = beyond.vertex[3 - beyond.indexOf(cell.vertex[(e + 1) % 3]) - beyond.indexOf(cell.vertex[(e + 2) % 3])];
+        if (inCircle(m_vertices[cell.vertex[0]], m_vertices[cell.vertex[1]], m_vertices[cell.vertex[2]], m_vertices[s]) > 0) {
+            flip(c, e);
+            if (flipped != nullptr) {
+                flipped->push_back(c);
+                flipped->push_back(n);
+            }
+            edges.push_back(std::make_pair(c, 0));
+            edges.push_back(std::make_pair(c, 2));
+            edges.push_back(std::make_pair(n, 0));
+            edges.push_back(std::make_pair(n, 1));
+        }
+    }
+}
+
+template <class F>
+void Delaunay<F>::removeRegions()
+{
+    // flood fill from the holes and the border of the super triangle, constraints stop it
+    std::vector<int> stack;
+    if (m_removeOutside) {
+        for (std::size_t c = 0; c < m_cells.size(); c++) {
+            Cell& cell = m_cells[c];
+            if (cell.alive && (cell.vertex[0] < SUPER_VERTICES || cell.vertex[1] < SUPER_VERTICES || cell.vertex[2] < SUPER_VERTICES)) {
+                cell.removed = true;
+                stack.push_back(c);
+            }
+        }
+    }
+    for (const Point<F>& hole : m_holes) {
+        const int c = locate(hole);
+        if (c >= 0 && not m_cells[c].removed) {
+            m_cells[c].removed = true;
+            stack.push_back(c);
+        }
+    }
+
+    while (not stack.empty()) {
+        const Cell& cell = m_cells[stack.back()];
+        stack.pop_back();
+        for (int e = 0; e < 3; e++) {
+            const int n = cell.neighbour[e];
+            if (n >= 0 && not ((cell.constrained >> e) & 1) && not m_cells[n].removed) {
+                m_cells[n].removed = true;
+                stack.push_back(n);
+            }
+        }
+    }
+}
+
+template <class F>
+bool Delaunay<F>::insert(const Point<F>& point)
+{
+    m_changedTriangles.clear();
+    if (m_cells.empty()) {
+        std::cerr << "Delaunay::insert(): No triangulation to edit, use setEditable() before triangulate()" << std::endl;
+        return false;
+    }
+    if (not appendVertex(point)) {
+        return false;
+    }
+    m_order.push_back(m_mesh.addVertex(point));
+    m_workingVertex.push_back(m_vertices.size() - 1);
+
+    m_touchedCells = m_cavity;
+    m_touchedCells.insert(m_touchedCells.end(), m_newCells.begin(), m_newCells.end());
+    updateMesh();
+    return true;
+}
+
+template <class F>
+bool Delaunay<F>::remove(const uint32_t vertex)
+{
+    m_changedTriangles.clear();
+    if (m_cells.empty()) {
+        std::cerr << "Delaunay::remove(): No triangulation to edit, use setEditable() before triangulate()" << std::endl;
+        return false;
+    }
+    if (vertex >= m_workingVertex.size() || m_workingVertex[vertex] == NO_VERTEX) {
+        return false;
+    }
+    const unsigned v = m_workingVertex[vertex];
+
+    // the vertex is a corner of the cell containing it
+    const int start = locate(m_vertices[v]);
+    if (start < 0) {
+        return false;
+    }
+
+    // The cells around the vertex counter-clockwise and the polygon of their outer edges,
+    // edge k of the polygon goes from polygon[k] to polygon[k + 1]
+    std::vector<unsigned> polygon;
+    std::vector<PolygonEdge> edges;
+    m_ring.clear();
+    bool removed = true;
+    int c = start;
+    do {
+        const Cell& cell = m_cells[c];
+        const int i = cell.indexOf(v);
+        m_ring.push_back(c);
+        removed = removed && cell.removed;
+        polygon.push_back(cell.vertex[(i + 1) % 3]);
+
+        PolygonEdge edge;
+        edge.cell = cell.neighbour[i];
+        edge.edge = -1;
+        edge.constrained = (cell.constrained >> i) & 1;
+        if (edge.cell >= 0) {
+            const Cell& outside = m_cells[edge.cell];
+            edge.edge = (outside.neighbour[0] == c) ? 0 : (outside.neighbour[1] == c) ? 1 : 2;
+        }
+        edges.push_back(edge);
+
+        c = cell.neighbour[(i + 1) % 3];
+    } while (c != start && c >= 0);
+    if (c < 0) {
+        return false; // a corner of the super triangle
+    }
+
+    // Fill the polygon with the Delaunay triangulation of its corners: cut off an ear whose
+    // circumcircle holds no other corner, until a triangle is left. Around a vertex of a
+    // Delaunay triangulation such an ear always exists. With constraints there may be none,
+    // then an ear without a corner inside is cut. The constraints ending at the vertex go
+    // with it and can uncover points, so there the new edges are flipped afterwards. The ears
+    // are chosen before the cells change, a failure leaves the triangulation as it was.
+    std::vector<unsigned> corners(polygon);
+    std::vector<std::size_t> ears;
+    bool flipNeeded = not m_constraints.empty();
+    while (corners.size() > 3) {
+        int ear = findEar(corners, true);
+        if (ear < 0) {
+            ear = findEar(corners, false);
+            flipNeeded = true;
+        }
+        if (ear < 0) {
+            std::cerr << "Delaunay::remove(): No ear found for vertex " << vertex << std::endl;
+            return false;
+        }
+        ears.push_back(ear);
+        corners.erase(corners.begin() + (ear + 1) % corners.size());
+    }
+    ears.push_back(0);
+
+    std::size_t reused = 0;
+    m_newCells.clear();
+    for (const std::size_t ear : ears) {
+        const std::size_t n = polygon.size();
+        const std::size_t next = (ear + 1) % n;
+        const std::size_t after = (ear + 2) % n;
+        const int t = (reused < m_ring.size()) ? m_ring[reused++] : newCell();
+        Cell& cell = m_cells[t];
+        cell.vertex[0] = polygon[ear];
+        cell.vertex[1] = polygon[next];
+        cell.vertex[2] = polygon[after];
+        cell.alive = true;
+        cell.removed = removed;
+        cell.constrained = 0;
+        m_newCells.push_back(t);
+
+        // edge (a, b) is opposite corner 2, (b, c) opposite corner 0 and (c, a) opposite corner 1
+        linkEdge(t, 2, edges[ear]);
+        linkEdge(t, 0, edges[next]);
+        if (n == 3) {
+            linkEdge(t, 1, edges[after]);
+            break;
+        }
+
+        // the polygon continues along the new edge (a, c)
+        PolygonEdge cut;
+        cut.cell = t;
+        cut.edge = 1;
+        cut.constrained = 0;
+        edges[ear] = cut;
+        edges.erase(edges.begin() + next);
+        polygon.erase(polygon.begin() + next);
+    }
+
+    for (std::size_t i = reused; i < m_ring.size(); i++) {
+        m_cells[m_ring[i]].alive = false;
+        m_freeCells.push_back(m_ring[i]);
+    }
+    m_lastCell = m_newCells.back();
+    m_workingVertex[vertex] = NO_VERTEX;
+
+    m_touchedCells = m_ring;
+    m_touchedCells.insert(m_touchedCells.end(), m_newCells.begin(), m_newCells.end());
+    if (flipNeeded) {
+        // flip() keeps a cell for each vertex
+        m_vertexCell.resize(m_vertices.size(), -1);
+        std::vector<std::pair<int, int>> edges;
+        for (const int c : m_newCells) {
+            for (int e = 0; e < 3; e++) {
+                edges.push_back(std::make_pair(c, e));
+            }
+        }
+        flipEdges(edges, &m_touchedCells);
+    }
+    updateMesh();
+    return true;
+}
+
+template <class F>
+void Delaunay<F>::linkEdge(const int c, const int e, const PolygonEdge& edge)
+{
+    Cell& cell = m_cells[c];
+    cell.neighbour[e] = edge.cell;
+    cell.constrained |= edge.constrained << e;
+    if (edge.cell >= 0) {
+        m_cells[edge.cell].neighbour[edge.edge] = c;
+    }
+}
+
+template <class F>
+int Delaunay<F>::findEar(const std::vector<unsigned>& polygon, const bool emptyCircle) const
+{
+    // Ear (k, k + 1, k + 2) of the counter-clockwise polygon whose circumcircle, or otherwise
+    // the triangle itself, holds no other corner, -1 if there is none
+    const std::size_t n = polygon.size();
+    for (std::size_t k = 0; k < n; k++) {
+        const Vertex& a = m_vertices[polygon[k]];
+        const Vertex& b = m_vertices[polygon[(k + 1) % n]];
+        const Vertex& d = m_vertices[polygon[(k + 2) % n]];
+        if (orient(a, b, d) <= 0) {
+            continue;
+        }
+        bool empty = true;
+        for (std::size_t j = 3; j < n && empty; j++) {
+            const Vertex& q = m_vertices[polygon[(k + j) % n]];
+            if (emptyCircle) {
+                empty = inCircle(a, b, d, q) <= 0;
+            } else {
+                empty = orient(a, b, q) < 0 || orient(b, d, q) < 0 || orient(d, a, q) < 0;
+            }
+        }
+        if (empty) {
+            return k;
+        }
+    }
+    return -1;
+}
+
+template <class F>
+void Delaunay<F>::updateMesh()
+{
+    // The touched cells lost their mesh triangle, keep it with new corners or get one. New
+    // triangles take the freed slots first, left over slots are filled with the last triangles.
+    std::sort(m_touchedCells.begin(), m_touchedCells.end());
+    m_touchedCells.erase(std::unique(m_touchedCells.begin(), m_touchedCells.end()), m_touchedCells.end());
+    m_cellTriangle.resize(m_cells.size(), Mesh<F>::NO_NEIGHBOUR);
+    const bool constrained = not m_constraints.empty();
+
+    std::vector<uint32_t> freed;
+    for (const int c : m_touchedCells) {
+        if (m_cellTriangle[c] != Mesh<F>::NO_NEIGHBOUR && not isInnerCell(c)) {
+            freed.push_back(m_cellTriangle[c]);
+            m_cellTriangle[c] = Mesh<F>::NO_NEIGHBOUR;
+        }
+    }
+
+    for (const int c : m_touchedCells) {
+        if (not isInnerCell(c)) {
+            continue;
+        }
+        uint32_t t = m_cellTriangle[c];
+        if (m_cellTriangle[c] == Mesh<F>::NO_NEIGHBOUR) {
+            if (not freed.empty()) {
+                t = freed.back();
+                freed.pop_back();
+            } else {
+                t = m_mesh.addTriangle(0, 0, 0);
+                m_triangleCell.push_back(c);
+                if (constrained) {
+                    m_constrainedEdges.push_back(0);
+                }
+            }
+            m_cellTriangle[c] = t;
+            m_triangleCell[t] = c;
+        }
+
+        const Cell& cell = m_cells[c];
+        m_mesh.setTriangle(t, m_order[cell.vertex[0] - SUPER_VERTICES], m_order[cell.vertex[1] - SUPER_VERTICES],
+                           m_order[cell.vertex[2] - SUPER_VERTICES]);
+        if (constrained) {
+            m_constrainedEdges[t] = cell.constrained;
+        }
+        m_changedTriangles.push_back(t);
+    }
+
+    // neighbours of the new triangles, both ways. A cell which is no triangle of the mesh,
+    // like one at the super triangle, leaves its inner neighbours without a neighbour there.
+    for (const int c : m_touchedCells) {
+        if (not isInnerCell(c)) {
+            const Cell& cell = m_cells[c];
+            for (unsigned e = 0; e < 3 && cell.alive; e++) {
+                const int n = cell.neighbour[e];
+                if (n >= 0 && isInnerCell(n)) {
+                    const Cell& outside = m_cells[n];
+                    m_mesh.setNeighbour(m_cellTriangle[n], (outside.neighbour[0] == c) ? 0 : (outside.neighbour[1] == c) ? 1 : 2,
+                                        Mesh<F>::NO_NEIGHBOUR);
                 }
             }
+            continue;
+        }
+        const Cell& cell = m_cells[c];
+        const uint32_t t = m_cellTriangle[c];
+        for (unsigned e = 0; e < 3; e++) {
+            const int n = cell.neighbour[e];
+            const int32_t neighbour = (n >= 0) ? m_cellTriangle[n] : Mesh<F>::NO_NEIGHBOUR;
+            m_mesh.setNeighbour(t, e, neighbour);
+            if (neighbour != Mesh<F>::NO_NEIGHBOUR) {
+                const Cell& outside = m_cells[n];
+                m_mesh.setNeighbour(neighbour, (outside.neighbour[0] == c) ? 0 : (outside.neighbour[1] == c) ? 1 : 2, t);
+            }
         }
+    }
 
-        // for each edge in polygon do // re-triangulate the polygonal hole
-       //             newTri := form a triangle from edge to point
-       //             add newTri to triangulation
-        for (auto edges_it = edges.begin(); edges_it < edges.end(); ++edges_it) {
-            if (!(edges_it->getBadEdge())) {
-                m_triangles.push_back(Triangle<Point<F>, F>(*edges_it, p));
+    // From the highest freed slot down, every slot above is in use by then
+    std::sort(freed.begin(), freed.end(), std::greater<uint32_t>());
+    for (const uint32_t slot : freed) {
+        const uint32_t last = m_mesh.getTriangleCount() - 1;
+        if (slot != last) {
+            const uint32_t* corner = m_mesh.getTriangleIndices(last);
+            m_mesh.setTriangle(slot, corner[0], corner[1], corner[2]);
+            for (unsigned e = 0; e < 3; e++) {
+                const int32_t neighbour = m_mesh.getNeighbour(last, e);
+                m_mesh.setNeighbour(slot, e, neighbour);
+                if (neighbour != Mesh<F>::NO_NEIGHBOUR) {
+                    for (unsigned f = 0; f < 3; f++) {
+                        if (m_mesh.getNeighbour(neighbour, f) == int32_t(last)) {
+                            m_mesh.setNeighbour(neighbour, f, slot);
+                        }
+                    }
+                }
+            }
+            if (constrained) {
+                m_constrainedEdges[slot] = m_constrainedEdges[last];
             }
+            m_triangleCell[slot] = m_triangleCell[last];
+            m_cellTriangle[m_triangleCell[slot]] = slot;
+            m_changedTriangles.push_back(slot);
+        }
+        m_mesh.removeLastTriangle();
+        m_triangleCell.pop_back();
+        if (constrained) {
+            m_constrainedEdges.pop_back();
         }
     }
 
-    //          if triangle contains a vertex from original super-triangle
-    //             remove triangle from triangulation
-    m_triangles.erase(std::remove_if(begin(m_triangles), end(m_triangles),
-                                     [superTriangle](Triangle<Point<F>, F>& t) {
-                                          return  t.getA() == superTriangle.getA() ||
-                                                  t.getB() == superTriangle.getA() ||
-                                                  t.getC() == superTriangle.getA() ||
-                                                  t.getA() == superTriangle.getB() ||
-                                                  t.getB() == superTriangle.getB() ||
-                                                  t.getC() == superTriangle.getB() ||
-                                                  t.getA() == superTriangle.getC() ||
-                                                  t.getB() == superTriangle.getC() ||
-                                                  t.getC() == superTriangle.getC();
-                                      }
-                                    ), end(m_triangles));
+    const uint32_t triangleCount = m_mesh.getTriangleCount();
+    std::sort(m_changedTriangles.begin(), m_changedTriangles.end());
+    m_changedTriangles.erase(std::unique(m_changedTriangles.begin(), m_changedTriangles.end()), m_changedTriangles.end());
+    m_changedTriangles.erase(std::lower_bound(m_changedTriangles.begin(), m_changedTriangles.end(), triangleCount), m_changedTriangles.end());
 }
 
 template <class F>
 Triangle<Point<F>, F> Delaunay<F>::constructSuperTriangle()
 {
     // Determinate the super triangle
-    float minX = m_points.front().getX();
-    float minY = m_points.front().getY();
-    float maxX = minX;
-    float maxY = minY;
+    const std::vector<Point<F>>& points = m_mesh.getVertices();
+    F minX = points.front().getX();
+    F minY = points.front().getY();
+    F maxX = minX;
+    F maxY = minY;
 
-    for (auto& t : m_points) {
+    for (auto& t : points) {
         if (t.getX() < minX) minX = t.getX();
         if (t.getY() < minY) minY = t.getY();
         if (t.getX() > maxX) maxX = t.getX();
         if (t.getY() > maxY) maxY = t.getY();
     }
 
+    return superTriangle(minX, minY, maxX, maxY);
+}
+
+template <class F>
+Triangle<Point<F>, F> Delaunay<F>::superTriangle(const F minX, const F minY, const F maxX, const F maxY)
+{
     F dx = maxX - minX;
     F dy = maxY - minY;
     F deltaMax = std::max(dx, dy);
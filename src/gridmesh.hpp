@@ -0,0 +1,171 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 Hans-Peter Schadler <hps@abyle.org>
+**
+** This program is free software: you can redistribute it and/or modify it
+** under the terms of the GNU General Public License as published by the Free
+** Software Foundation, either version 3 of the License, or (at your option)
+** any later version.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT
+** ANY WARRANTY; without even the implied warranty of  MERCHANTABILITY or
+** FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+** more details.
+**
+** You should have received a copy of the GNU General Public License along with
+** this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+****************************************************************************/
+
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+#include "mesh.hpp"
+#include "point.hpp"
+#include "predicates.hpp"
+
+// Triangulation of points on a regular lattice, e.g. a lat/lon grid of heights.
+// Every cell is split into two triangles along one of its diagonals, so the
+// mesh is built directly in O(n) instead of running a general triangulation.
+// The points are row-major, point (row, col) at row*cols + col, and the rows
+// and columns are parallel lines with constant spacing.
+//
+// Both diagonals of a rectangular cell give a Delaunay triangulation. With
+// HEIGHT_DIAGONAL the diagonal between the two corners closest in height is
+// chosen, which is the shorter one in 3D and follows ridges and valleys
+// instead of cutting across them.
+template <class F>
+class GridMesh
+{
+public:
+    enum DiagonalType {
+        FORWARD_DIAGONAL,   // (row, col) to (row + 1, col + 1) in every cell
+        BACKWARD_DIAGONAL,  // (row, col + 1) to (row + 1, col) in every cell
+        HEIGHT_DIAGONAL     // per cell, between the corners with the smaller height difference
+    };
+
+    // Triangulates the rows x cols points into mesh. HEIGHT_DIAGONAL needs a height per point.
+    static bool build(const std::vector<Point<F>>& points, const unsigned rows, const unsigned cols, Mesh<F>& mesh,
+                      const DiagonalType diagonalType = FORWARD_DIAGONAL,
+                      const std::vector<double>& heights = std::vector<double>());
+
+private:
+    enum Side {
+        BOTTOM,     // row, col to row, col + 1
+        RIGHT,      // row, col + 1 to row + 1, col + 1
+        TOP,        // row + 1, col + 1 to row + 1, col
+        LEFT        // row + 1, col to row, col
+    };
+
+    // Triangle 0 or 1 of a cell next to the side
+    static unsigned sideTriangle(const bool forward, const Side side) {
+        return forward ? ((side == BOTTOM || side == RIGHT) ? 0 : 1)
+                       : ((side == BOTTOM || side == LEFT) ? 0 : 1);
+    }
+};
+
+template <class F>
+bool GridMesh<F>::build(const std::vector<Point<F>>& points, const unsigned rows, const unsigned cols, Mesh<F>& mesh,
+                        const DiagonalType diagonalType, const std::vector<double>& heights)
+{
+    mesh.setVertices(points);
+
+    if (std::size_t(rows)*cols != points.size()) {
+        std::cerr << "GridMesh::build(): " << points.size() << " points don't form a grid of "
+                  << rows << " x " << cols << std::endl;
+        return false;
+    }
+    if (diagonalType == HEIGHT_DIAGONAL && heights.size() != points.size()) {
+        std::cerr << "GridMesh::build(): " << heights.size() << " heights for " << points.size() << " points" << std::endl;
+        return false;
+    }
+    if (rows < 2 || cols < 2) {
+        return true;
+    }
+
+    // The lattice may be mirrored, e.g. rows along x and columns along y, then the corners are reversed
+    const bool mirrored = Predicates::orient2d(points[0], points[1], points[cols + 1]) < 0;
+
+    const std::size_t cellCols = cols - 1;
+    const std::size_t cellCount = std::size_t(rows - 1)*cellCols;
+    std::vector<char> forward(cellCount);
+    mesh.resizeTriangles(2*cellCount);
+
+    for (unsigned row = 0; row + 1 < rows; row++) {
+        for (unsigned col = 0; col + 1 < cols; col++) {
+            const std::size_t cell = row*cellCols + col;
+            const uint32_t p00 = row*cols + col;
+            const uint32_t p01 = p00 + 1;
+            const uint32_t p10 = p00 + cols;
+            const uint32_t p11 = p10 + 1;
+
+            bool isForward = (diagonalType != BACKWARD_DIAGONAL);
+            if (diagonalType == HEIGHT_DIAGONAL) {
+                isForward = std::fabs(heights[p00] - heights[p11]) <= std::fabs(heights[p01] - heights[p10]);
+            }
+            forward[cell] = isForward;
+
+            // counter-clockwise in (col, row)
+            uint32_t first[3] = { p00, p01, isForward ? p11 : p10 };
+            uint32_t second[3] = { isForward ? p00 : p01, p11, p10 };
+            if (mirrored) {
+                std::swap(first[1], first[2]);
+                std::swap(second[1], second[2]);
+            }
+            mesh.setTriangle(2*cell, first[0], first[1], first[2]);
+            mesh.setTriangle(2*cell + 1, second[0], second[1], second[2]);
+        }
+    }
+
+    // Neighbours: across the diagonal the other triangle of the cell, across a side the
+    // triangle of the next cell on the opposite side
+    for (std::size_t cell = 0; cell < cellCount; cell++) {
+        const unsigned row = cell/cellCols;
+        const unsigned col = cell % cellCols;
+        for (unsigned half = 0; half < 2; half++) {
+            const uint32_t t = 2*cell + half;
+            for (unsigned e = 0; e < 3; e++) {
+                const uint32_t u = mesh.getIndex(t, (e + 1) % 3);
+                const uint32_t v = mesh.getIndex(t, (e + 2) % 3);
+                const unsigned uRow = u/cols, uCol = u % cols;
+                const unsigned vRow = v/cols, vCol = v % cols;
+
+                int64_t other = -1;
+                Side otherSide = BOTTOM;
+                if (uRow == vRow) {
+                    // the bottom side of this cell or its top side
+                    if (uRow == row && row > 0) {
+                        other = cell - cellCols;
+                        otherSide = TOP;
+                    } else if (uRow == row + 1 && row + 2 < rows) {
+                        other = cell + cellCols;
+                        otherSide = BOTTOM;
+                    }
+                } else if (uCol == vCol) {
+                    if (uCol == col && col > 0) {
+                        other = cell - 1;
+                        otherSide = RIGHT;
+                    } else if (uCol == col + 1 && col + 2 < cols) {
+                        other = cell + 1;
+                        otherSide = LEFT;
+                    }
+                } else {
+                    mesh.setNeighbour(t, e, 2*cell + (1 - half));
+                    continue;
+                }
+
+                if (other >= 0) {
+                    mesh.setNeighbour(t, e, 2*other + sideTriangle(forward[other], otherSide));
+                }
+            }
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,199 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 Hans-Peter Schadler <hps@abyle.org>
+**
+** This program is free software: you can redistribute it and/or modify it
+** under the terms of the GNU General Public License as published by the Free
+** Software Foundation, either version 3 of the License, or (at your option)
+** any later version.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT
+** ANY WARRANTY; without even the implied warranty of  MERCHANTABILITY or
+** FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+** more details.
+**
+** You should have received a copy of the GNU General Public License along with
+** this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+****************************************************************************/
+
+
+#include "gridresampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace {
+    const double INVALID_HEIGHT = -10000.0;
+}
+
+RegularGrid::RegularGrid() :
+    RegularGrid(0.0, 0.0, 1.0, 1.0, 0, 0)
+{ }
+
+RegularGrid::RegularGrid(const double latOrigin, const double lonOrigin, const double latSpacing, const double lonSpacing,
+                         const int rows, const int cols) :
+    m_latOrigin(latOrigin),
+    m_lonOrigin(lonOrigin),
+    m_latSpacing(latSpacing),
+    m_lonSpacing(lonSpacing),
+    m_rows(rows),
+    m_cols(cols)
+{ }
+
+RegularGrid RegularGrid::fromRange(const double latStart, const double latEnd, const double latSpacing,
+                                   const double lonStart, const double lonEnd, const double lonSpacing)
+{
+    // small tolerance so that an end which is a multiple of the spacing is not lost to rounding
+    int rows = (latEnd >= latStart) ? int(std::floor((latEnd - latStart)/latSpacing + 1e-9)) + 1 : 0;
+    int cols = (lonEnd >= lonStart) ? int(std::floor((lonEnd - lonStart)/lonSpacing + 1e-9)) + 1 : 0;
+
+    return RegularGrid(latStart, lonStart, latSpacing, lonSpacing, rows, cols);
+}
+
+GridResampler::GridResampler(const HeightRaster& heightData, const int latOrigin, const int lonOrigin) :
+    m_heightData(heightData),
+    m_latOrigin(latOrigin),
+    m_lonOrigin(lonOrigin),
+    m_samplesPerDegree(heightData.rows() - 1)
+{ }
+
+GridResampler::GridResampler(const SRTMParser& srtmParser) :
+    GridResampler(srtmParser.getHeightData(), srtmParser.getLatOrigin(), srtmParser.getLonOrigin())
+{ }
+
+std::vector<GridResampler::Tap> GridResampler::calcTaps(const double origin, const double spacing, const int count,
+                                                        const int tileOrigin, const bool reversed) const
+{
+    std::vector<Tap> taps(count);
+
+    for (int i = 0; i < count; i++) {
+        // same index math as SRTMParser::getHeight()
+        double shifted = (origin + i*spacing - tileOrigin)*m_samplesPerDegree;
+
+        Tap& tap = taps[i];
+        tap.valid = shifted >= 0 && shifted < m_samplesPerDegree + 1;
+        if (not tap.valid) {
+            tap.index = 0;
+            tap.weight = 0.0;
+            tap.edge = false;
+            continue;
+        }
+
+        int shiftedInt = shifted;
+        tap.edge = (shiftedInt == m_samplesPerDegree);
+        tap.weight = shifted - shiftedInt;
+        // rows are stored from north to south
+        tap.index = reversed ? m_samplesPerDegree - shiftedInt : shiftedInt;
+    }
+
+    return taps;
+}
+
+void GridResampler::interpolateRow(const int sourceRow, const std::vector<Tap>& colTaps, double* rowHeights) const
+{
+    const int16_t* source = m_heightData.rowData(sourceRow);
+
+    for (std::size_t col = 0; col < colTaps.size(); col++) {
+        const Tap& tap = colTaps[col];
+        if (tap.valid && not tap.edge) {
+            rowHeights[col] = (1.0 - tap.weight)*source[tap.index] + tap.weight*source[tap.index + 1];
+        }
+    }
+}
+
+void GridResampler::resampleRows(const std::vector<Tap>& rowTaps, const std::vector<Tap>& colTaps,
+                                 const SRTMParser::InterpolationType interpolationType,
+                                 const int firstRow, const int lastRow, double* heights) const
+{
+    const std::size_t cols = colTaps.size();
+
+    // horizontally interpolated source rows, neighbouring output rows mostly share them
+    std::vector<double> lower(cols);
+    std::vector<double> upper(cols);
+    int lowerRow = -1;
+    int upperRow = -1;
+
+    for (int row = firstRow; row < lastRow; row++) {
+        const Tap& rowTap = rowTaps[row];
+        double* out = heights + row*cols;
+
+        if (not rowTap.valid) {
+            std::fill(out, out + cols, INVALID_HEIGHT);
+            continue;
+        }
+
+        const int16_t* sourceRow = m_heightData.rowData(rowTap.index);
+
+        if (interpolationType == SRTMParser::InterpolationType::NO_INTERPOLATION || rowTap.edge) {
+            for (std::size_t col = 0; col < cols; col++) {
+                out[col] = colTaps[col].valid ? sourceRow[colTaps[col].index] : INVALID_HEIGHT;
+            }
+            continue;
+        }
+
+        const int wantedLower = rowTap.index;
+        const int wantedUpper = rowTap.index - 1;
+        if (wantedLower == upperRow) {
+            std::swap(lower, upper);
+            std::swap(lowerRow, upperRow);
+        } else if (wantedUpper == lowerRow) {
+            std::swap(lower, upper);
+            std::swap(lowerRow, upperRow);
+        }
+        if (lowerRow != wantedLower) {
+            interpolateRow(wantedLower, colTaps, lower.data());
+            lowerRow = wantedLower;
+        }
+        if (upperRow != wantedUpper) {
+            interpolateRow(wantedUpper, colTaps, upper.data());
+            upperRow = wantedUpper;
+        }
+
+        const double weight = rowTap.weight;
+        for (std::size_t col = 0; col < cols; col++) {
+            const Tap& colTap = colTaps[col];
+            if (not colTap.valid) {
+                out[col] = INVALID_HEIGHT;
+            } else if (colTap.edge) {
+                out[col] = sourceRow[colTap.index]; // no extrapolation
+            } else {
+                out[col] = (1.0 - weight)*lower[col] + weight*upper[col];
+            }
+        }
+    }
+}
+
+std::vector<double> GridResampler::resample(const RegularGrid& grid, const SRTMParser::InterpolationType interpolationType,
+                                            unsigned threads) const
+{
+    std::vector<double> heights(grid.size(), INVALID_HEIGHT);
+    if (m_heightData.isEmpty() || grid.size() == 0) {
+        return heights;
+    }
+
+    std::vector<Tap> rowTaps = calcTaps(grid.getLatOrigin(), grid.getLatSpacing(), grid.getRows(), m_latOrigin, true);
+    std::vector<Tap> colTaps = calcTaps(grid.getLonOrigin(), grid.getLonSpacing(), grid.getCols(), m_lonOrigin, false);
+
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threads = std::min<unsigned>(threads, grid.getRows());
+
+    const int rowsPerBand = (grid.getRows() + threads - 1)/threads;
+    std::vector<std::thread> workers;
+    for (unsigned band = 1; band < threads; band++) {
+        int firstRow = band*rowsPerBand;
+        int lastRow = std::min(grid.getRows(), firstRow + rowsPerBand);
+        workers.push_back(std::thread(&GridResampler::resampleRows, this, std::cref(rowTaps), std::cref(colTaps),
+                                      interpolationType, firstRow, lastRow, heights.data()));
+    }
+    resampleRows(rowTaps, colTaps, interpolationType, 0, std::min(grid.getRows(), rowsPerBand), heights.data());
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    return heights;
+}
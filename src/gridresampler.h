@@ -0,0 +1,95 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 Hans-Peter Schadler <hps@abyle.org>
+**
+** This program is free software: you can redistribute it and/or modify it
+** under the terms of the GNU General Public License as published by the Free
+** Software Foundation, either version 3 of the License, or (at your option)
+** any later version.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT
+** ANY WARRANTY; without even the implied warranty of  MERCHANTABILITY or
+** FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+** more details.
+**
+** You should have received a copy of the GNU General Public License along with
+** this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+****************************************************************************/
+
+
+#pragma once
+
+#include <vector>
+
+#include "heightraster.h"
+#include "srtmparser.h"
+
+// Regular lat/lon grid. Row 0 is the southern most row, column 0 the western most column.
+class RegularGrid
+{
+public:
+    RegularGrid();
+    RegularGrid(const double latOrigin, const double lonOrigin, const double latSpacing, const double lonSpacing,
+                const int rows, const int cols);
+
+    // Grid covering [latStart, latEnd] x [lonStart, lonEnd], both ends included like the exporter loops
+    static RegularGrid fromRange(const double latStart, const double latEnd, const double latSpacing,
+                                 const double lonStart, const double lonEnd, const double lonSpacing);
+
+    double getLatitude(const int row) const { return m_latOrigin + row*m_latSpacing; }
+    double getLongitude(const int col) const { return m_lonOrigin + col*m_lonSpacing; }
+
+    double getLatOrigin() const { return m_latOrigin; }
+    double getLonOrigin() const { return m_lonOrigin; }
+    double getLatSpacing() const { return m_latSpacing; }
+    double getLonSpacing() const { return m_lonSpacing; }
+    int getRows() const { return m_rows; }
+    int getCols() const { return m_cols; }
+    std::size_t size() const { return std::size_t(m_rows)*m_cols; }
+
+private:
+    double m_latOrigin;
+    double m_lonOrigin;
+    double m_latSpacing;
+    double m_lonSpacing;
+    int m_rows;
+    int m_cols;
+};
+
+// Samples a tile on a RegularGrid. The source rows/columns and weights are computed once
+// per output row and column, the output is then produced with a horizontal pass per
+// source row and a vertical blend per output row. Row bands are processed in parallel.
+// Results follow SRTMParser::getHeight(), up to floating point rounding.
+class GridResampler
+{
+public:
+    GridResampler(const HeightRaster& heightData, const int latOrigin, const int lonOrigin);
+    GridResampler(const SRTMParser& srtmParser);
+
+    // Row-major heights, grid.getCols() values per row. threads = 0 uses all hardware threads.
+    std::vector<double> resample(const RegularGrid& grid,
+                                 const SRTMParser::InterpolationType interpolationType = SRTMParser::InterpolationType::LINEAR_INTERPOLATION,
+                                 unsigned threads = 0) const;
+
+private:
+    struct Tap {
+        int index;      // source row/column of the sample below/left of the target
+        double weight;  // weight of the sample above/right of the target
+        bool valid;     // target lies inside the tile
+        bool edge;      // target lies on the north/east border, no neighbour to interpolate with
+    };
+
+    std::vector<Tap> calcTaps(const double origin, const double spacing, const int count, const int tileOrigin, const bool reversed) const;
+
+    void resampleRows(const std::vector<Tap>& rowTaps, const std::vector<Tap>& colTaps,
+                      const SRTMParser::InterpolationType interpolationType,
+                      const int firstRow, const int lastRow, double* heights) const;
+
+    void interpolateRow(const int sourceRow, const std::vector<Tap>& colTaps, double* rowHeights) const;
+
+    HeightRaster m_heightData;
+    int m_latOrigin;
+    int m_lonOrigin;
+    int m_samplesPerDegree;
+};
@@ -19,10 +19,9 @@
 
 #include "heightdata.h"
 
-HeightData::HeightData(QVector<QVector<qint16>> rawHeightData)
-{
-    m_rawHeightData = rawHeightData;
-}
+HeightData::HeightData(const HeightRaster& rawHeightData) :
+    m_rawHeightData(rawHeightData)
+{ }
 
 float HeightData::getHeight(const double lat, const double lon) const
 {
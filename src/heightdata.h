@@ -19,17 +19,17 @@
 
 #pragma once
 
-#include <QVector>
+#include "heightraster.h"
 
 class HeightData
 {
 public:
-    HeightData(QVector<QVector<qint16>> rawHeightData);
+    HeightData(const HeightRaster& rawHeightData);
 
     float getHeight(const double lat, const double lon) const;
 
 private:
     unsigned m_hgtType;
 
-    QVector<QVector<qint16>> m_rawHeightData;
+    HeightRaster m_rawHeightData;
 };
@@ -0,0 +1,78 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 Hans-Peter Schadler <hps@abyle.org>
+**
+** This program is free software: you can redistribute it and/or modify it
+** under the terms of the GNU General Public License as published by the Free
+** Software Foundation, either version 3 of the License, or (at your option)
+** any later version.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT
+** ANY WARRANTY; without even the implied warranty of  MERCHANTABILITY or
+** FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+** more details.
+**
+** You should have received a copy of the GNU General Public License along with
+** this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+****************************************************************************/
+
+
+#include "heightraster.h"
+
+#include <algorithm>
+
+const std::size_t HeightRaster::ALIGNMENT;
+
+HeightRaster::HeightRaster() :
+    m_data(nullptr),
+    m_writableData(nullptr),
+    m_rows(0),
+    m_cols(0),
+    m_stride(0)
+{ }
+
+HeightRaster::HeightRaster(const int rows, const int cols) :
+    HeightRaster()
+{
+    if (rows <= 0 || cols <= 0) {
+        return;
+    }
+
+    m_rows = rows;
+    m_cols = cols;
+    m_stride = alignedStride(cols);
+
+    // operator new only guarantees alignment for fundamental types, so
+    // allocate a bit more and align the start of the samples by hand
+    char* raw = new char[sizeInBytes() + ALIGNMENT];
+    std::uintptr_t aligned = (reinterpret_cast<std::uintptr_t>(raw) + ALIGNMENT) & ~std::uintptr_t(ALIGNMENT - 1);
+
+    m_writableData = reinterpret_cast<int16_t*>(aligned);
+    m_data = m_writableData;
+    m_storage = std::shared_ptr<const void>(m_data, [raw](const void*) { delete[] raw; });
+}
+
+HeightRaster HeightRaster::view(const int16_t* data, const int rows, const int cols, const std::size_t stride,
+                                const std::shared_ptr<const void>& owner)
+{
+    HeightRaster raster;
+    raster.m_storage = owner;
+    raster.m_data = data;
+    raster.m_rows = rows;
+    raster.m_cols = cols;
+    raster.m_stride = stride;
+    return raster;
+}
+
+void HeightRaster::fill(const int16_t value)
+{
+    assert(isWritable());
+    std::fill(m_writableData, m_writableData + m_rows*m_stride, value);
+}
+
+std::size_t HeightRaster::alignedStride(const int cols)
+{
+    const std::size_t samplesPerBlock = ALIGNMENT/sizeof(int16_t);
+    return (cols + samplesPerBlock - 1)/samplesPerBlock*samplesPerBlock;
+}
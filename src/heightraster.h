@@ -0,0 +1,82 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 Hans-Peter Schadler <hps@abyle.org>
+**
+** This program is free software: you can redistribute it and/or modify it
+** under the terms of the GNU General Public License as published by the Free
+** Software Foundation, either version 3 of the License, or (at your option)
+** any later version.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT
+** ANY WARRANTY; without even the implied warranty of  MERCHANTABILITY or
+** FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+** more details.
+**
+** You should have received a copy of the GNU General Public License along with
+** this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+****************************************************************************/
+
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Row-major grid of 16 bit height samples. Rows start on ALIGNMENT byte
+// boundaries, so the distance between two rows (the stride) can be larger
+// than the number of columns. Copies share the same sample buffer.
+class HeightRaster
+{
+public:
+    static const std::size_t ALIGNMENT = 64;
+
+    HeightRaster();
+    HeightRaster(const int rows, const int cols);
+
+    // Wraps samples owned by someone else, e.g. a memory mapped file.
+    // owner is kept alive as long as any copy of the raster exists.
+    static HeightRaster view(const int16_t* data, const int rows, const int cols, const std::size_t stride,
+                             const std::shared_ptr<const void>& owner = std::shared_ptr<const void>());
+
+    int rows() const { return m_rows; }
+    int cols() const { return m_cols; }
+    std::size_t stride() const { return m_stride; }
+    bool isEmpty() const { return m_data == nullptr; }
+    bool isWritable() const { return m_writableData != nullptr; }
+
+    std::size_t sizeInBytes() const { return m_rows*m_stride*sizeof(int16_t); }
+
+    int16_t at(const int row, const int col) const {
+        return m_data[row*m_stride + col];
+    }
+
+    // Only rasters which own their samples can be written, see isWritable().
+    void set(const int row, const int col, const int16_t value) {
+        assert(isWritable());
+        m_writableData[row*m_stride + col] = value;
+    }
+
+    const int16_t* rowData(const int row) const { return m_data + row*m_stride; }
+    int16_t* writableRowData(const int row) {
+        assert(isWritable());
+        return m_writableData + row*m_stride;
+    }
+
+    const int16_t* data() const { return m_data; }
+
+    void fill(const int16_t value);
+
+    static std::size_t alignedStride(const int cols);
+
+private:
+    std::shared_ptr<const void> m_storage;
+    const int16_t* m_data;
+    int16_t* m_writableData;
+
+    int m_rows;
+    int m_cols;
+    std::size_t m_stride;
+};
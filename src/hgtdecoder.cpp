@@ -0,0 +1,238 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 Hans-Peter Schadler <hps@abyle.org>
+**
+** This program is free software: you can redistribute it and/or modify it
+** under the terms of the GNU General Public License as published by the Free
+** Software Foundation, either version 3 of the License, or (at your option)
+** any later version.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT
+** ANY WARRANTY; without even the implied warranty of  MERCHANTABILITY or
+** FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+** more details.
+**
+** You should have received a copy of the GNU General Public License along with
+** this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+****************************************************************************/
+
+
+#include "hgtdecoder.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "cpufeatures.h"
+
+#ifdef QWORLDPARSER_X86_SIMD
+    #include <immintrin.h>
+#endif
+
+const int16_t HgtDecoder::VOID_VALUE;
+
+HgtStatistics::HgtStatistics() :
+    min(std::numeric_limits<int16_t>::max()),
+    max(std::numeric_limits<int16_t>::min()),
+    voidCount(0)
+{ }
+
+void HgtStatistics::merge(const HgtStatistics& other)
+{
+    min = std::min(min, other.min);
+    max = std::max(max, other.max);
+    voidCount += other.voidCount;
+}
+
+namespace {
+    typedef void (*DecodeFunction)(const unsigned char*, int16_t*, std::size_t);
+    typedef void (*DecodeStatisticsFunction)(const unsigned char*, int16_t*, std::size_t, HgtStatistics&);
+
+    inline int16_t swapSample(const unsigned char* c)
+    {
+        return static_cast<int16_t>((c[0] << 8) | c[1]);
+    }
+
+    void decodeScalar(const unsigned char* src, int16_t* dst, std::size_t count)
+    {
+        for (std::size_t i = 0; i < count; i++) {
+            dst[i] = swapSample(src + 2*i);
+        }
+    }
+
+    void decodeStatisticsScalar(const unsigned char* src, int16_t* dst, std::size_t count, HgtStatistics& statistics)
+    {
+        for (std::size_t i = 0; i < count; i++) {
+            int16_t value = swapSample(src + 2*i);
+            dst[i] = value;
+            if (value == HgtDecoder::VOID_VALUE) {
+                statistics.voidCount++;
+            } else {
+                statistics.min = std::min(statistics.min, value);
+                statistics.max = std::max(statistics.max, value);
+            }
+        }
+    }
+
+#ifdef QWORLDPARSER_X86_SIMD
+    __attribute__((target("sse2")))
+    void decodeSse2(const unsigned char* src, int16_t* dst, std::size_t count)
+    {
+        std::size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2*i));
+            v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), v);
+        }
+        decodeScalar(src + 2*i, dst + i, count - i);
+    }
+
+    __attribute__((target("sse2")))
+    void decodeStatisticsSse2(const unsigned char* src, int16_t* dst, std::size_t count, HgtStatistics& statistics)
+    {
+        const __m128i voidValue = _mm_set1_epi16(HgtDecoder::VOID_VALUE);
+        const __m128i maxValue = _mm_set1_epi16(std::numeric_limits<int16_t>::max());
+        __m128i vmin = maxValue;
+        __m128i vmax = voidValue;
+        std::size_t voidCount = 0;
+
+        std::size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2*i));
+            v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), v);
+
+            // voids are the smallest int16 value, so they never win the max,
+            // but they have to be masked out before taking the min
+            __m128i isVoid = _mm_cmpeq_epi16(v, voidValue);
+            vmax = _mm_max_epi16(vmax, v);
+            vmin = _mm_min_epi16(vmin, _mm_or_si128(_mm_andnot_si128(isVoid, v), _mm_and_si128(isVoid, maxValue)));
+            voidCount += __builtin_popcount(_mm_movemask_epi8(isVoid))/2;
+        }
+
+        alignas(16) int16_t lanes[16];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), vmin);
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes + 8), vmax);
+        for (int lane = 0; lane < 8; lane++) {
+            statistics.min = std::min(statistics.min, lanes[lane]);
+            statistics.max = std::max(statistics.max, lanes[8 + lane]);
+        }
+        statistics.voidCount += voidCount;
+
+        decodeStatisticsScalar(src + 2*i, dst + i, count - i, statistics);
+    }
+
+    __attribute__((target("avx2")))
+    inline __m256i swapAvx2(const unsigned char* src)
+    {
+        const __m256i swapMask = _mm256_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14,
+                                                  1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+        return _mm256_shuffle_epi8(v, swapMask);
+    }
+
+    __attribute__((target("avx2")))
+    void decodeAvx2(const unsigned char* src, int16_t* dst, std::size_t count)
+    {
+        std::size_t i = 0;
+        for (; i + 16 <= count; i += 16) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), swapAvx2(src + 2*i));
+        }
+        decodeScalar(src + 2*i, dst + i, count - i);
+    }
+
+    __attribute__((target("avx2,popcnt")))
+    void decodeStatisticsAvx2(const unsigned char* src, int16_t* dst, std::size_t count, HgtStatistics& statistics)
+    {
+        const __m256i voidValue = _mm256_set1_epi16(HgtDecoder::VOID_VALUE);
+        const __m256i maxValue = _mm256_set1_epi16(std::numeric_limits<int16_t>::max());
+        __m256i vmin = maxValue;
+        __m256i vmax = voidValue;
+        std::size_t voidCount = 0;
+
+        std::size_t i = 0;
+        for (; i + 16 <= count; i += 16) {
+            __m256i v = swapAvx2(src + 2*i);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), v);
+
+            __m256i isVoid = _mm256_cmpeq_epi16(v, voidValue);
+            vmax = _mm256_max_epi16(vmax, v);
+            vmin = _mm256_min_epi16(vmin, _mm256_blendv_epi8(v, maxValue, isVoid));
+            voidCount += _mm_popcnt_u32(_mm256_movemask_epi8(isVoid))/2;
+        }
+
+        alignas(32) int16_t lanes[32];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), vmin);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes + 16), vmax);
+        for (int lane = 0; lane < 16; lane++) {
+            statistics.min = std::min(statistics.min, lanes[lane]);
+            statistics.max = std::max(statistics.max, lanes[16 + lane]);
+        }
+        statistics.voidCount += voidCount;
+
+        decodeStatisticsScalar(src + 2*i, dst + i, count - i, statistics);
+    }
+#endif
+
+    struct DecodeKernel
+    {
+        HgtDecoder::Kernel kernel;
+        DecodeFunction decode;
+        DecodeStatisticsFunction decodeStatistics;
+    };
+
+    DecodeKernel makeKernel(const HgtDecoder::Kernel kernel)
+    {
+        switch (kernel) {
+#ifdef QWORLDPARSER_X86_SIMD
+            case HgtDecoder::AVX2: return DecodeKernel{ HgtDecoder::AVX2, decodeAvx2, decodeStatisticsAvx2 };
+            case HgtDecoder::SSE2: return DecodeKernel{ HgtDecoder::SSE2, decodeSse2, decodeStatisticsSse2 };
+#endif
+            default: return DecodeKernel{ HgtDecoder::SCALAR, decodeScalar, decodeStatisticsScalar };
+        }
+    }
+
+    DecodeKernel& activeKernel()
+    {
+        static DecodeKernel kernel = makeKernel(HgtDecoder::isKernelSupported(HgtDecoder::AVX2) ? HgtDecoder::AVX2 :
+                                                HgtDecoder::isKernelSupported(HgtDecoder::SSE2) ? HgtDecoder::SSE2 :
+                                                                                                  HgtDecoder::SCALAR);
+        return kernel;
+    }
+}
+
+void HgtDecoder::decode(const unsigned char* src, int16_t* dst, const std::size_t count)
+{
+    activeKernel().decode(src, dst, count);
+}
+
+void HgtDecoder::decode(const unsigned char* src, int16_t* dst, const std::size_t count, HgtStatistics& statistics)
+{
+    activeKernel().decodeStatistics(src, dst, count, statistics);
+}
+
+HgtDecoder::Kernel HgtDecoder::getKernel()
+{
+    return activeKernel().kernel;
+}
+
+bool HgtDecoder::isKernelSupported(const Kernel kernel)
+{
+    switch (kernel) {
+        case SCALAR: return true;
+        case SSE2: return CpuFeatures::hasSse2();
+        case AVX2: return CpuFeatures::hasAvx2();
+        default: return false;
+    }
+}
+
+bool HgtDecoder::setKernel(const Kernel kernel)
+{
+    if (not isKernelSupported(kernel)) {
+        return false;
+    }
+
+    activeKernel() = makeKernel(kernel);
+
+    return true;
+}
@@ -0,0 +1,61 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 Hans-Peter Schadler <hps@abyle.org>
+**
+** This program is free software: you can redistribute it and/or modify it
+** under the terms of the GNU General Public License as published by the Free
+** Software Foundation, either version 3 of the License, or (at your option)
+** any later version.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT
+** ANY WARRANTY; without even the implied warranty of  MERCHANTABILITY or
+** FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+** more details.
+**
+** You should have received a copy of the GNU General Public License along with
+** this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+****************************************************************************/
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+struct HgtStatistics
+{
+    HgtStatistics();
+
+    void merge(const HgtStatistics& other);
+
+    int16_t min;            // smallest valid sample, INT16_MAX if there is none
+    int16_t max;            // largest valid sample, INT16_MIN if there is none
+    std::size_t voidCount;  // number of samples flagged as void
+};
+
+// Converts the big-endian samples of a HGT payload into native int16_t.
+// The fastest kernel supported by the CPU is selected on first use.
+class HgtDecoder
+{
+public:
+    static const int16_t VOID_VALUE = -32768;
+
+    enum Kernel {
+        SCALAR,
+        SSE2,
+        AVX2
+    };
+
+    // src and dst may point to the same memory, decoding in place
+    static void decode(const unsigned char* src, int16_t* dst, const std::size_t count);
+
+    // Same as decode() but additionally accumulates min/max and void count into statistics
+    static void decode(const unsigned char* src, int16_t* dst, const std::size_t count, HgtStatistics& statistics);
+
+    static Kernel getKernel();
+    static bool isKernelSupported(const Kernel kernel);
+
+    // Forces a kernel, mainly for testing and benchmarking. Returns false if the CPU lacks support.
+    static bool setKernel(const Kernel kernel);
+};
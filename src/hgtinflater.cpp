@@ -0,0 +1,306 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 Hans-Peter Schadler <hps@abyle.org>
+**
+** This program is free software: you can redistribute it and/or modify it
+** under the terms of the GNU General Public License as published by the Free
+** Software Foundation, either version 3 of the License, or (at your option)
+** any later version.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT
+** ANY WARRANTY; without even the implied warranty of  MERCHANTABILITY or
+** FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+** more details.
+**
+** You should have received a copy of the GNU General Public License along with
+** this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+****************************************************************************/
+
+
+#include "hgtinflater.h"
+
+#include <algorithm>
+#include <cctype>
+#include <iostream>
+#include <vector>
+
+#ifdef QWORLDPARSER_HAVE_ZLIB
+    #include <zlib.h>
+#endif
+
+namespace {
+    const std::size_t CHUNK_SIZE = 64*1024;
+
+    const uint32_t ZIP_LOCAL_HEADER_SIGNATURE = 0x04034b50;
+    const uint32_t ZIP_CENTRAL_HEADER_SIGNATURE = 0x02014b50;
+    const uint32_t ZIP_END_OF_DIRECTORY_SIGNATURE = 0x06054b50;
+    const std::size_t ZIP_END_OF_DIRECTORY_SIZE = 22;
+    const std::size_t ZIP_MAX_COMMENT_SIZE = 0xFFFF;
+
+    uint32_t readLittleEndian(const unsigned char* c, const int bytes)
+    {
+        uint32_t value = 0;
+        for (int i = bytes - 1; i >= 0; i--) {
+            value = (value << 8) | c[i];
+        }
+        return value;
+    }
+
+    bool readAt(std::ifstream& file, const std::size_t offset, unsigned char* buffer, const std::size_t size)
+    {
+        file.clear();
+        file.seekg(offset, std::ios_base::beg);
+        return bool(file.read(reinterpret_cast<char*>(buffer), size));
+    }
+
+    bool endsWithHgt(std::string name)
+    {
+        std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return std::tolower(c); });
+        return name.size() >= 4 && name.compare(name.size() - 4, 4, ".hgt") == 0;
+    }
+}
+
+HgtInflater::Format HgtInflater::detectFormat(const std::string& fileName)
+{
+    std::ifstream file(fileName, std::ios::binary);
+    unsigned char magic[4];
+    if (not file.read(reinterpret_cast<char*>(magic), sizeof(magic))) {
+        return PLAIN;
+    }
+
+    if (magic[0] == 0x1f && magic[1] == 0x8b) {
+        return GZIP;
+    }
+    if (readLittleEndian(magic, 4) == ZIP_LOCAL_HEADER_SIGNATURE) {
+        return ZIP;
+    }
+
+    return PLAIN;
+}
+
+bool HgtInflater::isSupported()
+{
+#ifdef QWORLDPARSER_HAVE_ZLIB
+    return true;
+#else
+    return false;
+#endif
+}
+
+HgtInflater::HgtInflater() :
+    m_format(PLAIN),
+    m_fileSize(0),
+    m_uncompressedSize(0),
+    m_compressedSize(0),
+    m_dataOffset(0),
+    m_stored(false)
+{ }
+
+bool HgtInflater::open(const std::string& fileName)
+{
+    m_format = detectFormat(fileName);
+    if (m_format == PLAIN) {
+        std::cerr << "HgtInflater::open(): " << fileName << " is neither a gzip nor a zip file" << std::endl;
+        return false;
+    }
+
+    m_file.close();
+    m_file.open(fileName, std::ios::binary);
+    m_file.seekg(0, std::ios_base::end);
+    m_fileSize = m_file.tellg();
+
+    bool ok = (m_format == GZIP) ? openGzip() : openZip();
+    if (not ok) {
+        std::cerr << "HgtInflater::open(): Can't read the archive " << fileName << std::endl;
+    }
+
+    return ok;
+}
+
+bool HgtInflater::openGzip()
+{
+    // ISIZE, the uncompressed size modulo 2^32, ends the gzip member
+    unsigned char trailer[4];
+    if (m_fileSize < 18 || not readAt(m_file, m_fileSize - 4, trailer, sizeof(trailer))) {
+        return false;
+    }
+
+    m_uncompressedSize = readLittleEndian(trailer, 4);
+    m_compressedSize = m_fileSize;
+    m_dataOffset = 0;
+    m_stored = false;
+
+    return true;
+}
+
+bool HgtInflater::openZip()
+{
+    // The central directory has the sizes even if the local header defers them to a data descriptor
+    const std::size_t tailSize = std::min(m_fileSize, ZIP_END_OF_DIRECTORY_SIZE + ZIP_MAX_COMMENT_SIZE);
+    std::vector<unsigned char> tail(tailSize);
+    if (tailSize < ZIP_END_OF_DIRECTORY_SIZE || not readAt(m_file, m_fileSize - tailSize, tail.data(), tailSize)) {
+        return false;
+    }
+
+    std::size_t endOfDirectory = tailSize - ZIP_END_OF_DIRECTORY_SIZE + 1;
+    do {
+        endOfDirectory--;
+    } while (endOfDirectory > 0 && readLittleEndian(&tail[endOfDirectory], 4) != ZIP_END_OF_DIRECTORY_SIGNATURE);
+
+    if (readLittleEndian(&tail[endOfDirectory], 4) != ZIP_END_OF_DIRECTORY_SIGNATURE) {
+        return false;
+    }
+
+    const std::size_t entries = readLittleEndian(&tail[endOfDirectory + 10], 2);
+    std::size_t offset = readLittleEndian(&tail[endOfDirectory + 16], 4);
+
+    bool found = false;
+    std::size_t localHeaderOffset = 0;
+    int method = 0;
+
+    for (std::size_t entry = 0; entry < entries; entry++) {
+        unsigned char header[46];
+        if (not readAt(m_file, offset, header, sizeof(header)) || readLittleEndian(header, 4) != ZIP_CENTRAL_HEADER_SIGNATURE) {
+            return false;
+        }
+
+        const std::size_t nameLength = readLittleEndian(header + 28, 2);
+        std::string name(nameLength, ' ');
+        if (not readAt(m_file, offset + sizeof(header), reinterpret_cast<unsigned char*>(&name[0]), nameLength)) {
+            return false;
+        }
+
+        if (endsWithHgt(name) || not found) {
+            found = true;
+            method = readLittleEndian(header + 10, 2);
+            m_compressedSize = readLittleEndian(header + 20, 4);
+            m_uncompressedSize = readLittleEndian(header + 24, 4);
+            localHeaderOffset = readLittleEndian(header + 42, 4);
+
+            if (endsWithHgt(name)) {
+                break;
+            }
+        }
+
+        offset += sizeof(header) + nameLength + readLittleEndian(header + 30, 2) + readLittleEndian(header + 32, 2);
+    }
+
+    if (not found || (method != 0 && method != 8)) {
+        return false;
+    }
+
+    unsigned char localHeader[30];
+    if (not readAt(m_file, localHeaderOffset, localHeader, sizeof(localHeader)) || readLittleEndian(localHeader, 4) != ZIP_LOCAL_HEADER_SIGNATURE) {
+        return false;
+    }
+
+    m_dataOffset = localHeaderOffset + sizeof(localHeader) + readLittleEndian(localHeader + 26, 2) + readLittleEndian(localHeader + 28, 2);
+    m_stored = (method == 0);
+
+    return m_dataOffset + m_compressedSize <= m_fileSize;
+}
+
+bool HgtInflater::inflate(HeightRaster& heightData, HgtStatistics& statistics)
+{
+    if (not m_file.is_open() || m_format == PLAIN || heightData.isEmpty()
+            || m_uncompressedSize != 2*std::size_t(heightData.rows())*heightData.cols()) {
+        return false;
+    }
+
+    m_file.clear();
+    m_file.seekg(m_dataOffset, std::ios_base::beg);
+
+    return m_stored ? readStored(heightData, statistics) : readDeflated(heightData, statistics);
+}
+
+bool HgtInflater::readStored(HeightRaster& heightData, HgtStatistics& statistics)
+{
+    for (int row = 0; row < heightData.rows(); row++) {
+        int16_t* rowData = heightData.writableRowData(row);
+        if (not m_file.read(reinterpret_cast<char*>(rowData), 2*heightData.cols())) {
+            return false;
+        }
+
+        HgtDecoder::decode(reinterpret_cast<const unsigned char*>(rowData), rowData, heightData.cols(), statistics);
+    }
+
+    return true;
+}
+
+bool HgtInflater::readDeflated(HeightRaster& heightData, HgtStatistics& statistics)
+{
+#ifdef QWORLDPARSER_HAVE_ZLIB
+    z_stream stream;
+    stream.zalloc = Z_NULL;
+    stream.zfree = Z_NULL;
+    stream.opaque = Z_NULL;
+    stream.next_in = Z_NULL;
+    stream.avail_in = 0;
+
+    // gzip wrapper for .gz files, raw deflate data in zip entries
+    if (inflateInit2(&stream, (m_format == GZIP) ? 16 + MAX_WBITS : -MAX_WBITS) != Z_OK) {
+        return false;
+    }
+
+    std::vector<unsigned char> input(CHUNK_SIZE);
+    std::size_t remainingInput = m_compressedSize;
+
+    auto inflateInto = [&](unsigned char* output, const std::size_t size, bool& streamEnd) {
+        stream.next_out = output;
+        stream.avail_out = size;
+        streamEnd = false;
+
+        while (stream.avail_out > 0 && not streamEnd) {
+            if (stream.avail_in == 0) {
+                const std::size_t chunk = std::min(remainingInput, input.size());
+                if (chunk == 0 || not m_file.read(reinterpret_cast<char*>(input.data()), chunk)) {
+                    return false;
+                }
+                remainingInput -= chunk;
+                stream.next_in = input.data();
+                stream.avail_in = chunk;
+            }
+
+            const int result = ::inflate(&stream, Z_NO_FLUSH);
+            if (result == Z_STREAM_END) {
+                streamEnd = true;
+            } else if (result != Z_OK) {
+                return false;
+            }
+        }
+
+        return true;
+    };
+
+    bool ok = true;
+    bool streamEnd = false;
+
+    for (int row = 0; ok && row < heightData.rows(); row++) {
+        // inflate a row into the raster and swap it in place while it is still in cache
+        int16_t* rowData = heightData.writableRowData(row);
+        ok = inflateInto(reinterpret_cast<unsigned char*>(rowData), 2*heightData.cols(), streamEnd)
+                && stream.avail_out == 0
+                && (not streamEnd || row == heightData.rows() - 1);
+
+        if (ok) {
+            HgtDecoder::decode(reinterpret_cast<const unsigned char*>(rowData), rowData, heightData.cols(), statistics);
+        }
+    }
+
+    // run up to the end of the stream so that the gzip checksum is verified and excess data is noticed
+    unsigned char excess;
+    while (ok && not streamEnd) {
+        ok = inflateInto(&excess, 1, streamEnd) && stream.avail_out == 1;
+    }
+
+    inflateEnd(&stream);
+
+    return ok;
+#else
+    (void)heightData;
+    (void)statistics;
+    std::cerr << "HgtInflater::inflate(): Built without zlib, compressed tiles are not supported" << std::endl;
+    return false;
+#endif
+}
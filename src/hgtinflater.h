@@ -0,0 +1,77 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 Hans-Peter Schadler <hps@abyle.org>
+**
+** This program is free software: you can redistribute it and/or modify it
+** under the terms of the GNU General Public License as published by the Free
+** Software Foundation, either version 3 of the License, or (at your option)
+** any later version.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT
+** ANY WARRANTY; without even the implied warranty of  MERCHANTABILITY or
+** FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+** more details.
+**
+** You should have received a copy of the GNU General Public License along with
+** this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+****************************************************************************/
+
+
+#pragma once
+
+#include <cstddef>
+#include <fstream>
+#include <string>
+
+#include "heightraster.h"
+#include "hgtdecoder.h"
+
+// Reads tiles distributed as .hgt.gz or .hgt.zip without unpacking them first.
+// The payload size is taken from the archive (gzip trailer, zip directory) so the
+// tile type is known up front, the samples are then inflated chunk by chunk
+// straight into the raster rows and swapped in place.
+// Deflated data needs zlib (QWORLDPARSER_HAVE_ZLIB), stored zip entries are read as is.
+class HgtInflater
+{
+public:
+    enum Format {
+        PLAIN,
+        GZIP,
+        ZIP
+    };
+
+    // Looks at the magic bytes, not the file extension
+    static Format detectFormat(const std::string& fileName);
+
+    // Whether deflated data can be read by this build
+    static bool isSupported();
+
+    HgtInflater();
+
+    HgtInflater(const HgtInflater&) = delete;
+    HgtInflater& operator=(const HgtInflater&) = delete;
+
+    // Opens a gzip or zip file and reads the metadata, zip files use their first .hgt entry
+    bool open(const std::string& fileName);
+
+    std::size_t getUncompressedSize() const { return m_uncompressedSize; }
+
+    // Fills the square raster with the payload, which must have exactly 2*rows*cols bytes
+    bool inflate(HeightRaster& heightData, HgtStatistics& statistics);
+
+private:
+    bool openGzip();
+    bool openZip();
+
+    bool readStored(HeightRaster& heightData, HgtStatistics& statistics);
+    bool readDeflated(HeightRaster& heightData, HgtStatistics& statistics);
+
+    std::ifstream m_file;
+    Format m_format;
+    std::size_t m_fileSize;
+    std::size_t m_uncompressedSize;
+    std::size_t m_compressedSize;
+    std::size_t m_dataOffset;
+    bool m_stored;
+};
@@ -0,0 +1,170 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 Hans-Peter Schadler <hps@abyle.org>
+**
+** This program is free software: you can redistribute it and/or modify it
+** under the terms of the GNU General Public License as published by the Free
+** Software Foundation, either version 3 of the License, or (at your option)
+** any later version.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT
+** ANY WARRANTY; without even the implied warranty of  MERCHANTABILITY or
+** FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+** more details.
+**
+** You should have received a copy of the GNU General Public License along with
+** this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+****************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "point.hpp"
+#include "triangle.hpp"
+
+// Indexed triangle mesh. The vertices are stored once, every triangle is a
+// triple of vertex indices in counter-clockwise order and the triple of its
+// neighbours: neighbour i is the triangle across the edge opposite corner i,
+// NO_NEIGHBOUR on the border. All arrays are flat and exposed without copying.
+template <class F>
+class Mesh
+{
+public:
+    static const int32_t NO_NEIGHBOUR = -1;
+
+    Mesh() {}
+    explicit Mesh(const std::vector<Point<F>>& vertices)
+        :m_vertices(vertices)
+    {}
+
+    void setVertices(const std::vector<Point<F>>& vertices) {
+        m_vertices = vertices;
+        clearTriangles();
+    }
+
+    void setVertices(std::vector<Point<F>>&& vertices) {
+        m_vertices = std::move(vertices);
+        clearTriangles();
+    }
+
+    // Appends a vertex and returns its index
+    uint32_t addVertex(const Point<F>& vertex) {
+        m_vertices.push_back(vertex);
+        return m_vertices.size() - 1;
+    }
+
+    void clearTriangles() {
+        m_indices.clear();
+        m_neighbours.clear();
+    }
+
+    void reserveTriangles(const std::size_t count) {
+        m_indices.reserve(3*count);
+        m_neighbours.reserve(3*count);
+    }
+
+    // Appends a triangle without neighbours and returns its index
+    uint32_t addTriangle(const uint32_t a, const uint32_t b, const uint32_t c);
+
+    // Sets count triangles without neighbours to be filled with setTriangle(), also from several threads
+    void resizeTriangles(const std::size_t count) {
+        m_indices.assign(3*count, 0);
+        m_neighbours.assign(3*count, NO_NEIGHBOUR);
+    }
+
+    void setTriangle(const uint32_t triangle, const uint32_t a, const uint32_t b, const uint32_t c) {
+        m_indices[3*triangle] = a;
+        m_indices[3*triangle + 1] = b;
+        m_indices[3*triangle + 2] = c;
+    }
+
+    void setNeighbour(const uint32_t triangle, const unsigned edge, const int32_t neighbour) {
+        m_neighbours[3*triangle + edge] = neighbour;
+    }
+
+    void removeLastTriangle() {
+        m_indices.resize(m_indices.size() - 3);
+        m_neighbours.resize(m_neighbours.size() - 3);
+    }
+
+    // Derives the neighbours of all triangles from the shared edges
+    void buildAdjacency();
+
+    std::size_t getVertexCount() const { return m_vertices.size(); }
+    std::size_t getTriangleCount() const { return m_indices.size()/3; }
+
+    const std::vector<Point<F>>& getVertices() const { return m_vertices; }
+    const Point<F>& getVertex(const uint32_t vertex) const { return m_vertices[vertex]; }
+
+    // 3*getTriangleCount() vertex indices, corner c of triangle t at 3*t + c
+    const std::vector<uint32_t>& getIndices() const { return m_indices; }
+    const uint32_t* getTriangleIndices(const uint32_t triangle) const { return m_indices.data() + 3*triangle; }
+    uint32_t getIndex(const uint32_t triangle, const unsigned corner) const { return m_indices[3*triangle + corner]; }
+    const Point<F>& getCorner(const uint32_t triangle, const unsigned corner) const { return m_vertices[m_indices[3*triangle + corner]]; }
+
+    // 3*getTriangleCount() triangle indices, the neighbour across edge e of triangle t at 3*t + e
+    const std::vector<int32_t>& getNeighbours() const { return m_neighbours; }
+    int32_t getNeighbour(const uint32_t triangle, const unsigned edge) const { return m_neighbours[3*triangle + edge]; }
+
+    // Full triangle with copies of its corners, for code working with Triangle
+    Triangle<Point<F>, F> getTriangle(const uint32_t triangle) const {
+        return Triangle<Point<F>, F>(getCorner(triangle, 0), getCorner(triangle, 1), getCorner(triangle, 2));
+    }
+
+    std::size_t getMemoryUsage() const {
+        return m_vertices.capacity()*sizeof(Point<F>)
+             + m_indices.capacity()*sizeof(uint32_t)
+             + m_neighbours.capacity()*sizeof(int32_t);
+    }
+
+private:
+    std::vector<Point<F>> m_vertices;
+    std::vector<uint32_t> m_indices;
+    std::vector<int32_t> m_neighbours;
+};
+
+template <class F>
+const int32_t Mesh<F>::NO_NEIGHBOUR;
+
+template <class F>
+uint32_t Mesh<F>::addTriangle(const uint32_t a, const uint32_t b, const uint32_t c)
+{
+    m_indices.push_back(a);
+    m_indices.push_back(b);
+    m_indices.push_back(c);
+    m_neighbours.insert(m_neighbours.end(), 3, NO_NEIGHBOUR);
+    return getTriangleCount() - 1;
+}
+
+template <class F>
+void Mesh<F>::buildAdjacency()
+{
+    // Edge (from, to) of one triangle is the edge (to, from) of its neighbour
+    std::unordered_map<uint64_t, int32_t> edges;
+    edges.reserve(m_indices.size());
+
+    std::fill(m_neighbours.begin(), m_neighbours.end(), NO_NEIGHBOUR);
+    for (uint32_t t = 0; t < getTriangleCount(); t++) {
+        for (unsigned e = 0; e < 3; e++) {
+            const uint64_t from = getIndex(t, (e + 1) % 3);
+            const uint64_t to = getIndex(t, (e + 2) % 3);
+
+            const auto twin = edges.find((to << 32) | from);
+            if (twin != edges.end()) {
+                const int32_t other = twin->second/3;
+                m_neighbours[3*t + e] = other;
+                m_neighbours[twin->second] = t;
+                edges.erase(twin);
+            } else {
+                edges[(from << 32) | to] = 3*t + e;
+            }
+        }
+    }
+}
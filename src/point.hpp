@@ -95,8 +95,8 @@ public:
     unsigned getId() const { return m_id; }
 
 private:
-     float m_x;
-     float m_y;
+     T m_x;
+     T m_y;
 
      unsigned m_id;
 };
@@ -0,0 +1,106 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 Hans-Peter Schadler <hps@abyle.org>
+**
+** This program is free software: you can redistribute it and/or modify it
+** under the terms of the GNU General Public License as published by the Free
+** Software Foundation, either version 3 of the License, or (at your option)
+** any later version.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT
+** ANY WARRANTY; without even the implied warranty of  MERCHANTABILITY or
+** FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+** more details.
+**
+** You should have received a copy of the GNU General Public License along with
+** this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+****************************************************************************/
+
+#pragma once
+
+#include <cmath>
+#include <iostream>
+
+#include "point.hpp"
+
+// Point without an id, two coordinates of T and nothing else. The working
+// arrays of the triangulation hold these, the ids are kept in a separate
+// array where they are needed. Converts from a Point, dropping its id.
+template <class T>
+class Point2
+{
+public:
+    Point2()
+        :m_x(T(0)), m_y(T(0))
+    {}
+
+    Point2(const T x, const T y)
+        :m_x(x), m_y(y)
+    {}
+
+    Point2(const Point<T>& point)
+        :m_x(point.getX()), m_y(point.getY())
+    {}
+
+    Point2<T>& operator+=(const Point2<T>& rhs)
+    {
+        m_x += rhs.m_x;
+        m_y += rhs.m_y;
+        return *this;
+    }
+
+    Point2<T>& operator-=(const Point2<T>& rhs)
+    {
+        m_x -= rhs.m_x;
+        m_y -= rhs.m_y;
+        return *this;
+    }
+
+    friend std::ostream& operator<< (std::ostream& out, const Point2<T>& point)
+    {
+        return out << "(" << point.getX() << "," << point.getY() << ")";
+    }
+
+    bool operator==(const Point2<T>& rhs) const
+    {
+        return m_x == rhs.m_x && m_y == rhs.m_y;
+    }
+
+    T dot(const Point2<T>& rhs) const
+    {
+        return m_x*rhs.m_x + m_y*rhs.m_y;
+    }
+
+    T distance(const Point2<T>& rhs) const
+    {
+        return std::sqrt((m_x - rhs.m_x)*(m_x - rhs.m_x) + (m_y - rhs.m_y)*(m_y - rhs.m_y));
+    }
+
+    // The Point with the given id
+    Point<T> toPoint(const unsigned id) const { return Point<T>(m_x, m_y, id); }
+
+    void setX(const T x) { m_x = x; }
+    T getX() const { return m_x; }
+
+    void setY(const T y) { m_y = y; }
+    T getY() const { return m_y; }
+
+private:
+    T m_x;
+    T m_y;
+};
+
+template <class T>
+inline Point2<T> operator+(Point2<T> lhs, const Point2<T>& rhs)
+{
+    lhs += rhs;
+    return lhs;
+}
+
+template <class T>
+inline Point2<T> operator-(Point2<T> lhs, const Point2<T>& rhs)
+{
+    lhs -= rhs;
+    return lhs;
+}
@@ -0,0 +1,346 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 Hans-Peter Schadler <hps@abyle.org>
+**
+** This program is free software: you can redistribute it and/or modify it
+** under the terms of the GNU General Public License as published by the Free
+** Software Foundation, either version 3 of the License, or (at your option)
+** any later version.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT
+** ANY WARRANTY; without even the implied warranty of  MERCHANTABILITY or
+** FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+** more details.
+**
+** You should have received a copy of the GNU General Public License along with
+** this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+****************************************************************************/
+
+#include "pointcloud.h"
+
+#include <algorithm>
+#include <iostream>
+#include <limits>
+
+#include "cpufeatures.h"
+#include "srtmparser.h"
+
+#ifdef QWORLDPARSER_X86_SIMD
+    #include <immintrin.h>
+#endif
+
+PointCloudBounds::PointCloudBounds() :
+    minX(std::numeric_limits<double>::infinity()),
+    minY(std::numeric_limits<double>::infinity()),
+    minZ(std::numeric_limits<double>::infinity()),
+    maxX(-std::numeric_limits<double>::infinity()),
+    maxY(-std::numeric_limits<double>::infinity()),
+    maxZ(-std::numeric_limits<double>::infinity())
+{ }
+
+void PointCloudBounds::merge(const PointCloudBounds& other)
+{
+    minX = std::min(minX, other.minX);
+    minY = std::min(minY, other.minY);
+    minZ = std::min(minZ, other.minZ);
+    maxX = std::max(maxX, other.maxX);
+    maxY = std::max(maxY, other.maxY);
+    maxZ = std::max(maxZ, other.maxZ);
+}
+
+AffineTransform::AffineTransform() :
+    xx(1.0), xy(0.0), dx(0.0),
+    yx(0.0), yy(1.0), dy(0.0),
+    zz(1.0), dz(0.0)
+{ }
+
+AffineTransform AffineTransform::translation(const double dx, const double dy, const double dz)
+{
+    AffineTransform transform;
+    transform.dx = dx;
+    transform.dy = dy;
+    transform.dz = dz;
+    return transform;
+}
+
+AffineTransform AffineTransform::scaling(const double sx, const double sy, const double sz)
+{
+    AffineTransform transform;
+    transform.xx = sx;
+    transform.yy = sy;
+    transform.zz = sz;
+    return transform;
+}
+
+AffineTransform AffineTransform::then(const AffineTransform& next) const
+{
+    AffineTransform result;
+    result.xx = next.xx*xx + next.xy*yx;
+    result.xy = next.xx*xy + next.xy*yy;
+    result.dx = next.xx*dx + next.xy*dy + next.dx;
+    result.yx = next.yx*xx + next.yy*yx;
+    result.yy = next.yx*xy + next.yy*yy;
+    result.dy = next.yx*dx + next.yy*dy + next.dy;
+    result.zz = next.zz*zz;
+    result.dz = next.zz*dz + next.dz;
+    return result;
+}
+
+bool AffineTransform::invert(AffineTransform& inverse) const
+{
+    const double det = xx*yy - xy*yx;
+    if (det == 0.0 || zz == 0.0) {
+        return false;
+    }
+    inverse.xx = yy/det;
+    inverse.xy = -xy/det;
+    inverse.yx = -yx/det;
+    inverse.yy = xx/det;
+    inverse.dx = -(inverse.xx*dx + inverse.xy*dy);
+    inverse.dy = -(inverse.yx*dx + inverse.yy*dy);
+    inverse.zz = 1.0/zz;
+    inverse.dz = -dz/zz;
+    return true;
+}
+
+namespace {
+    typedef void (*MinMaxFunction)(const double*, std::size_t, double&, double&);
+    typedef void (*TransformFunction)(const AffineTransform&, double*, double*, std::size_t);
+    typedef void (*ScaleFunction)(double, double, double*, std::size_t);
+
+    // NaN compares false and is skipped, like the value in _mm_min_pd(value, min)
+    void minMaxScalar(const double* values, std::size_t count, double& min, double& max)
+    {
+        for (std::size_t i = 0; i < count; i++) {
+            if (values[i] < min) min = values[i];
+            if (values[i] > max) max = values[i];
+        }
+    }
+
+    void transformScalar(const AffineTransform& t, double* xs, double* ys, std::size_t count)
+    {
+        for (std::size_t i = 0; i < count; i++) {
+            const double x = xs[i];
+            const double y = ys[i];
+            xs[i] = (t.xx*x + t.xy*y) + t.dx;
+            ys[i] = (t.yx*x + t.yy*y) + t.dy;
+        }
+    }
+
+    void scaleScalar(double factor, double offset, double* values, std::size_t count)
+    {
+        for (std::size_t i = 0; i < count; i++) {
+            values[i] = factor*values[i] + offset;
+        }
+    }
+
+#ifdef QWORLDPARSER_X86_SIMD
+    __attribute__((target("sse2")))
+    void minMaxSse2(const double* values, std::size_t count, double& min, double& max)
+    {
+        // the value is the first operand, a NaN value then yields the second one, the running min/max
+        __m128d vmin = _mm_set1_pd(min);
+        __m128d vmax = _mm_set1_pd(max);
+        std::size_t i = 0;
+        for (; i + 2 <= count; i += 2) {
+            const __m128d v = _mm_loadu_pd(values + i);
+            vmin = _mm_min_pd(v, vmin);
+            vmax = _mm_max_pd(v, vmax);
+        }
+
+        alignas(16) double lanes[4];
+        _mm_store_pd(lanes, vmin);
+        _mm_store_pd(lanes + 2, vmax);
+        for (int lane = 0; lane < 2; lane++) {
+            if (lanes[lane] < min) min = lanes[lane];
+            if (lanes[2 + lane] > max) max = lanes[2 + lane];
+        }
+        minMaxScalar(values + i, count - i, min, max);
+    }
+
+    __attribute__((target("sse2")))
+    void transformSse2(const AffineTransform& t, double* xs, double* ys, std::size_t count)
+    {
+        const __m128d xx = _mm_set1_pd(t.xx), xy = _mm_set1_pd(t.xy), dx = _mm_set1_pd(t.dx);
+        const __m128d yx = _mm_set1_pd(t.yx), yy = _mm_set1_pd(t.yy), dy = _mm_set1_pd(t.dy);
+        std::size_t i = 0;
+        for (; i + 2 <= count; i += 2) {
+            const __m128d x = _mm_loadu_pd(xs + i);
+            const __m128d y = _mm_loadu_pd(ys + i);
+            _mm_storeu_pd(xs + i, _mm_add_pd(_mm_add_pd(_mm_mul_pd(xx, x), _mm_mul_pd(xy, y)), dx));
+            _mm_storeu_pd(ys + i, _mm_add_pd(_mm_add_pd(_mm_mul_pd(yx, x), _mm_mul_pd(yy, y)), dy));
+        }
+        transformScalar(t, xs + i, ys + i, count - i);
+    }
+
+    __attribute__((target("sse2")))
+    void scaleSse2(double factor, double offset, double* values, std::size_t count)
+    {
+        const __m128d f = _mm_set1_pd(factor);
+        const __m128d o = _mm_set1_pd(offset);
+        std::size_t i = 0;
+        for (; i + 2 <= count; i += 2) {
+            _mm_storeu_pd(values + i, _mm_add_pd(_mm_mul_pd(f, _mm_loadu_pd(values + i)), o));
+        }
+        scaleScalar(factor, offset, values + i, count - i);
+    }
+
+    __attribute__((target("avx2")))
+    void minMaxAvx2(const double* values, std::size_t count, double& min, double& max)
+    {
+        __m256d vmin = _mm256_set1_pd(min);
+        __m256d vmax = _mm256_set1_pd(max);
+        std::size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            const __m256d v = _mm256_loadu_pd(values + i);
+            vmin = _mm256_min_pd(v, vmin);
+            vmax = _mm256_max_pd(v, vmax);
+        }
+
+        alignas(32) double lanes[8];
+        _mm256_store_pd(lanes, vmin);
+        _mm256_store_pd(lanes + 4, vmax);
+        for (int lane = 0; lane < 4; lane++) {
+            if (lanes[lane] < min) min = lanes[lane];
+            if (lanes[4 + lane] > max) max = lanes[4 + lane];
+        }
+        minMaxScalar(values + i, count - i, min, max);
+    }
+
+    __attribute__((target("avx2")))
+    void transformAvx2(const AffineTransform& t, double* xs, double* ys, std::size_t count)
+    {
+        const __m256d xx = _mm256_set1_pd(t.xx), xy = _mm256_set1_pd(t.xy), dx = _mm256_set1_pd(t.dx);
+        const __m256d yx = _mm256_set1_pd(t.yx), yy = _mm256_set1_pd(t.yy), dy = _mm256_set1_pd(t.dy);
+        std::size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            const __m256d x = _mm256_loadu_pd(xs + i);
+            const __m256d y = _mm256_loadu_pd(ys + i);
+            _mm256_storeu_pd(xs + i, _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(xx, x), _mm256_mul_pd(xy, y)), dx));
+            _mm256_storeu_pd(ys + i, _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(yx, x), _mm256_mul_pd(yy, y)), dy));
+        }
+        transformScalar(t, xs + i, ys + i, count - i);
+    }
+
+    __attribute__((target("avx2")))
+    void scaleAvx2(double factor, double offset, double* values, std::size_t count)
+    {
+        const __m256d f = _mm256_set1_pd(factor);
+        const __m256d o = _mm256_set1_pd(offset);
+        std::size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            _mm256_storeu_pd(values + i, _mm256_add_pd(_mm256_mul_pd(f, _mm256_loadu_pd(values + i)), o));
+        }
+        scaleScalar(factor, offset, values + i, count - i);
+    }
+#endif
+
+    struct PointCloudKernel
+    {
+        PointCloud::Kernel kernel;
+        MinMaxFunction minMax;
+        TransformFunction transform;
+        ScaleFunction scale;
+    };
+
+    PointCloudKernel makeKernel(const PointCloud::Kernel kernel)
+    {
+        switch (kernel) {
+#ifdef QWORLDPARSER_X86_SIMD
+            case PointCloud::AVX2: return PointCloudKernel{ PointCloud::AVX2, minMaxAvx2, transformAvx2, scaleAvx2 };
+            case PointCloud::SSE2: return PointCloudKernel{ PointCloud::SSE2, minMaxSse2, transformSse2, scaleSse2 };
+#endif
+            default: return PointCloudKernel{ PointCloud::SCALAR, minMaxScalar, transformScalar, scaleScalar };
+        }
+    }
+
+    PointCloudKernel& activeKernel()
+    {
+        static PointCloudKernel kernel = makeKernel(PointCloud::isKernelSupported(PointCloud::AVX2) ? PointCloud::AVX2 :
+                                                    PointCloud::isKernelSupported(PointCloud::SSE2) ? PointCloud::SSE2 :
+                                                                                                      PointCloud::SCALAR);
+        return kernel;
+    }
+}
+
+PointCloudBounds PointCloud::getBounds() const
+{
+    return getBounds(getXs().data(), getYs().data(), getZs().data(), size());
+}
+
+PointCloudBounds PointCloud::getBounds(const double* xs, const double* ys, const double* zs, const std::size_t count)
+{
+    PointCloudBounds bounds;
+    const MinMaxFunction minMax = activeKernel().minMax;
+    minMax(xs, count, bounds.minX, bounds.maxX);
+    minMax(ys, count, bounds.minY, bounds.maxY);
+    minMax(zs, count, bounds.minZ, bounds.maxZ);
+    return bounds;
+}
+
+void PointCloud::transform(const AffineTransform& transform)
+{
+    PointCloud::transform(transform, getXs().data(), getYs().data(), getZs().data(), size());
+}
+
+void PointCloud::transform(const AffineTransform& transform, double* xs, double* ys, double* zs, const std::size_t count)
+{
+    activeKernel().transform(transform, xs, ys, count);
+    if (transform.zz != 1.0 || transform.dz != 0.0) {
+        activeKernel().scale(transform.zz, transform.dz, zs, count);
+    }
+}
+
+double PointCloud::getMetresPerDegreeLat(const double latitude, const double longitude)
+{
+    return SRTMParser::calcDistance(latitude, latitude + 1.0, longitude, longitude);
+}
+
+double PointCloud::getMetresPerDegreeLon(const double latitude, const double longitude)
+{
+    return 0.5*(SRTMParser::calcDistance(latitude, latitude, longitude, longitude + 1.0)
+              + SRTMParser::calcDistance(latitude + 1.0, latitude + 1.0, longitude, longitude + 1.0));
+}
+
+AffineTransform PointCloud::latLonToMetres(const double latOrigin, const double lonOrigin)
+{
+    return AffineTransform::translation(-latOrigin, -lonOrigin)
+            .then(AffineTransform::scaling(getMetresPerDegreeLat(latOrigin, lonOrigin), getMetresPerDegreeLon(latOrigin, lonOrigin)));
+}
+
+void PointCloud::toLatLon(const double latOrigin, const double lonOrigin)
+{
+    AffineTransform inverse;
+    if (not latLonToMetres(latOrigin, lonOrigin).invert(inverse)) {
+        std::cerr << "PointCloud::toLatLon(): No metres per degree at " << latOrigin << "," << lonOrigin << std::endl;
+        return;
+    }
+    transform(inverse);
+}
+
+PointCloud::Kernel PointCloud::getKernel()
+{
+    return activeKernel().kernel;
+}
+
+bool PointCloud::isKernelSupported(const Kernel kernel)
+{
+    switch (kernel) {
+        case SCALAR: return true;
+        case SSE2: return CpuFeatures::hasSse2();
+        case AVX2: return CpuFeatures::hasAvx2();
+        default: return false;
+    }
+}
+
+bool PointCloud::setKernel(const Kernel kernel)
+{
+    if (not isKernelSupported(kernel)) {
+        return false;
+    }
+
+    activeKernel() = makeKernel(kernel);
+
+    return true;
+}
@@ -0,0 +1,121 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 Hans-Peter Schadler <hps@abyle.org>
+**
+** This program is free software: you can redistribute it and/or modify it
+** under the terms of the GNU General Public License as published by the Free
+** Software Foundation, either version 3 of the License, or (at your option)
+** any later version.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT
+** ANY WARRANTY; without even the implied warranty of  MERCHANTABILITY or
+** FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+** more details.
+**
+** You should have received a copy of the GNU General Public License along with
+** this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+****************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "point.hpp"
+#include "vertexbuffer.hpp"
+
+// Axis aligned bounds of a point cloud. Empty bounds have min > max, NaN
+// coordinates are left out like void samples.
+struct PointCloudBounds
+{
+    PointCloudBounds();
+
+    void merge(const PointCloudBounds& other);
+    bool isEmpty() const { return not(minX <= maxX); }
+
+    double minX;
+    double minY;
+    double minZ;
+    double maxX;
+    double maxY;
+    double maxZ;
+};
+
+// x' = xx*x + xy*y + dx, y' = yx*x + yy*y + dy, z' = zz*z + dz
+struct AffineTransform
+{
+    AffineTransform();      // identity
+
+    static AffineTransform translation(const double dx, const double dy, const double dz = 0.0);
+    static AffineTransform scaling(const double sx, const double sy, const double sz = 1.0);
+    static AffineTransform scaling(const double s) { return scaling(s, s, s); }
+
+    // This transform followed by next
+    AffineTransform then(const AffineTransform& next) const;
+
+    // Undoes this transform, false if the xy part is singular or zz is 0
+    bool invert(AffineTransform& inverse) const;
+
+    double xx, xy, dx;
+    double yx, yy, dy;
+    double zz, dz;
+};
+
+// Point cloud as structure of arrays, see VertexBuffer, with the bulk passes
+// the GUI and the writers run over tens of millions of points: bounds, affine
+// transforms, lat/lon to metres and heights from a raster. The passes stream
+// through the coordinate arrays with the fastest kernel the CPU supports,
+// selected on first use. All kernels give the same results, no fused
+// multiply-add is used.
+//
+// Coordinates follow the rest of the project: x is the latitude and y the
+// longitude, or the distances along them in metres.
+class PointCloud : public VertexBuffer<double>
+{
+public:
+    enum Kernel {
+        SCALAR,
+        SSE2,
+        AVX2
+    };
+
+    PointCloud() {}
+    explicit PointCloud(const std::vector<Point<double>>& points, const std::vector<double>& heights = std::vector<double>())
+        :VertexBuffer<double>(points, heights)
+    {}
+
+    PointCloudBounds getBounds() const;
+    static PointCloudBounds getBounds(const double* xs, const double* ys, const double* zs, const std::size_t count);
+
+    void transform(const AffineTransform& transform);
+    static void transform(const AffineTransform& transform, double* xs, double* ys, double* zs, const std::size_t count);
+
+    // Metres per degree around (latitude, longitude), like the height map export measures them:
+    // along the meridian at the longitude, along the parallels averaged over the degree north
+    static double getMetresPerDegreeLat(const double latitude, const double longitude);
+    static double getMetresPerDegreeLon(const double latitude, const double longitude);
+
+    // Latitude and longitude to metres north and east of the origin, and back
+    static AffineTransform latLonToMetres(const double latOrigin, const double lonOrigin);
+    void toMetres(const double latOrigin, const double lonOrigin) { transform(latLonToMetres(latOrigin, lonOrigin)); }
+    void toLatLon(const double latOrigin, const double lonOrigin);
+
+    // z = height at latitude x and longitude y, source is a SRTMParser or a TerrainMosaic
+    // and interpolationType one of SRTMParser::InterpolationType, by default that of the source
+    template <class HeightSource>
+    void attachHeights(HeightSource& source) {
+        source.getHeights(getXs().data(), getYs().data(), getZs().data(), size());
+    }
+
+    template <class HeightSource, class InterpolationType>
+    void attachHeights(HeightSource& source, const InterpolationType interpolationType) {
+        source.getHeights(getXs().data(), getYs().data(), getZs().data(), size(), interpolationType);
+    }
+
+    static Kernel getKernel();
+    static bool isKernelSupported(const Kernel kernel);
+
+    // Forces a kernel, mainly for testing and benchmarking. Returns false if the CPU lacks support.
+    static bool setKernel(const Kernel kernel);
+};
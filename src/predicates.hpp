@@ -0,0 +1,375 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 Hans-Peter Schadler <hps@abyle.org>
+**
+** This program is free software: you can redistribute it and/or modify it
+** under the terms of the GNU General Public License as published by the Free
+** Software Foundation, either version 3 of the License, or (at your option)
+** any later version.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT
+** ANY WARRANTY; without even the implied warranty of  MERCHANTABILITY or
+** FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+** more details.
+**
+** You should have received a copy of the GNU General Public License along with
+** this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+****************************************************************************/
+
+
+#pragma once
+
+#include <cmath>
+
+// Robust geometric predicates after J. R. Shewchuk, "Adaptive Precision
+// Floating-Point Arithmetic and Fast Robust Geometric Predicates" (1997).
+// The determinant is first evaluated in double together with an error bound.
+// Only when the bound does not settle the sign, which happens for (nearly)
+// collinear and cocircular points such as the corners of a grid cell, is it
+// evaluated again exactly with floating-point expansions. The sign of the
+// result is always correct, its magnitude only approximates the determinant.
+//
+// Expects IEEE 754 doubles rounding to nearest, without extended precision
+// for intermediate results (true for SSE2 and every 64-bit target).
+class Predicates
+{
+public:
+    // > 0 if a, b, c are counter-clockwise, < 0 if clockwise, 0 if collinear
+    static double orient2d(const double ax, const double ay, const double bx, const double by,
+                           const double cx, const double cy);
+
+    // > 0 if d lies inside the circumcircle of the counter-clockwise triangle a, b, c,
+    // < 0 if outside, 0 if the four points are cocircular. The sign flips for clockwise a, b, c.
+    static double incircle(const double ax, const double ay, const double bx, const double by,
+                           const double cx, const double cy, const double dx, const double dy);
+
+    template <class P>
+    static double orient2d(const P& a, const P& b, const P& c) {
+        return orient2d(a.getX(), a.getY(), b.getX(), b.getY(), c.getX(), c.getY());
+    }
+
+    template <class P>
+    static double incircle(const P& a, const P& b, const P& c, const P& d) {
+        return incircle(a.getX(), a.getY(), b.getX(), b.getY(), c.getX(), c.getY(), d.getX(), d.getY());
+    }
+
+private:
+    static constexpr double EPSILON = 1.1102230246251565e-16;     // 2^-53
+    static constexpr double SPLITTER = 134217729.0;               // 2^27 + 1
+    static constexpr double ORIENT_ERROR_BOUND = (3.0 + 16.0*EPSILON)*EPSILON;
+    static constexpr double INCIRCLE_ERROR_BOUND = (10.0 + 96.0*EPSILON)*EPSILON;
+
+    // Largest expansions of the exact evaluations
+    static const int DIFFERENCE_SIZE = 2;
+    static const int SQUARE_SUM_SIZE = 16;
+    static const int CROSS_SIZE = 16;
+    static const int TERM_SIZE = 2*SQUARE_SUM_SIZE*CROSS_SIZE;
+
+    static double orient2dExact(const double ax, const double ay, const double bx, const double by,
+                                const double cx, const double cy);
+    static double incircleExact(const double ax, const double ay, const double bx, const double by,
+                                const double cx, const double cy, const double dx, const double dy);
+
+    // x + y = sum + error exactly
+    static void twoSum(const double a, const double b, double& sum, double& error) {
+        sum = a + b;
+        const double bVirtual = sum - a;
+        const double aVirtual = sum - bVirtual;
+        error = (a - aVirtual) + (b - bVirtual);
+    }
+
+    static void twoDiff(const double a, const double b, double& difference, double& error) {
+        difference = a - b;
+        const double bVirtual = a - difference;
+        const double aVirtual = difference + bVirtual;
+        error = (a - aVirtual) + (bVirtual - b);
+    }
+
+    static void split(const double a, double& high, double& low) {
+        const double c = SPLITTER*a;
+        const double big = c - a;
+        high = c - big;
+        low = a - high;
+    }
+
+    // a*b = product + error exactly
+    static void twoProduct(const double a, const double b, double& product, double& error) {
+        product = a*b;
+        double aHigh, aLow, bHigh, bLow;
+        split(a, aHigh, aLow);
+        split(b, bHigh, bLow);
+        error = aLow*bLow - (((product - aHigh*bHigh) - aLow*bHigh) - aHigh*bLow);
+    }
+
+    // Expansions are sums of non-overlapping doubles in increasing magnitude
+    // without zero components, the last component carries the sign.
+    static int sumExpansions(const int eLength, const double* e, const int fLength, const double* f, double* h);
+    static int scaleExpansion(const int eLength, const double* e, const double b, double* h);
+    static int multiplyExpansions(const int eLength, const double* e, const int fLength, const double* f,
+                                  double* h, double* scratch);
+    static int difference(const double a, const double b, double* h);
+
+    static double sign(const int length, const double* e) { return length > 0 ? e[length - 1] : 0.0; }
+};
+
+inline double Predicates::orient2d(const double ax, const double ay, const double bx, const double by,
+                                   const double cx, const double cy)
+{
+    const double left = (ax - cx)*(by - cy);
+    const double right = (ay - cy)*(bx - cx);
+    const double det = left - right;
+
+    // the products have opposite signs, the difference can't cancel
+    if ((left > 0.0 && right <= 0.0) || (left < 0.0 && right >= 0.0) || left == 0.0) {
+        return det;
+    }
+
+    const double bound = ORIENT_ERROR_BOUND*std::fabs(left + right);
+    if (det >= bound || -det >= bound) {
+        return det;
+    }
+
+    return orient2dExact(ax, ay, bx, by, cx, cy);
+}
+
+inline double Predicates::incircle(const double ax, const double ay, const double bx, const double by,
+                                   const double cx, const double cy, const double dx, const double dy)
+{
+    const double adx = ax - dx;
+    const double ady = ay - dy;
+    const double bdx = bx - dx;
+    const double bdy = by - dy;
+    const double cdx = cx - dx;
+    const double cdy = cy - dy;
+
+    const double bdxcdy = bdx*cdy;
+    const double cdxbdy = cdx*bdy;
+    const double aLift = adx*adx + ady*ady;
+
+    const double cdxady = cdx*ady;
+    const double adxcdy = adx*cdy;
+    const double bLift = bdx*bdx + bdy*bdy;
+
+    const double adxbdy = adx*bdy;
+    const double bdxady = bdx*ady;
+    const double cLift = cdx*cdx + cdy*cdy;
+
+    const double det = aLift*(bdxcdy - cdxbdy) + bLift*(cdxady - adxcdy) + cLift*(adxbdy - bdxady);
+
+    const double permanent = (std::fabs(bdxcdy) + std::fabs(cdxbdy))*aLift
+                           + (std::fabs(cdxady) + std::fabs(adxcdy))*bLift
+                           + (std::fabs(adxbdy) + std::fabs(bdxady))*cLift;
+    const double bound = INCIRCLE_ERROR_BOUND*permanent;
+    if (det > bound || -det > bound) {
+        return det;
+    }
+
+    return incircleExact(ax, ay, bx, by, cx, cy, dx, dy);
+}
+
+inline int Predicates::sumExpansions(const int eLength, const double* e, const int fLength, const double* f, double* h)
+{
+    // fast_expansion_sum_zeroelim: merge by magnitude, then accumulate with two-sums
+    double q, qNew, hh;
+    double eNow = e[0];
+    double fNow = f[0];
+    int eIndex = 0;
+    int fIndex = 0;
+    if ((fNow > eNow) == (fNow > -eNow)) {
+        q = eNow;
+        eNow = (++eIndex < eLength) ? e[eIndex] : 0.0;
+    } else {
+        q = fNow;
+        fNow = (++fIndex < fLength) ? f[fIndex] : 0.0;
+    }
+
+    int hIndex = 0;
+    if (eIndex < eLength && fIndex < fLength) {
+        if ((fNow > eNow) == (fNow > -eNow)) {
+            qNew = eNow + q;
+            hh = q - (qNew - eNow);
+            eNow = (++eIndex < eLength) ? e[eIndex] : 0.0;
+        } else {
+            qNew = fNow + q;
+            hh = q - (qNew - fNow);
+            fNow = (++fIndex < fLength) ? f[fIndex] : 0.0;
+        }
+        q = qNew;
+        if (hh != 0.0) {
+            h[hIndex++] = hh;
+        }
+
+        while (eIndex < eLength && fIndex < fLength) {
+            if ((fNow > eNow) == (fNow > -eNow)) {
+                twoSum(q, eNow, qNew, hh);
+                eNow = (++eIndex < eLength) ? e[eIndex] : 0.0;
+            } else {
+                twoSum(q, fNow, qNew, hh);
+                fNow = (++fIndex < fLength) ? f[fIndex] : 0.0;
+            }
+            q = qNew;
+            if (hh != 0.0) {
+                h[hIndex++] = hh;
+            }
+        }
+    }
+
+    while (eIndex < eLength) {
+        twoSum(q, eNow, qNew, hh);
+        eNow = (++eIndex < eLength) ? e[eIndex] : 0.0;
+        q = qNew;
+        if (hh != 0.0) {
+            h[hIndex++] = hh;
+        }
+    }
+    while (fIndex < fLength) {
+        twoSum(q, fNow, qNew, hh);
+        fNow = (++fIndex < fLength) ? f[fIndex] : 0.0;
+        q = qNew;
+        if (hh != 0.0) {
+            h[hIndex++] = hh;
+        }
+    }
+
+    if (q != 0.0 || hIndex == 0) {
+        h[hIndex++] = q;
+    }
+    return hIndex;
+}
+
+inline int Predicates::scaleExpansion(const int eLength, const double* e, const double b, double* h)
+{
+    // scale_expansion_zeroelim
+    double q, sum, hh, product1, product0;
+    twoProduct(e[0], b, q, hh);
+    int hIndex = 0;
+    if (hh != 0.0) {
+        h[hIndex++] = hh;
+    }
+    for (int i = 1; i < eLength; i++) {
+        twoProduct(e[i], b, product1, product0);
+        twoSum(q, product0, sum, hh);
+        if (hh != 0.0) {
+            h[hIndex++] = hh;
+        }
+        q = product1 + sum;
+        hh = sum - (q - product1);
+        if (hh != 0.0) {
+            h[hIndex++] = hh;
+        }
+    }
+    if (q != 0.0 || hIndex == 0) {
+        h[hIndex++] = q;
+    }
+    return hIndex;
+}
+
+inline int Predicates::multiplyExpansions(const int eLength, const double* e, const int fLength, const double* f,
+                                          double* h, double* scratch)
+{
+    // sum of e scaled by every component of f; h and scratch hold 2*eLength*fLength values each
+    int hLength = scaleExpansion(eLength, e, f[0], h);
+    for (int i = 1; i < fLength; i++) {
+        double* scaled = scratch;
+        const int scaledLength = scaleExpansion(eLength, e, f[i], scaled);
+        double* sum = scratch + 2*eLength;
+        const int sumLength = sumExpansions(hLength, h, scaledLength, scaled, sum);
+        for (int k = 0; k < sumLength; k++) {
+            h[k] = sum[k];
+        }
+        hLength = sumLength;
+    }
+    return hLength;
+}
+
+inline int Predicates::difference(const double a, const double b, double* h)
+{
+    double d, error;
+    twoDiff(a, b, d, error);
+    int length = 0;
+    if (error != 0.0) {
+        h[length++] = error;
+    }
+    if (d != 0.0 || length == 0) {
+        h[length++] = d;
+    }
+    return length;
+}
+
+inline double Predicates::orient2dExact(const double ax, const double ay, const double bx, const double by,
+                                        const double cx, const double cy)
+{
+    // (ax - cx)*(by - cy) - (ay - cy)*(bx - cx) with exact differences and products
+    double acx[DIFFERENCE_SIZE], acy[DIFFERENCE_SIZE], bcx[DIFFERENCE_SIZE], bcy[DIFFERENCE_SIZE];
+    const int acxLength = difference(ax, cx, acx);
+    const int acyLength = difference(ay, cy, acy);
+    const int bcxLength = difference(bx, cx, bcx);
+    const int bcyLength = difference(by, cy, bcy);
+
+    double left[8], right[8], scratch[16];
+    const int leftLength = multiplyExpansions(acxLength, acx, bcyLength, bcy, left, scratch);
+    int rightLength = multiplyExpansions(acyLength, acy, bcxLength, bcx, right, scratch);
+    for (int i = 0; i < rightLength; i++) {
+        right[i] = -right[i];
+    }
+
+    double det[16];
+    return sign(sumExpansions(leftLength, left, rightLength, right, det), det);
+}
+
+inline double Predicates::incircleExact(const double ax, const double ay, const double bx, const double by,
+                                        const double cx, const double cy, const double dx, const double dy)
+{
+    double diffX[3][DIFFERENCE_SIZE], diffY[3][DIFFERENCE_SIZE];
+    int diffXLength[3], diffYLength[3];
+    diffXLength[0] = difference(ax, dx, diffX[0]);
+    diffYLength[0] = difference(ay, dy, diffY[0]);
+    diffXLength[1] = difference(bx, dx, diffX[1]);
+    diffYLength[1] = difference(by, dy, diffY[1]);
+    diffXLength[2] = difference(cx, dx, diffX[2]);
+    diffYLength[2] = difference(cy, dy, diffY[2]);
+
+    double scratch[2*2*CROSS_SIZE];
+    double det[3*TERM_SIZE];
+    double sum[3*TERM_SIZE];
+    int detLength = 0;
+
+    // det = sum over the rows i of lift_i * (x_j*y_k - x_k*y_j) with j, k the following rows
+    for (int i = 0; i < 3; i++) {
+        const int j = (i + 1) % 3;
+        const int k = (i + 2) % 3;
+
+        double xx[8], yy[8], lift[SQUARE_SUM_SIZE];
+        const int xxLength = multiplyExpansions(diffXLength[i], diffX[i], diffXLength[i], diffX[i], xx, scratch);
+        const int yyLength = multiplyExpansions(diffYLength[i], diffY[i], diffYLength[i], diffY[i], yy, scratch);
+        const int liftLength = sumExpansions(xxLength, xx, yyLength, yy, lift);
+
+        double xy[8], yx[8], cross[CROSS_SIZE];
+        const int xyLength = multiplyExpansions(diffXLength[j], diffX[j], diffYLength[k], diffY[k], xy, scratch);
+        const int yxLength = multiplyExpansions(diffXLength[k], diffX[k], diffYLength[j], diffY[j], yx, scratch);
+        for (int n = 0; n < yxLength; n++) {
+            yx[n] = -yx[n];
+        }
+        const int crossLength = sumExpansions(xyLength, xy, yxLength, yx, cross);
+
+        double term[TERM_SIZE];
+        double termScratch[2*CROSS_SIZE + TERM_SIZE];
+        const int termLength = multiplyExpansions(crossLength, cross, liftLength, lift, term, termScratch);
+
+        if (detLength == 0) {
+            for (int n = 0; n < termLength; n++) {
+                det[n] = term[n];
+            }
+            detLength = termLength;
+        } else {
+            const int sumLength = sumExpansions(detLength, det, termLength, term, sum);
+            for (int n = 0; n < sumLength; n++) {
+                det[n] = sum[n];
+            }
+            detLength = sumLength;
+        }
+    }
+
+    return sign(detLength, det);
+}
@@ -24,6 +24,7 @@
 #include <cstdlib>
 #include <iostream>
 #include <fstream>
+#include <mutex>
 
 #include <QElapsedTimer>
 #include <QFileDialog>
@@ -33,8 +34,13 @@
 #include <QtDataVisualization>
 #include <QtMath>
 
-#include "delaunay.hpp"
+#include "gridmesh.hpp"
+#include "gridresampler.h"
+#include "terrainmosaic.h"
+#include "triangulationexecutor.hpp"
 #include "point.hpp"
+#include "pointcloud.h"
+#include "vertexbuffer.hpp"
 #include "heightmapscatterplot.hpp"
 
 using namespace QtDataVisualization;
@@ -120,30 +126,33 @@ void QWorldParser::doHeightMapParsing()
         return;
     }
 
-    QString NorS = ((latStart >= 0) ? QString("N") : QString("S"));
-    QString EorW = (lonStart >= 0) ? QString("E") : QString("W");
-    QString fileName = path + QString("/")
-                     + NorS + QString::number(abs(floor(latStart))).rightJustified(2, '0')
-                     + EorW + QString::number(abs(floor(lonStart))).rightJustified(3, '0')
-                     + QString(".hgt");
+    // the area may span several tiles, they are loaded from the hgt folder as needed
+    TerrainMosaic terrainMosaic(path.toStdString());
 
-    m_srtmParser = new SRTMParser(fileName.toStdString());
+    RegularGrid grid = RegularGrid::fromRange(latStart, latEnd, latRes, lonStart, lonEnd, lonRes);
+    std::vector<double> heights = terrainMosaic.resample(grid);
 
-    if(m_srtmParser->parseData()) {
-        QScatterDataArray *dataArray = new QScatterDataArray;
+    if (terrainMosaic.getCachedTileCount() == 0) {
+        critError(QString("Couldn't parse Heightmap data. Check if the hgt files for the selected area exist in ") + path);
+        return;
+    }
 
-        for (float lat = latStart; lat <= latEnd; lat += latRes) {
-            for (float lon = lonStart; lon <= lonEnd; lon += lonRes) {
-                *dataArray << QVector3D(lon,
-                                         m_srtmParser->getHeight(lat, lon, SRTMParser::InterpolationType::LINEAR_INTERPOLATION),
-                                        lat);
-            }
-        }
+    for (const std::string& missingTile : terrainMosaic.getMissingTiles()) {
+        qDebug() << "QWorldParser::doHeightMapParsing(): Missing tile" << QString::fromStdString(missingTile);
+    }
 
-        HeightmapScatterPlot *heightmapScatterPlot = new HeightmapScatterPlot(dataArray);
-    } else {
-        critError(QString("Couldn't parse Heightmap data. Check if ") + fileName + QString(" exists."));
+    QScatterDataArray *dataArray = new QScatterDataArray;
+    dataArray->reserve(grid.size());
+
+    for (int row = 0; row < grid.getRows(); row++) {
+        for (int col = 0; col < grid.getCols(); col++) {
+            *dataArray << QVector3D(grid.getLongitude(col),
+                                    heights[row*grid.getCols() + col],
+                                    grid.getLatitude(row));
+        }
     }
+
+    HeightmapScatterPlot *heightmapScatterPlot = new HeightmapScatterPlot(dataArray);
 }
 
 void QWorldParser::testHeight()
@@ -224,8 +233,9 @@ void QWorldParser::createTriangulatedHeightMap()
      }
 
     // Create a grid
-    m_points.clear();
+    PointCloud cloud;
     unsigned point_id = 0;
+    unsigned rows = 0;
     for (double lat = m_srtmParser->getLatOrigin() + ::OFFSET_LAT;
                 lat <= m_srtmParser->getLatOrigin() + ::OFFSET_LAT + ::DISTANCE_LAT + ::RESOLUTION_LAT/2.0 ;
                 lat += ::RESOLUTION_LAT) {
@@ -233,20 +243,24 @@ void QWorldParser::createTriangulatedHeightMap()
                     lon <= m_srtmParser->getLonOrigin() + ::OFFSET_LON + ::DISTANCE_LON  + ::RESOLUTION_LON/2.0;
                     lon += RESOLUTION_LON) {
             ++point_id;
-            m_points.push_back({ lat , lon, point_id });
+            cloud.add(lat, lon, 0.0, point_id);
         }
+        ++rows;
     }
+    const unsigned cols = rows > 0 ? cloud.size()/rows : 0;
 
-    // Do the triangulation
-    qsrand(QDateTime::currentMSecsSinceEpoch() / 1000);
+    // Do the triangulation, the points are a regular lattice so the cells are split directly
     QElapsedTimer timer;
     timer.start();
 
-    m_delaunay.setPoints(m_points);
-    m_delaunay.triangulate();
-    std::cout << "Delaunay::triangulate(): Triangulation took " << timer.elapsed()/1000.0 << " seconds" << std::endl;
+    cloud.attachHeights(*m_srtmParser, SRTMParser::InterpolationType::NO_INTERPOLATION);
+    m_points = cloud.toPoints();
 
-    m_triangles = m_delaunay.getTriangles();
+    if (not GridMesh<double>::build(m_points, rows, cols, m_mesh, GridMesh<double>::HEIGHT_DIAGONAL, cloud.getZs())) {
+        std::cerr << "Error triangulating heightdata" << std::endl;
+        return;
+    }
+    std::cout << "GridMesh::build(): Triangulation took " << timer.elapsed()/1000.0 << " seconds" << std::endl;
 
     writeTriangles();
 
@@ -290,9 +304,10 @@ void QWorldParser::writeObj()
                   << " "  << ::OUT_SCALE*m_srtmParser->getHeight(point.getX(), point.getY())/1000.0f << endl;
     }
 
-    // triangles
-    for (auto& triangle : m_triangles) {
-        objStream << "f " << triangle.getA().getId() << " " << triangle.getB().getId() << " " << triangle.getC().getId() << endl;
+    // triangles, obj vertex numbers start at 1
+    const uint32_t* indices = m_mesh.getIndices().data();
+    for (std::size_t t = 0; t < m_mesh.getTriangleCount(); t++, indices += 3) {
+        objStream << "f " << indices[0] + 1 << " " << indices[1] + 1 << " " << indices[2] + 1 << endl;
     }
 
     objFile.close();
@@ -350,21 +365,24 @@ void QWorldParser::writeTrianglesPlot()
     triangleFile.open(QIODevice::WriteOnly);
     QTextStream triangleStream(&triangleFile);
 
+    auto writeVertex = [&](const uint32_t t, const unsigned corner) {
+        const Point<double>& point = m_mesh.getCorner(t, corner);
+        triangleStream << point.getX() << " " << point.getY() << " " << m_srtmParser->getHeight(point.getX(), point.getY()) << " " << t + 1 << endl;
+    };
+
     // vertices
-    std::cout << "Number of final triangles = " << m_triangles.size() << std::endl;
-    triangleStream << "# Number of final triangles = " << m_triangles.size() << endl;
-    int t = 0;
-    for (auto& triangle : m_triangles) {
-        t++;
-
-        triangleStream << triangle.getEdge1().getP1().getX() << " " << triangle.getEdge1().getP1().getY() << " " << m_srtmParser->getHeight(triangle.getEdge1().getP1().getX(), triangle.getEdge1().getP1().getY()) << " " << t << endl;
-        triangleStream << triangle.getEdge1().getP2().getX() << " " << triangle.getEdge1().getP2().getY() << " " << m_srtmParser->getHeight(triangle.getEdge1().getP2().getX(), triangle.getEdge1().getP2().getY()) << " " << t << endl;
+    std::cout << "Number of final triangles = " << m_mesh.getTriangleCount() << std::endl;
+    triangleStream << "# Number of final triangles = " << m_mesh.getTriangleCount() << endl;
+    for (uint32_t t = 0; t < m_mesh.getTriangleCount(); t++) {
+        // edges A-C, C-B and B-A
+        writeVertex(t, 0);
+        writeVertex(t, 2);
         triangleStream << endl;
-        triangleStream << triangle.getEdge2().getP1().getX() << " " << triangle.getEdge2().getP1().getY() << " " << m_srtmParser->getHeight(triangle.getEdge2().getP1().getX(), triangle.getEdge2().getP1().getY()) << " " << t << endl;
-        triangleStream << triangle.getEdge2().getP2().getX() << " " << triangle.getEdge2().getP2().getY() << " " << m_srtmParser->getHeight(triangle.getEdge2().getP2().getX(), triangle.getEdge2().getP2().getY()) << " " << t << endl;
+        writeVertex(t, 2);
+        writeVertex(t, 1);
         triangleStream << endl;
-        triangleStream << triangle.getEdge3().getP1().getX() << " " << triangle.getEdge3().getP1().getY() << " " << m_srtmParser->getHeight(triangle.getEdge3().getP1().getX(), triangle.getEdge3().getP1().getY()) << " " << t << endl;
-        triangleStream << triangle.getEdge3().getP2().getX() << " " << triangle.getEdge3().getP2().getY() << " " << m_srtmParser->getHeight(triangle.getEdge3().getP2().getX(), triangle.getEdge3().getP2().getY()) << " " << t << endl;
+        writeVertex(t, 1);
+        writeVertex(t, 0);
         triangleStream << endl;
         triangleStream << endl;
     }
@@ -393,11 +411,12 @@ void QWorldParser::writeTriangles()
     QTextStream triangleStream(&triangleFile);
 
     // vertices
-    std::cout << "Number of final triangles = " << m_triangles.size() << std::endl;
+    std::cout << "Number of final triangles = " << m_mesh.getTriangleCount() << std::endl;
 
-    // triangles
-    for (auto& triangle : m_triangles) {
-        triangleStream << triangle.getA().getId()-1 << " " << triangle.getB().getId()-1 << " " << triangle.getC().getId()-1 << endl;
+    // triangles, as positions in m_points
+    const uint32_t* indices = m_mesh.getIndices().data();
+    for (std::size_t t = 0; t < m_mesh.getTriangleCount(); t++, indices += 3) {
+        triangleStream << indices[0] << " " << indices[1] << " " << indices[2] << endl;
     }
 
     triangleFile.close();
@@ -490,44 +509,83 @@ void QWorldParser::exportHeightMapCarthesian()
     double latZero = ui->latZero->text().toDouble();
     double lonZero = ui->lonZero->text().toDouble();
 
-    // Create a grid and write the data to files
+    double distanceLat = PointCloud::getMetresPerDegreeLat(latZero, lonZero); // m per degree
+    double distanceLon = PointCloud::getMetresPerDegreeLon(latZero, lonZero); // m per degree
+
+    std::cout << "distanceLat = " << distanceLat << std::endl;
+    std::cout << "distanceLon = " << distanceLon << std::endl;
+
+    // segments may run into the neighbouring tiles, load those in the background while the first ones are written
+    TerrainMosaic terrainMosaic(fileInfo.path().toStdString());
+    terrainMosaic.prefetch(m_srtmParser->getLatOrigin(), m_srtmParser->getLatOrigin() + ::HEIGHTMAP_SEGMENTS_LAT*::HEIGHTMAP_DISTANCE_LAT_M/distanceLat,
+                           m_srtmParser->getLonOrigin(), m_srtmParser->getLonOrigin() + ::HEIGHTMAP_SEGMENTS_LON*::HEIGHTMAP_DISTANCE_LON_M/distanceLon);
+
+    // Create a grid per segment and write the data to files, the segments are independent and run concurrently
+    TriangulationExecutor<double> executor;
     for (int i=0; i<::HEIGHTMAP_SEGMENTS_LAT; i++) {
         for (int j=0; j<HEIGHTMAP_SEGMENTS_LON; j++) {
-            std::vector<Point<double>> points; // m
-
-            unsigned point_id = 0;
-            for (double lat_m = i*::HEIGHTMAP_DISTANCE_LAT_M;
-                        lat_m <= (i+1)*::HEIGHTMAP_DISTANCE_LAT_M ;
-                        lat_m += ::HEIGHTMAP_RESOLUTION_LAT_M) {
-                for (double lon_m = j*::HEIGHTMAP_DISTANCE_LON_M;
-                            lon_m <= (j+1)*::HEIGHTMAP_DISTANCE_LON_M;
-                            lon_m += ::HEIGHTMAP_RESOLUTION_LON_M) {
-                    ++point_id;
-                    points.push_back({ lat_m , lon_m, point_id });
+            RegularGrid segment = RegularGrid::fromRange(i*::HEIGHTMAP_DISTANCE_LAT_M, (i+1)*::HEIGHTMAP_DISTANCE_LAT_M, ::HEIGHTMAP_RESOLUTION_LAT_M,
+                                                         j*::HEIGHTMAP_DISTANCE_LON_M, (j+1)*::HEIGHTMAP_DISTANCE_LON_M, ::HEIGHTMAP_RESOLUTION_LON_M); // m
+
+            // the same segment in degrees
+            RegularGrid grid(segment.getLatOrigin()/distanceLat + m_srtmParser->getLatOrigin(),
+                             segment.getLonOrigin()/distanceLon + m_srtmParser->getLonOrigin(),
+                             segment.getLatSpacing()/distanceLat,
+                             segment.getLonSpacing()/distanceLon,
+                             segment.getRows(), segment.getCols());
+
+            executor.addGrid(segment.getRows(), segment.getCols(),
+                             [segment, grid, &terrainMosaic](std::vector<Point<double>>& points, std::vector<double>& heights) {
+                points.reserve(segment.size()); // m
+
+                unsigned point_id = 0;
+                for (int row = 0; row < segment.getRows(); row++) {
+                    for (int col = 0; col < segment.getCols(); col++) {
+                        ++point_id;
+                        points.push_back({ segment.getLatitude(row), segment.getLongitude(col), point_id });
+                    }
                 }
-            }
 
-            std::cout << "Generated segment " << i << "x" << j << " (Npoints = " << points.size() << ")" << std::endl;
+                // one thread per segment, the segments run in parallel
+                heights = terrainMosaic.resample(grid, SRTMParser::InterpolationType::LINEAR_INTERPOLATION, 1);
+            }, GridMesh<double>::HEIGHT_DIAGONAL);
+        }
+    }
 
-            writePointsHeightMapCarthesian(points, i, j, outputFolder, latZero, lonZero);
+    // the writer runs on several workers at once, their messages go out one at a time
+    std::mutex logMutex;
+    std::vector<char> written(executor.getJobCount(), 0);
+    const std::size_t failed = executor.run([&](const std::size_t job, const Mesh<double>& mesh, const std::vector<double>& heights) {
+        const int x = job/::HEIGHTMAP_SEGMENTS_LON;
+        const int y = job % ::HEIGHTMAP_SEGMENTS_LON;
+
+        // m -> output units in one pass over the coordinates
+        PointCloud cloud(mesh.getVertices(), heights);
+        cloud.transform(AffineTransform::scaling(::HEIGHTMAP_OUT_SCALE_M_CM_UE));
+        writePointsHeightMapCarthesian(cloud, x, y, outputFolder);
+        writeTrianglesHeightMapCarthesian(mesh, x, y, outputFolder);
+        written[job] = 1;
+
+        std::lock_guard<std::mutex> lock(logMutex);
+        std::cout << "Written segment " << x << "x" << y << " (Npoints = " << mesh.getVertexCount()
+                  << ", Ntriangles = " << mesh.getTriangleCount() << ")" << std::endl;
+    });
+
+    if (failed > 0) {
+        std::cerr << "Error generating " << failed << " segments:";
+        for (std::size_t job = 0; job < written.size(); job++) {
+            if (not written[job]) {
+                std::cerr << " " << job/::HEIGHTMAP_SEGMENTS_LON << "x" << job % ::HEIGHTMAP_SEGMENTS_LON;
+            }
         }
+        std::cerr << std::endl;
     }
 }
 
-void QWorldParser::writePointsHeightMapCarthesian(const std::vector<Point<double>>& points, const int x, const int y, const QString& outputFolder, const double latZero, const double lonZero)
+void QWorldParser::writePointsHeightMapCarthesian(const VertexBuffer<double>& vertices, const int x, const int y, const QString& outputFolder)
 {
     QString fileName = outputFolder + QString("/heightmap_") + QString::number(x) + QString("_") + QString::number(y) + QString(".dat");
 
-    double distanceLat1Lat2Lon1 = SRTMParser::calcDistance(latZero, latZero+1, lonZero, lonZero); // m
-    double distanceLat1Lat2Lon2 = SRTMParser::calcDistance(latZero, latZero+1, lonZero+1, lonZero+1); // m
-    double distanceLon1Lon2Lat1 = SRTMParser::calcDistance(latZero, latZero, lonZero, lonZero+1); // m
-    double distanceLon1Lon2Lat2 = SRTMParser::calcDistance(latZero+1, latZero+1, lonZero, lonZero+1); // m
-
-    std::cout << "distanceLat1Lat2Lon1 = " << distanceLat1Lat2Lon1 << std::endl;
-    std::cout << "distanceLat1Lat2Lon2 = " << distanceLat1Lat2Lon2 << std::endl;
-    std::cout << "distanceLon1Lon2Lat1 = " << distanceLon1Lon2Lat1 << std::endl;
-    std::cout << "distanceLon1Lon2Lat2 = " << distanceLon1Lon2Lat2 << std::endl;
-
 //    QFile pointsFile(fileName);
 
 //    pointsFile.open(QIODevice::WriteOnly);
@@ -560,28 +618,42 @@ void QWorldParser::writePointsHeightMapCarthesian(const std::vector<Point<double
 
     gnuplotPointsStream.setRealNumberPrecision(10);
 
-    double old_x_coord = points.front().getX();
-    for (auto& point : points) {
-        double lat_coord = point.getX()/distanceLat1Lat2Lon1 + m_srtmParser->getLatOrigin();
-        double lon_coord = point.getY()/( 0.5*(distanceLon1Lon2Lat1 + distanceLon1Lon2Lat2)) + m_srtmParser->getLonOrigin();
-
-//        double lat_coord = point.getX()/SRTMParser::calcDistance(latZero, point.getX(), lonZero, lonZero) + latZero;
-//        double lon_coord = point.getY()/( 0.5*(SRTMParser::calcDistance(latZero, latZero, lonZero, point.getY()) + SRTMParser::calcDistance(point.getX(), point.getX(), lonZero, point.getY()))) + m_srtmParser->getLonOrigin();
-
+    double old_x_coord = vertices.getX(0);
+    for (size_t i = 0; i < vertices.size(); i++) {
         gnuplotPointsStream
-                << ::HEIGHTMAP_OUT_SCALE_M_CM_UE*point.getX()
-        << " "  << ::HEIGHTMAP_OUT_SCALE_M_CM_UE*point.getY()
-        << " "  << ::HEIGHTMAP_OUT_SCALE_M_CM_UE*m_srtmParser->getHeight(lat_coord, lon_coord, SRTMParser::InterpolationType::LINEAR_INTERPOLATION) << endl;
+                << vertices.getX(i)
+        << " "  << vertices.getY(i)
+        << " "  << vertices.getZ(i) << endl;
 
-        if (old_x_coord != point.getX()) {
+        if (old_x_coord != vertices.getX(i)) {
             gnuplotPointsStream << endl;
-            old_x_coord = point.getX();
+            old_x_coord = vertices.getX(i);
         }
     }
 
     gnuplotPointsFile.close();
+}
 
-    std::cout << "Files written" << std::endl;
+void QWorldParser::writeTrianglesHeightMapCarthesian(const Mesh<double>& mesh, const int x, const int y, const QString& outputFolder)
+{
+    QString fileName = outputFolder + QString("/heightmap_triangles_") + QString::number(x) + QString("_") + QString::number(y) + QString(".dat");
+
+    QFile triangleFile(fileName);
+
+    triangleFile.open(QIODevice::WriteOnly);
+    if (!triangleFile.isOpen()) {
+        std::cerr << "Error opening file: " << fileName.toStdString() << std::endl;
+        return;
+    }
+    QTextStream triangleStream(&triangleFile);
+
+    // triangles, as positions of the points in heightmap_plot_x_y.dat, empty lines not counted
+    const uint32_t* indices = mesh.getIndices().data();
+    for (std::size_t t = 0; t < mesh.getTriangleCount(); t++, indices += 3) {
+        triangleStream << indices[0] << " " << indices[1] << " " << indices[2] << endl;
+    }
+
+    triangleFile.close();
 }
 
 void QWorldParser::on_pushButtonExportHeightMap_clicked()
@@ -689,26 +761,29 @@ void QWorldParser::exportHeightMap()
     double HEIGHTMAP_DISTANCE_LAT_S = 0.1; // °
     double HEIGHTMAP_DISTANCE_LON_S = 0.1; // °
 
-    std::vector<Point<double>> points; // °
+    RegularGrid grid = RegularGrid::fromRange(LAT_S_START, LAT_S_START + HEIGHTMAP_DISTANCE_LAT_S, HEIGHTMAP_RESOLUTION_LAT_S,
+                                              LON_S_START, LON_S_START + HEIGHTMAP_DISTANCE_LON_S, HEIGHTMAP_RESOLUTION_LON_S);
+
+    VertexBuffer<double> vertices; // °, z in m
+    vertices.reserve(grid.size());
 
     unsigned point_id = 0;
-    for (double lat_s = LAT_S_START;
-                lat_s <= LAT_S_START + HEIGHTMAP_DISTANCE_LAT_S;
-                lat_s += HEIGHTMAP_RESOLUTION_LAT_S) {
-        for (double lon_s = LON_S_START;
-                    lon_s <= LON_S_START + HEIGHTMAP_DISTANCE_LON_S;
-                    lon_s += HEIGHTMAP_RESOLUTION_LON_S) {
+    for (int row = 0; row < grid.getRows(); row++) {
+        for (int col = 0; col < grid.getCols(); col++) {
             ++point_id;
-            points.push_back({ lat_s , lon_s, point_id });
+            vertices.add(grid.getLatitude(row), grid.getLongitude(col), 0.0, point_id);
         }
     }
 
-    std::cout << "Generated segment (Npoints = " << points.size() << ")" << std::endl;
+    // the heights in grid order are the z coordinates
+    vertices.getZs() = GridResampler(*m_srtmParser).resample(grid);
+
+    std::cout << "Generated segment (Npoints = " << vertices.size() << ")" << std::endl;
 
-    writePointsHeightMap(points, 0, 0, outputFolder);
+    writePointsHeightMap(vertices, 0, 0, outputFolder);
 }
 
-void QWorldParser::writePointsHeightMap(const std::vector<Point<double>>& points, const int x, const int y, const QString& outputFolder)
+void QWorldParser::writePointsHeightMap(const VertexBuffer<double>& vertices, const int x, const int y, const QString& outputFolder)
 {
     QString fileName = outputFolder + QString("/heightmap_") + QString::number(x) + QString("_") + QString::number(y) + QString(".dat");
 
@@ -726,14 +801,14 @@ void QWorldParser::writePointsHeightMap(const std::vector<Point<double>>& points
     QTextStream pointsStream(&pointsFile);
     pointsStream.setRealNumberPrecision(10);
 
-    for (auto& point : points) {
-        double carthesianX = EARTH_RADIUS*cos(point.getX()*M_PI/180.0)*cos(point.getY()*M_PI/180.0);
-        double carthesianY = EARTH_RADIUS*cos(point.getX()*M_PI/180.0)*sin(point.getY()*M_PI/180.0);
-        double carthesianZ = EARTH_RADIUS*sin(point.getX()*M_PI/180.0);
+    for (size_t i = 0; i < vertices.size(); i++) {
+        double carthesianX = EARTH_RADIUS*cos(vertices.getX(i)*M_PI/180.0)*cos(vertices.getY(i)*M_PI/180.0);
+        double carthesianY = EARTH_RADIUS*cos(vertices.getX(i)*M_PI/180.0)*sin(vertices.getY(i)*M_PI/180.0);
+        double carthesianZ = EARTH_RADIUS*sin(vertices.getX(i)*M_PI/180.0);
         pointsStream
                 << ::HEIGHTMAP_OUT_SCALE_M_CM_UE*carthesianX - 419695887.4
         << " "  << ::HEIGHTMAP_OUT_SCALE_M_CM_UE*carthesianY - 112457174.1
-        << " "  << ::HEIGHTMAP_OUT_SCALE_M_CM_UE*(carthesianZ + m_srtmParser->getHeight(point.getX(), point.getY(), SRTMParser::InterpolationType::LINEAR_INTERPOLATION)) - 466036243.3 << endl;
+        << " "  << ::HEIGHTMAP_OUT_SCALE_M_CM_UE*(carthesianZ + vertices.getZ(i)) - 466036243.3 << endl;
     }
 
     pointsFile.close();
@@ -747,20 +822,20 @@ void QWorldParser::writePointsHeightMap(const std::vector<Point<double>>& points
 
     gnuplotPointsStream.setRealNumberPrecision(10);
 
-    double old_x_coord = points.front().getX();
-    for (auto& point : points) {
-        double carthesianX = EARTH_RADIUS*cos(point.getX()*M_PI/180.0)*cos(point.getY()*M_PI/180.0);
-        double carthesianY = EARTH_RADIUS*cos(point.getX()*M_PI/180.0)*sin(point.getY()*M_PI/180.0);
-        double carthesianZ = EARTH_RADIUS*sin(point.getX()*M_PI/180.0);
+    double old_x_coord = vertices.getX(0);
+    for (size_t i = 0; i < vertices.size(); i++) {
+        double carthesianX = EARTH_RADIUS*cos(vertices.getX(i)*M_PI/180.0)*cos(vertices.getY(i)*M_PI/180.0);
+        double carthesianY = EARTH_RADIUS*cos(vertices.getX(i)*M_PI/180.0)*sin(vertices.getY(i)*M_PI/180.0);
+        double carthesianZ = EARTH_RADIUS*sin(vertices.getX(i)*M_PI/180.0);
 
         gnuplotPointsStream
                 << ::HEIGHTMAP_OUT_SCALE_M_CM_UE*carthesianX - 450068737.3
         << " "  << ::HEIGHTMAP_OUT_SCALE_M_CM_UE*carthesianY - 419695887.4
-        << " "  << ::HEIGHTMAP_OUT_SCALE_M_CM_UE*(carthesianZ + m_srtmParser->getHeight(point.getX(), point.getY(), SRTMParser::InterpolationType::LINEAR_INTERPOLATION)) - 615482143.9 << endl;
+        << " "  << ::HEIGHTMAP_OUT_SCALE_M_CM_UE*(carthesianZ + vertices.getZ(i)) - 615482143.9 << endl;
 
-        if (old_x_coord != point.getX()) {
+        if (old_x_coord != vertices.getX(i)) {
             gnuplotPointsStream << endl;
-            old_x_coord = point.getX();
+            old_x_coord = vertices.getX(i);
         }
     }
 
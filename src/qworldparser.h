@@ -23,9 +23,10 @@
 
 #include <QMainWindow>
 
-#include "delaunay.hpp"
+#include "mesh.hpp"
 #include "point.hpp"
 #include "srtmparser.h"
+#include "vertexbuffer.hpp"
 
 namespace Ui {
 class QWorldParser;
@@ -62,20 +63,20 @@ private:
     Ui::QWorldParser *ui;
 
     SRTMParser* m_srtmParser;
-    Delaunay<double> m_delaunay;
+    Mesh<double> m_mesh;
 
     std::vector<Point<double>> m_points;
 
-    std::vector<Triangle<Point<double>, double> > m_triangles;
-
     void testHeight();
     void writePoints();
     void writeTriangles();
     void writeTrianglesPlot();
     void writeObj();
-    void writePointsHeightMapCarthesian(const std::vector<Point<double> >& points, const int x, const int y, const QString &outputFolder, const double latZero, const double lonZero);
+    // vertices already scaled to the output units
+    void writePointsHeightMapCarthesian(const VertexBuffer<double>& vertices, const int x, const int y, const QString &outputFolder);
+    void writeTrianglesHeightMapCarthesian(const Mesh<double>& mesh, const int x, const int y, const QString &outputFolder);
     void critError(const QString &errorString) const;
     void setHeightMapFolder();
     void exportHeightMap();
-    void writePointsHeightMap(const std::vector<Point<double> > &points, const int x, const int y, const QString &outputFolder);
+    void writePointsHeightMap(const VertexBuffer<double>& vertices, const int x, const int y, const QString &outputFolder);
 };
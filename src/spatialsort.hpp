@@ -0,0 +1,139 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 Hans-Peter Schadler <hps@abyle.org>
+**
+** This program is free software: you can redistribute it and/or modify it
+** under the terms of the GNU General Public License as published by the Free
+** Software Foundation, either version 3 of the License, or (at your option)
+** any later version.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT
+** ANY WARRANTY; without even the implied warranty of  MERCHANTABILITY or
+** FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+** more details.
+**
+** You should have received a copy of the GNU General Public License along with
+** this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+****************************************************************************/
+
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "point.hpp"
+
+// Insertion orders for incremental triangulation. Consecutive points of a
+// Hilbert curve order are close to each other, so locating the next point
+// takes a few steps from the last one. The biased randomized insertion order
+// (BRIO) inserts the points in rounds of doubling size, each round a random
+// sample sorted along the curve, which keeps the expected cost of randomized
+// insertion while preserving the locality.
+class SpatialSort
+{
+public:
+    // Smaller inputs are not worth reordering and keep their order
+    static const std::size_t MIN_SORT_SIZE = 64;
+
+    // Position of (x, y) along a Hilbert curve through a 65536 x 65536 grid
+    static uint32_t hilbertIndex(uint32_t x, uint32_t y)
+    {
+        uint32_t index = 0;
+        for (uint32_t s = 1u << 15; s > 0; s >>= 1) {
+            const uint32_t rx = (x & s) ? 1 : 0;
+            const uint32_t ry = (y & s) ? 1 : 0;
+            index += s*s*((3*rx) ^ ry);
+
+            // rotate the quadrant so that the lower bits continue the curve
+            if (ry == 0) {
+                if (rx == 1) {
+                    x = 0xFFFF - x;
+                    y = 0xFFFF - y;
+                }
+                std::swap(x, y);
+            }
+        }
+        return index;
+    }
+
+    // Sorts the point indices in [begin, end) along a Hilbert curve over their bounding box
+    template <class F>
+    static void hilbertSort(const std::vector<Point<F>>& points, std::vector<unsigned>::iterator begin, std::vector<unsigned>::iterator end)
+    {
+        if (end - begin < 2) {
+            return;
+        }
+
+        double minX = points[*begin].getX();
+        double minY = points[*begin].getY();
+        double maxX = minX;
+        double maxY = minY;
+        for (auto it = begin; it != end; ++it) {
+            minX = std::min(minX, double(points[*it].getX()));
+            minY = std::min(minY, double(points[*it].getY()));
+            maxX = std::max(maxX, double(points[*it].getX()));
+            maxY = std::max(maxY, double(points[*it].getY()));
+        }
+
+        // same scale on both axes so that the curve follows the geometry
+        const double extent = std::max(maxX - minX, maxY - minY);
+        const double scale = (extent > 0) ? 65535.0/extent : 0.0;
+
+        std::vector<std::pair<uint32_t, unsigned>> keys;
+        keys.reserve(end - begin);
+        for (auto it = begin; it != end; ++it) {
+            const uint32_t x = uint32_t((points[*it].getX() - minX)*scale);
+            const uint32_t y = uint32_t((points[*it].getY() - minY)*scale);
+            keys.push_back(std::make_pair(hilbertIndex(x, y), *it));
+        }
+        std::sort(keys.begin(), keys.end());
+
+        for (std::size_t i = 0; i < keys.size(); i++) {
+            begin[i] = keys[i].second;
+        }
+    }
+
+    // Biased randomized insertion order of all points, deterministic for a given seed
+    template <class F>
+    static std::vector<unsigned> brio(const std::vector<Point<F>>& points, const unsigned seed = 0)
+    {
+        std::vector<unsigned> order;
+        brio(points, order, seed);
+        return order;
+    }
+
+    // The same order written into order, which keeps its memory if it is large enough
+    template <class F>
+    static void brio(const std::vector<Point<F>>& points, std::vector<unsigned>& order, const unsigned seed = 0)
+    {
+        order.resize(points.size());
+        for (std::size_t i = 0; i < order.size(); i++) {
+            order[i] = i;
+        }
+
+        if (order.size() < MIN_SORT_SIZE) {
+            return;
+        }
+
+        std::mt19937 random(seed);
+        std::shuffle(order.begin(), order.end(), random);
+
+        // rounds [0, n/2^k), ..., [n/4, n/2), [n/2, n), the first one at least MIN_SORT_SIZE points
+        std::vector<std::size_t> roundStarts;
+        for (std::size_t start = order.size()/2; start >= MIN_SORT_SIZE; start /= 2) {
+            roundStarts.push_back(start);
+        }
+        roundStarts.push_back(0);
+        std::reverse(roundStarts.begin(), roundStarts.end());
+        roundStarts.push_back(order.size());
+
+        for (std::size_t round = 0; round + 1 < roundStarts.size(); round++) {
+            hilbertSort(points, order.begin() + roundStarts[round], order.begin() + roundStarts[round + 1]);
+        }
+    }
+};
@@ -19,13 +19,124 @@
 
 #include "srtmparser.h"
 
+#include <algorithm>
 #include <chrono>
 #include <cmath>
 #include <fstream>
 #include <iostream>
 #include <stdexcept>
 
-SRTMParser::SRTMParser(const std::string hgtFileName)
+#include "cpufeatures.h"
+
+#ifdef QWORLDPARSER_X86_SIMD
+    #include <immintrin.h>
+#endif
+
+namespace {
+    // Layout of the samples the batch kernels read from
+    struct SampleGrid {
+        const unsigned char* base;
+        int rowStride;    // bytes between two rows
+        bool bigEndian;   // raw HGT samples when the file is memory mapped
+        int lat;
+        int lon;
+    };
+
+#ifdef QWORLDPARSER_X86_SIMD
+    // Evaluates SRTMParser::BilinearInterpolation() for four points at a time with
+    // exactly the same operations as the scalar version, so results are identical.
+    // Points on or outside the tile border are left to the scalar code.
+    template <int SAMPLES>
+    __attribute__((target("avx2")))
+    void bilinearInterpolationAvx2(const SampleGrid& grid, const double* latitudes, const double* longitudes, double* heights,
+                                   const std::size_t count, std::vector<std::size_t>& scalarIndices)
+    {
+        const __m256d latOrigin = _mm256_set1_pd(grid.lat);
+        const __m256d lonOrigin = _mm256_set1_pd(grid.lon);
+        const __m256d scale = _mm256_set1_pd(SAMPLES - 1);
+        const __m256d zero = _mm256_setzero_pd();
+        const __m256d one = _mm256_set1_pd(1.0);
+        const __m128i lastIndex = _mm_set1_epi32(SAMPLES - 1);
+        const __m128i rowStride = _mm_set1_epi32(grid.rowStride);
+        const __m128i swapMask = _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+        const int* base = reinterpret_cast<const int*>(grid.base);
+
+        std::size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            const __m256d x = _mm256_loadu_pd(latitudes + i);
+            const __m256d y = _mm256_loadu_pd(longitudes + i);
+            __m256d latSec = _mm256_mul_pd(_mm256_sub_pd(x, latOrigin), scale);
+            __m256d lonSec = _mm256_mul_pd(_mm256_sub_pd(y, lonOrigin), scale);
+
+            // the cell right/above of the sample must exist, otherwise the scalar code decides
+            __m256d inside = _mm256_and_pd(_mm256_and_pd(_mm256_cmp_pd(latSec, zero, _CMP_GE_OQ), _mm256_cmp_pd(latSec, scale, _CMP_LT_OQ)),
+                                           _mm256_and_pd(_mm256_cmp_pd(lonSec, zero, _CMP_GE_OQ), _mm256_cmp_pd(lonSec, scale, _CMP_LT_OQ)));
+            int insideMask = _mm256_movemask_pd(inside);
+            if (insideMask != 0xF) {
+                for (int lane = 0; lane < 4; lane++) {
+                    if (not (insideMask & (1 << lane))) {
+                        scalarIndices.push_back(i + lane);
+                    }
+                }
+                if (insideMask == 0) {
+                    continue;
+                }
+                // keep the gathers of the other lanes inside the tile
+                latSec = _mm256_and_pd(latSec, inside);
+                lonSec = _mm256_and_pd(lonSec, inside);
+            }
+
+            const __m128i latInt = _mm256_cvttpd_epi32(latSec);
+            const __m128i col = _mm256_cvttpd_epi32(lonSec);
+            const __m128i row = _mm_sub_epi32(lastIndex, latInt);
+
+            // one 32 bit load fetches the samples at col and col + 1
+            const __m128i offsetRow = _mm_add_epi32(_mm_mullo_epi32(row, rowStride), _mm_slli_epi32(col, 1));
+            const __m128i offsetRowAbove = _mm_sub_epi32(offsetRow, rowStride);
+            __m128i pairRow = _mm_i32gather_epi32(base, offsetRow, 1);
+            __m128i pairRowAbove = _mm_i32gather_epi32(base, offsetRowAbove, 1);
+            if (grid.bigEndian) {
+                pairRow = _mm_shuffle_epi8(pairRow, swapMask);
+                pairRowAbove = _mm_shuffle_epi8(pairRowAbove, swapMask);
+            }
+
+            const __m256d q11 = _mm256_cvtepi32_pd(_mm_srai_epi32(_mm_slli_epi32(pairRow, 16), 16));
+            const __m256d q12 = _mm256_cvtepi32_pd(_mm_srai_epi32(pairRow, 16));
+            const __m256d q21 = _mm256_cvtepi32_pd(_mm_srai_epi32(_mm_slli_epi32(pairRowAbove, 16), 16));
+            const __m256d q22 = _mm256_cvtepi32_pd(_mm_srai_epi32(pairRowAbove, 16));
+
+            const __m256d latIntD = _mm256_cvtepi32_pd(latInt);
+            const __m256d colD = _mm256_cvtepi32_pd(col);
+            const __m256d x1 = _mm256_add_pd(_mm256_div_pd(latIntD, scale), latOrigin);
+            const __m256d x2 = _mm256_add_pd(_mm256_div_pd(_mm256_add_pd(latIntD, one), scale), latOrigin);
+            const __m256d y1 = _mm256_add_pd(_mm256_div_pd(colD, scale), lonOrigin);
+            const __m256d y2 = _mm256_add_pd(_mm256_div_pd(_mm256_add_pd(colD, one), scale), lonOrigin);
+
+            const __m256d x2x1 = _mm256_sub_pd(x2, x1);
+            const __m256d y2y1 = _mm256_sub_pd(y2, y1);
+            const __m256d x2x = _mm256_sub_pd(x2, x);
+            const __m256d y2y = _mm256_sub_pd(y2, y);
+            const __m256d yy1 = _mm256_sub_pd(y, y1);
+            const __m256d xx1 = _mm256_sub_pd(x, x1);
+
+            __m256d sum = _mm256_mul_pd(_mm256_mul_pd(q11, x2x), y2y);
+            sum = _mm256_add_pd(sum, _mm256_mul_pd(_mm256_mul_pd(q21, xx1), y2y));
+            sum = _mm256_add_pd(sum, _mm256_mul_pd(_mm256_mul_pd(q12, x2x), yy1));
+            sum = _mm256_add_pd(sum, _mm256_mul_pd(_mm256_mul_pd(q22, xx1), yy1));
+
+            const __m256d norm = _mm256_div_pd(one, _mm256_mul_pd(x2x1, y2y1));
+            _mm256_storeu_pd(heights + i, _mm256_mul_pd(norm, sum));
+        }
+
+        for (; i < count; i++) {
+            scalarIndices.push_back(i);
+        }
+    }
+#endif
+}
+
+SRTMParser::SRTMParser(const std::string hgtFileName) :
+    m_hasStatistics(false)
 {
     m_hgtFileNameString = hgtFileName;
 
@@ -36,9 +147,9 @@ SRTMParser::SRTMParser(const std::string hgtFileName)
     }
 }
 
-int SRTMParser::endianSwap(unsigned char* c)
+int16_t SRTMParser::endianSwap(const unsigned char* c)
 {
-    return 256*(unsigned char)c[0] + (unsigned char)c[1];
+    return static_cast<int16_t>((c[0] << 8) | c[1]);
 }
 
 int SRTMParser::getFileSize(std::ifstream& file)
@@ -54,14 +165,8 @@ int SRTMParser::getFileSize(std::ifstream& file)
     return fileSize;
 }
 
-bool SRTMParser::parseData()
+bool SRTMParser::detectHgtType(const std::size_t fileSize)
 {
-    auto start = std::chrono::system_clock::now();
-    
-    m_heightData.clear();
-
-    std::ifstream file(m_hgtFileNameString, std::ios::binary);
-    auto fileSize = getFileSize(file);
     if (fileSize == 2*3601*3601) {
         std::cout << "SRTMParser::parseData(): HGT 1\" file detected" << std::endl;
         m_hgtType = HGT_1;
@@ -73,31 +178,56 @@ bool SRTMParser::parseData()
         return false;
     }
 
-    if (not file.is_open()) {
-        std::cerr << "File is not open" << std::endl;
-        return false;
+    return true;
+}
+
+int SRTMParser::getSampleCount() const
+{
+    return (m_hgtType == HGT_1) ? 3601 : 1201;
+}
+
+inline int SRTMParser::sample(const int row, const int col) const
+{
+    if (m_mappedFile) {
+        return endianSwap(m_mappedFile->data() + 2*(row*getSampleCount() + col));
     }
 
+    return m_heightData.at(row, col);
+}
+
+bool SRTMParser::parseData(const LoadMode loadMode)
+{
+    auto start = std::chrono::system_clock::now();
+    
+    m_heightData = HeightRaster();
+    m_mappedFile.reset();
+    m_statistics = HgtStatistics();
+    m_hasStatistics = false;
+
     bool ok = false;
-    switch (m_hgtType) {
-        case HGT_1: ok = parseHgt1(file);
-                    break;
-        case HGT_3: ok = parseHgt3(file);
-                    break;
-        default: break;
+    if (TileCache::isTileCache(m_hgtFileNameString)) {
+        // already decoded, mapped and used as is in both load modes
+        ok = openCache();
+    } else {
+        switch (loadMode) {
+            case LOAD_READ: ok = readHgt();
+                            break;
+            case LOAD_MMAP: ok = mapHgt();
+                            break;
+            default: break;
+        }
     }
 
-    file.close();
-    
     auto end = std::chrono::system_clock::now();
     auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
 
     std::cout << "SRTMParser::parseData(): The parsing operation took " << elapsed.count() << " milliseconds" << std::endl;
 
     if (ok) {
-        std::cout << "SRTMParser::parseData(): First elevation Value = " << m_heightData.at(1).at(1) << std::endl;
-        std::cout << "SRTMParser::parseData(): Last elevation Value = " << m_heightData.back().back() << std::endl;
-        std::cout << "SRTMParser::parseData(): Rows = " << m_heightData.size() << std::endl;
+        const int last = getSampleCount() - 1;
+        std::cout << "SRTMParser::parseData(): First elevation Value = " << sample(1, 1) << std::endl;
+        std::cout << "SRTMParser::parseData(): Last elevation Value = " << sample(last, last) << std::endl;
+        std::cout << "SRTMParser::parseData(): Rows = " << getSampleCount() << std::endl;
         return true;
     } else {
         std::cout << "SRTMParser::parseData(): Error parsing the hgt file" << std::endl;
@@ -105,65 +235,148 @@ bool SRTMParser::parseData()
     }
 }
 
-bool SRTMParser::parseHgt1(std::ifstream &file)
+bool SRTMParser::readHgt()
 {
-    std::vector<int> vecRow;
+    if (HgtInflater::detectFormat(m_hgtFileNameString) != HgtInflater::PLAIN) {
+        return inflateHgt();
+    }
 
-    unsigned char c[2];
+    std::ifstream file(m_hgtFileNameString, std::ios::binary);
+    auto fileSize = getFileSize(file);
+    if (fileSize < 0 || not detectHgtType(fileSize)) {
+        return false;
+    }
 
-    int col = 0;
-    int numRead = 0;
+    bool ok = parseHgt(file, getSampleCount());
 
-    while (file.read((char*)c, 2)) {
-        col++;
+    file.close();
 
-        vecRow.push_back(endianSwap(c));
-        if (col == 3601) {
-            m_heightData.push_back(vecRow);
-            numRead += col;
-            col = 0;
-            vecRow.clear();
-        }
+    return ok;
+}
+
+bool SRTMParser::mapHgt()
+{
+    if (HgtInflater::detectFormat(m_hgtFileNameString) != HgtInflater::PLAIN) {
+        std::cout << "SRTMParser::parseData(): Compressed tiles can't be mapped, decoding into memory" << std::endl;
+        return inflateHgt();
     }
 
-    if (numRead == 3601*3601) {
-        return true;
-    } else {
+    std::shared_ptr<MappedFile> mappedFile = std::make_shared<MappedFile>();
+    if (not mappedFile->open(m_hgtFileNameString)) {
         return false;
     }
+
+    if (not detectHgtType(mappedFile->size())) {
+        return false;
+    }
+
+    // Samples stay big-endian in the page cache and are swapped on access
+    m_mappedFile = mappedFile;
+
+    return true;
 }
 
-bool SRTMParser::parseHgt3(std::ifstream &file)
+bool SRTMParser::openCache()
 {
-    std::vector<int> vecRow;
+    TileCache tileCache;
+    if (not tileCache.open(m_hgtFileNameString) || not detectHgtType(2*std::size_t(tileCache.getSampleCount())*tileCache.getSampleCount())) {
+        return false;
+    }
 
-    unsigned char c[2];
+    m_lat = tileCache.getLatOrigin();
+    m_lon = tileCache.getLonOrigin();
+    m_heightData = tileCache.getHeightData();
+    m_statistics = tileCache.getStatistics();
+    m_hasStatistics = true;
 
-    int col = 0;
-    int numRead = 0;
+    return true;
+}
 
-    while (file.read((char*)c, 2)) {
-        col++;
+bool SRTMParser::writeCache(const std::string& fileName)
+{
+    HeightRaster heightData = getHeightData();
+    if (heightData.isEmpty()) {
+        std::cerr << "SRTMParser::writeCache(): No height data parsed" << std::endl;
+        return false;
+    }
 
-        vecRow.push_back(endianSwap(c));
-        if (col == 1201) {
-            m_heightData.push_back(vecRow);
-            numRead += col;
-            col = 0;
-            vecRow.clear();
-        }
+    return TileCache::write(fileName, heightData, m_lat, m_lon, getStatistics());
+}
+
+bool SRTMParser::inflateHgt()
+{
+    HgtInflater inflater;
+    if (not inflater.open(m_hgtFileNameString) || not detectHgtType(inflater.getUncompressedSize())) {
+        return false;
     }
 
-    if (numRead == 1201*1201) {
-        return true;
-    } else {
+    const int samples = getSampleCount();
+    HeightRaster heightData(samples, samples);
+    HgtStatistics statistics;
+    if (not inflater.inflate(heightData, statistics)) {
         return false;
     }
+
+    m_heightData = heightData;
+    m_statistics = statistics;
+    m_hasStatistics = true;
+
+    return true;
 }
 
-std::vector<std::vector<int>> SRTMParser::getHeightData()
+bool SRTMParser::parseHgt(std::ifstream &file, const int samples)
 {
-    return m_heightData;
+    HeightRaster heightData(samples, samples);
+    HgtStatistics statistics;
+    std::vector<unsigned char> rowBuffer(2*samples);
+
+    for (int row = 0; row < samples; row++) {
+        if (not file.read(reinterpret_cast<char*>(rowBuffer.data()), rowBuffer.size())) {
+            return false;
+        }
+
+        HgtDecoder::decode(rowBuffer.data(), heightData.writableRowData(row), samples, statistics);
+    }
+
+    m_heightData = heightData;
+    m_statistics = statistics;
+    m_hasStatistics = true;
+
+    return true;
+}
+
+HeightRaster SRTMParser::getHeightData() const
+{
+    if (not m_mappedFile) {
+        return m_heightData;
+    }
+
+    const int samples = getSampleCount();
+    HeightRaster heightData(samples, samples);
+    for (int row = 0; row < samples; row++) {
+        HgtDecoder::decode(m_mappedFile->data() + 2*row*samples, heightData.writableRowData(row), samples);
+    }
+
+    return heightData;
+}
+
+HgtStatistics SRTMParser::getStatistics()
+{
+    if (m_hasStatistics || not m_mappedFile) {
+        return m_statistics;
+    }
+
+    const int samples = getSampleCount();
+    std::vector<int16_t> rowData(samples);
+    HgtStatistics statistics;
+    for (int row = 0; row < samples; row++) {
+        HgtDecoder::decode(m_mappedFile->data() + 2*row*samples, rowData.data(), samples, statistics);
+    }
+
+    m_statistics = statistics;
+    m_hasStatistics = true;
+
+    return m_statistics;
 }
 
 inline double
@@ -184,18 +397,31 @@ SRTMParser::BilinearInterpolation(double q11, double q12, double q21, double q22
     );
 }
 
-double SRTMParser::getHgt1HeightBilinearInterpolation(const double latitude, const double longitude)
+template <int SAMPLES>
+inline int SRTMParser::sample(const int row, const int col) const
+{
+    if (m_mappedFile) {
+        return endianSwap(m_mappedFile->data() + 2*(row*SAMPLES + col));
+    }
+
+    return m_heightData.at(row, col);
+}
+
+template <int SAMPLES>
+double SRTMParser::getHeightBilinearInterpolation(const double latitude, const double longitude)
 {
+    const int LAST = SAMPLES - 1; // samples per degree
+
     // First get the values in the columns
-    double latSecShifted = (latitude - m_lat)*3600;
-    double lonSecShifted = (longitude - m_lon)*3600;
+    double latSecShifted = (latitude - m_lat)*LAST;
+    double lonSecShifted = (longitude - m_lon)*LAST;
 
     if (latSecShifted < 0 || lonSecShifted < 0) {
         return -10000.0f; // invalid request
     }
     int latInt = latSecShifted;
     int longInt = lonSecShifted;
-    int row = (3601 - 1) - latInt;
+    int row = LAST - latInt;
     int col = longInt;
 
     int row_q11 = row;
@@ -210,99 +436,113 @@ double SRTMParser::getHgt1HeightBilinearInterpolation(const double latitude, con
     int row_q22 = row - 1; // must go in negative direction because in original heightmap data set the lat coordinate goes in negative direction for +delta_lat
     int col_q22 = col + 1;
 
-    if (row_q11 < 0 || row_q11 > 3600 || col_q11 < 0 || col_q11 > 3600) {
+    if (row_q11 < 0 || row_q11 > LAST || col_q11 < 0 || col_q11 > LAST) {
         return -10000.0f; // invalid request
     }
 
-    if (row_q12 < 0 || row_q12 > 3600 || col_q12 < 0 || col_q12 > 3600) {
-        return m_heightData[row][col]; // no extrapolation
+    if (row_q12 < 0 || row_q12 > LAST || col_q12 < 0 || col_q12 > LAST) {
+        return sample<SAMPLES>(row, col); // no extrapolation
     }
 
-    if (row_q21 < 0 || row_q21 > 3600 || col_q21 < 0 || col_q21 > 3600) {
-        return m_heightData[row][col]; // no extrapolation
+    if (row_q21 < 0 || row_q21 > LAST || col_q21 < 0 || col_q21 > LAST) {
+        return sample<SAMPLES>(row, col); // no extrapolation
     }
 
-    if (row_q22 < 0 || row_q22 > 3600 || col_q22 < 0 || col_q22 > 3600) {
-        return m_heightData[row][col]; // no extrapolation
+    if (row_q22 < 0 || row_q22 > LAST || col_q22 < 0 || col_q22 > LAST) {
+        return sample<SAMPLES>(row, col); // no extrapolation
     }
 
-    double q11 = m_heightData[row_q11][col_q11];
-    double q12 = m_heightData[row_q12][col_q12];
-    double q21 = m_heightData[row_q21][col_q21];
-    double q22 = m_heightData[row_q22][col_q22];
+    double q11 = sample<SAMPLES>(row_q11, col_q11);
+    double q12 = sample<SAMPLES>(row_q12, col_q12);
+    double q21 = sample<SAMPLES>(row_q21, col_q21);
+    double q22 = sample<SAMPLES>(row_q22, col_q22);
 
-    double x1 = ((3601 - 1) - row_q11)/3600.0 + m_lat;
-    double y1 = col_q11/3600.0 + m_lon;
+    double x1 = (LAST - row_q11)/double(LAST) + m_lat;
+    double y1 = col_q11/double(LAST) + m_lon;
 
-    double x2 = ((3601 - 1) - row_q21)/3600.0 + m_lat;
-    double y2 = col_q12/3600.0 + m_lon;
+    double x2 = (LAST - row_q21)/double(LAST) + m_lat;
+    double y2 = col_q12/double(LAST) + m_lon;
 
     return BilinearInterpolation(q11, q12, q21, q22, x1, x2, y1, y2, latitude, longitude);
 }
 
-double SRTMParser::getHgt1HeightNoInterpol(const double latitude, const double longitude)
+template <int SAMPLES>
+void SRTMParser::getHeightsBilinearInterpolation(const double* latitudes, const double* longitudes, double* heights, const std::size_t count)
 {
-    // find entry in vector
-    double latSecShifted = (latitude - m_lat)*3600;
-    double lonSecShifted = (longitude - m_lon)*3600;
+#ifdef QWORLDPARSER_X86_SIMD
+    if (CpuFeatures::hasAvx2()) {
+        SampleGrid grid;
+        if (m_mappedFile) {
+            grid.base = m_mappedFile->data();
+            grid.rowStride = 2*SAMPLES;
+            grid.bigEndian = true;
+        } else {
+            grid.base = reinterpret_cast<const unsigned char*>(m_heightData.data());
+            grid.rowStride = 2*m_heightData.stride();
+            grid.bigEndian = false;
+        }
+        grid.lat = m_lat;
+        grid.lon = m_lon;
 
-    if (latSecShifted < 0 || lonSecShifted < 0) {
-        return -10000.0f; // invalid request
-    }
-    int latInt = latSecShifted;
-    int longInt = lonSecShifted;
-    int row = (3601 - 1) - latInt;
-    int col = longInt;
-    if (row < 0 || row > 3600 || col < 0 || col > 3600) {
-        return -10000.0f; // invalid request
+        std::vector<std::size_t> scalarIndices;
+        bilinearInterpolationAvx2<SAMPLES>(grid, latitudes, longitudes, heights, count, scalarIndices);
+
+        for (auto i : scalarIndices) {
+            heights[i] = getHeightBilinearInterpolation<SAMPLES>(latitudes[i], longitudes[i]);
+        }
+        return;
     }
+#endif
 
-    return m_heightData[row][col];
+    for (std::size_t i = 0; i < count; i++) {
+        heights[i] = getHeightBilinearInterpolation<SAMPLES>(latitudes[i], longitudes[i]);
+    }
 }
 
-double SRTMParser::getHgt3HeightNoInterpol(const double latitude, const double longitude)
+template <int SAMPLES>
+double SRTMParser::getHeightNoInterpol(const double latitude, const double longitude)
 {
+    const int LAST = SAMPLES - 1; // samples per degree
+
     // find entry in vector
-    double latSecShifted = (latitude - m_lat)*1200;
-    double lonSecShifted = (longitude - m_lon)*1200;
+    double latSecShifted = (latitude - m_lat)*LAST;
+    double lonSecShifted = (longitude - m_lon)*LAST;
 
     if (latSecShifted < 0 || lonSecShifted < 0) {
         return -10000.0f; // invalid request
     }
     int latInt = latSecShifted;
     int longInt = lonSecShifted;
-    int row = (1201 - 1) - latInt;
+    int row = LAST - latInt;
     int col = longInt;
-    if (row < 0 || row > 1200 || col < 0 || col > 1200) {
+    if (row < 0 || row > LAST || col < 0 || col > LAST) {
         return -10000.0f; // invalid request
     }
 
-    return m_heightData[row][col];
+    return sample<SAMPLES>(row, col);
 }
 
 double SRTMParser::getHeight(const double latitude, const double longitude, const SRTMParser::InterpolationType interpolationType)
 {
-    // TODO find height data based on lat/lon
     // m_lat,m_lon = m_heightData[lastrow][firstcol]
-    // the algo depends on HGT_TYPE
-    // HGT_1: +1 entry is + 1 minute
-    // HGT_3: +1 entry is + 3 minutes
+    // HGT_1: +1 entry is + 1 second
+    // HGT_3: +1 entry is + 3 seconds
     double height = 0;
 
     switch (interpolationType) {
         case InterpolationType::NO_INTERPOLATION:
             if (m_hgtType == HgtType::HGT_1) {
-                height = getHgt1HeightNoInterpol(latitude, longitude);
+                height = getHeightNoInterpol<3601>(latitude, longitude);
             } else if (m_hgtType == HgtType::HGT_3) {
-                height = getHgt3HeightNoInterpol(latitude, longitude);
+                height = getHeightNoInterpol<1201>(latitude, longitude);
             }
             break;
 
         case InterpolationType::LINEAR_INTERPOLATION:
             if (m_hgtType == HgtType::HGT_1) {
-                height = getHgt1HeightBilinearInterpolation(latitude, longitude);
+                height = getHeightBilinearInterpolation<3601>(latitude, longitude);
             } else if (m_hgtType == HgtType::HGT_3) {
-                // height = getHgt3HeightBilinearInterpolation(latitude, longitude);
+                height = getHeightBilinearInterpolation<1201>(latitude, longitude);
             }
             break;
 
@@ -312,6 +552,43 @@ double SRTMParser::getHeight(const double latitude, const double longitude, cons
     return height;
 }
 
+void SRTMParser::getHeights(const double* latitudes, const double* longitudes, double* heights, const std::size_t count,
+                            const SRTMParser::InterpolationType interpolationType)
+{
+    // Same as getHeight(), but the dispatch happens once per batch
+    switch (interpolationType) {
+        case InterpolationType::NO_INTERPOLATION:
+            if (m_hgtType == HgtType::HGT_1) {
+                for (std::size_t i = 0; i < count; i++) {
+                    heights[i] = getHeightNoInterpol<3601>(latitudes[i], longitudes[i]);
+                }
+            } else if (m_hgtType == HgtType::HGT_3) {
+                for (std::size_t i = 0; i < count; i++) {
+                    heights[i] = getHeightNoInterpol<1201>(latitudes[i], longitudes[i]);
+                }
+            }
+            break;
+
+        case InterpolationType::LINEAR_INTERPOLATION:
+            if (m_hgtType == HgtType::HGT_1) {
+                getHeightsBilinearInterpolation<3601>(latitudes, longitudes, heights, count);
+            } else if (m_hgtType == HgtType::HGT_3) {
+                getHeightsBilinearInterpolation<1201>(latitudes, longitudes, heights, count);
+            }
+            break;
+
+        default: break;
+    }
+}
+
+std::vector<double> SRTMParser::getHeights(const std::vector<double>& latitudes, const std::vector<double>& longitudes,
+                                           const SRTMParser::InterpolationType interpolationType)
+{
+    std::vector<double> heights(std::min(latitudes.size(), longitudes.size()));
+    getHeights(latitudes.data(), longitudes.data(), heights.data(), heights.size(), interpolationType);
+    return heights;
+}
+
 std::string SRTMParser::getFileBaseName(std::string const & path)
 {
   return path.substr(path.find_last_of("/\\") + 1);
@@ -326,6 +603,14 @@ bool SRTMParser::parseCoordsFromFileName()
     try {
         m_lat = std::stoi(latString);
         m_lon = std::stoi(lonString);
+
+        // Southern and western tiles are named after their (negative) south west corner
+        if (fileName[0] == 'S' || fileName[0] == 's') {
+            m_lat = -m_lat;
+        }
+        if (fileName[3] == 'W' || fileName[3] == 'w') {
+            m_lon = -m_lon;
+        }
     }
     catch(std::invalid_argument& e){
         std::cerr << e.what() << std::endl;
@@ -339,6 +624,15 @@ bool SRTMParser::parseCoordsFromFileName()
     return true;
 }
 
+std::size_t SRTMParser::getMemoryUsage() const
+{
+    if (m_mappedFile) {
+        return m_mappedFile->size();
+    }
+
+    return m_heightData.sizeInBytes();
+}
+
 int SRTMParser::getLatOrigin() const
 {
     return m_lat;
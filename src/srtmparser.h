@@ -20,9 +20,16 @@
 #pragma once
 
 #include <cmath>
+#include <memory>
 #include <string>
 #include <vector>
 
+#include "heightraster.h"
+#include "hgtdecoder.h"
+#include "hgtinflater.h"
+#include "mappedfile.h"
+#include "tilecache.h"
+
 #ifndef M_PI
     #define M_PI 3.14159265358979323846
 #endif
@@ -41,16 +48,38 @@ public:
         LINEAR_INTERPOLATION
     };
 
+    enum LoadMode {
+        LOAD_READ,  // decode the whole file into memory
+        LOAD_MMAP   // map the file and decode samples on access, compressed files are decoded into memory
+    };
+
     SRTMParser(const std::string hgtFileName);
 
-    bool parseData();
-    std::vector<std::vector<int> > getHeightData();
+    // Also reads TileCache files, which are mapped and used without decoding in either load mode
+    bool parseData(const LoadMode loadMode = LoadMode::LOAD_READ);
+    HeightRaster getHeightData() const;
+
+    // Writes the parsed tile as TileCache file
+    bool writeCache(const std::string& fileName);
+
+    // Min/max and void count of the tile. Collected while decoding in LOAD_READ
+    // mode, computed on first request in LOAD_MMAP mode.
+    HgtStatistics getStatistics();
+
+    // Bytes held by the tile, the decoded raster or the mapped file
+    std::size_t getMemoryUsage() const;
 
     int getLatOrigin() const;
     int getLonOrigin() const;
 
     double getHeight(const double latitude, const double longitude, const InterpolationType interpolationType = InterpolationType::NO_INTERPOLATION);
 
+    // Batch version of getHeight(): heights[i] = getHeight(latitudes[i], longitudes[i], interpolationType)
+    void getHeights(const double* latitudes, const double* longitudes, double* heights, const std::size_t count,
+                    const InterpolationType interpolationType = InterpolationType::NO_INTERPOLATION);
+    std::vector<double> getHeights(const std::vector<double>& latitudes, const std::vector<double>& longitudes,
+                                   const InterpolationType interpolationType = InterpolationType::NO_INTERPOLATION);
+
     static double calcDistance(const double lat1, const double lat2, const double lon1, const double lon2)
     {
         double R = 6371e3; // metres
@@ -69,22 +98,42 @@ public:
 
 private:
     bool parseCoordsFromFileName();
-    int endianSwap(unsigned char *c);
-    bool parseHgt1(std::ifstream &file);
-    bool parseHgt3(std::ifstream &file);
+    static int16_t endianSwap(const unsigned char *c);
+    bool detectHgtType(const std::size_t fileSize);
+    bool readHgt();
+    bool mapHgt();
+    bool inflateHgt();
+    bool openCache();
+    bool parseHgt(std::ifstream &file, const int samples);
+
+    int getSampleCount() const;
+    int sample(const int row, const int col) const;
 
     std::string m_hgtFileNameString;
     HgtType m_hgtType;
     int m_lat;
     int m_lon;
 
-    std::vector<std::vector<int>> m_heightData;
-    double getHgt1HeightNoInterpol(const double latitude, const double longitude);
-    double getHgt3HeightNoInterpol(const double latitude, const double longitude);
+    HeightRaster m_heightData;
+    std::shared_ptr<MappedFile> m_mappedFile;
+
+    HgtStatistics m_statistics;
+    bool m_hasStatistics;
+
+    // The lookups are instantiated for 3601 (HGT 1) and 1201 (HGT 3) samples per row
+    template <int SAMPLES>
+    int sample(const int row, const int col) const;
+
+    template <int SAMPLES>
+    double getHeightNoInterpol(const double latitude, const double longitude);
 
     double BilinearInterpolation(double q11, double q12, double q21, double q22, double x1, double x2, double y1, double y2, double x, double y);
 
-    double getHgt1HeightBilinearInterpolation(const double latitude, const double longitude);
+    template <int SAMPLES>
+    double getHeightBilinearInterpolation(const double latitude, const double longitude);
+
+    template <int SAMPLES>
+    void getHeightsBilinearInterpolation(const double* latitudes, const double* longitudes, double* heights, const std::size_t count);
     
     int getFileSize(std::ifstream &file);
     std::string getFileBaseName(const std::string &path);
@@ -0,0 +1,269 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 Hans-Peter Schadler <hps@abyle.org>
+**
+** This program is free software: you can redistribute it and/or modify it
+** under the terms of the GNU General Public License as published by the Free
+** Software Foundation, either version 3 of the License, or (at your option)
+** any later version.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT
+** ANY WARRANTY; without even the implied warranty of  MERCHANTABILITY or
+** FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+** more details.
+**
+** You should have received a copy of the GNU General Public License along with
+** this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+****************************************************************************/
+
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+#include "delaunay.hpp"
+#include "point.hpp"
+#include "spatialsort.hpp"
+#include "triangle.hpp"
+
+// Delaunay triangulation of more points than fit into memory, swept along x.
+// The points come in chunks, after each chunk finalize(x) promises that no
+// later point has a smaller x. A triangle whose circumcircle lies left of x
+// can't get a point inside anymore, it is a triangle of the final
+// triangulation: it is passed to the sink and dropped from the working
+// triangulation together with the points only it used. The memory then
+// depends on the points right of the front and along it, and on the points
+// on the convex hull of the points so far: the triangles at the hull share
+// a super vertex, their circle reaches far past the front, so they and
+// their points stay until close(). For a sweep along a strip that's the top
+// and bottom rows of points, it grows with the length of the sweep, but not
+// with the area.
+//
+// Chunks like the columns of tiles of a region give the sweep, within a
+// chunk the points can come in any order. The bounds of all points have to
+// be known in advance for the super triangle. The result is the same as the
+// one of Delaunay for the same points and bounds, up to the order of the
+// triangles. Points equal to an inserted point are skipped, points left of
+// the front are rejected.
+template <class F>
+class StreamingDelaunay
+{
+public:
+    typedef std::function<void(const Triangle<Point<F>, F>&)> Sink;
+
+    // All points lie within the bounds, sink receives the triangles counter-clockwise
+    StreamingDelaunay(const F minX, const F minY, const F maxX, const F maxY, const Sink& sink);
+
+    // Insert a chunk of points
+    void insert(const std::vector<Point<F>>& points);
+
+    // No later point has an x below x, pass the triangles which are final to the sink
+    void finalize(const F x);
+
+    // Pass the remaining triangles to the sink, nothing can be inserted afterwards
+    void close();
+
+    F getFront() const { return m_front; }
+    bool isClosed() const { return m_closed; }
+
+    std::size_t getTriangleCount() const { return m_triangleCount; }      // passed to the sink so far
+    std::size_t getActiveTriangleCount() const;
+    std::size_t getActiveVertexCount() const {
+        return std::max<std::size_t>(m_delaunay.m_vertices.size(), Delaunay<F>::SUPER_VERTICES) - Delaunay<F>::SUPER_VERTICES;
+    }
+    std::size_t getSkippedCount() const { return m_skippedCount; }
+    std::size_t getRejectedCount() const { return m_rejectedCount; }
+
+private:
+    void emit(const std::size_t c);
+    void compact();
+
+    Delaunay<F> m_delaunay;
+    Sink m_sink;
+    F m_front;
+    bool m_closed;
+    std::size_t m_triangleCount;
+    std::size_t m_skippedCount;
+    std::size_t m_rejectedCount;
+
+    std::vector<unsigned> m_order;
+    std::vector<unsigned> m_ids;             // id of each working vertex, the working vertices have none
+    std::vector<unsigned> m_vertexIndex;     // new position of a vertex in compact()
+    std::vector<int> m_cellIndex;            // new position of a cell in compact()
+};
+
+template <class F>
+StreamingDelaunay<F>::StreamingDelaunay(const F minX, const F minY, const F maxX, const F maxY, const Sink& sink) :
+    m_sink(sink),
+    m_front(-std::numeric_limits<F>::max()),
+    m_closed(false),
+    m_triangleCount(0),
+    m_skippedCount(0),
+    m_rejectedCount(0)
+{
+    m_delaunay.initCells(Delaunay<F>::superTriangle(minX, minY, maxX, maxY), 0);
+    m_ids.assign(Delaunay<F>::SUPER_VERTICES, 0);
+}
+
+template <class F>
+void StreamingDelaunay<F>::insert(const std::vector<Point<F>>& points)
+{
+    if (m_closed) {
+        std::cerr << "StreamingDelaunay::insert(): Triangulation already closed" << std::endl;
+        m_rejectedCount += points.size();
+        return;
+    }
+
+    SpatialSort::brio(points, m_order);
+    for (const unsigned i : m_order) {
+        if (points[i].getX() < m_front) {
+            m_rejectedCount++;
+        } else if (m_delaunay.appendVertex(points[i])) {
+            m_ids.push_back(points[i].getId());
+        } else {
+            m_skippedCount++;
+        }
+    }
+}
+
+template <class F>
+void StreamingDelaunay<F>::finalize(const F x)
+{
+    if (m_closed || x <= m_front) {
+        return;
+    }
+    m_front = x;
+
+    // Points on the circumcircle count as inside, so the circle has to end strictly before the front
+    std::vector<typename Delaunay<F>::Cell>& cells = m_delaunay.m_cells;
+    const std::vector<typename Delaunay<F>::Vertex>& vertices = m_delaunay.m_vertices;
+    for (std::size_t c = 0; c < cells.size(); c++) {
+        const typename Delaunay<F>::Cell& cell = cells[c];
+        if (not m_delaunay.isInnerCell(c)
+                || not Delaunay<F>::isInsideSlab(vertices[cell.vertex[0]], vertices[cell.vertex[1]], vertices[cell.vertex[2]],
+                                                 -std::numeric_limits<double>::infinity(), x)) {
+            continue;
+        }
+        emit(c);
+
+        // the cells next to it see the border of the triangulation there
+        for (const int n : cell.neighbour) {
+            if (n >= 0) {
+                typename Delaunay<F>::Cell& neighbour = cells[n];
+                neighbour.neighbour[(neighbour.neighbour[0] == int(c)) ? 0 : (neighbour.neighbour[1] == int(c)) ? 1 : 2] = -1;
+            }
+        }
+        cells[c].alive = false;
+    }
+
+    compact();
+}
+
+template <class F>
+void StreamingDelaunay<F>::close()
+{
+    if (m_closed) {
+        return;
+    }
+    for (std::size_t c = 0; c < m_delaunay.m_cells.size(); c++) {
+        if (m_delaunay.isInnerCell(c)) {
+            emit(c);
+        }
+    }
+    m_delaunay.releaseCells();
+    m_closed = true;
+
+    if (m_skippedCount > 0) {
+        std::cout << "StreamingDelaunay::close(): Skipped " << m_skippedCount << " duplicate points" << std::endl;
+    }
+    if (m_rejectedCount > 0) {
+        std::cerr << "StreamingDelaunay::close(): Rejected " << m_rejectedCount << " points behind the front" << std::endl;
+    }
+}
+
+template <class F>
+std::size_t StreamingDelaunay<F>::getActiveTriangleCount() const
+{
+    std::size_t count = 0;
+    for (std::size_t c = 0; c < m_delaunay.m_cells.size(); c++) {
+        count += m_delaunay.isInnerCell(c);
+    }
+    return count;
+}
+
+template <class F>
+void StreamingDelaunay<F>::emit(const std::size_t c)
+{
+    const typename Delaunay<F>::Cell& cell = m_delaunay.m_cells[c];
+    const std::vector<typename Delaunay<F>::Vertex>& vertices = m_delaunay.m_vertices;
+    Point<F> corners[3];
+    for (unsigned i = 0; i < 3; i++) {
+        corners[i] = vertices[cell.vertex[i]].toPoint(m_ids[cell.vertex[i]]);
+    }
+    m_sink(Triangle<Point<F>, F>(corners[0], corners[1], corners[2]));
+    m_triangleCount++;
+}
+
+template <class F>
+void StreamingDelaunay<F>::compact()
+{
+    // Move the live cells and the vertices they use to the front, the buffers keep
+    // their capacity, so they stay as large as the largest working triangulation
+    Delaunay<F>& d = m_delaunay;
+    const unsigned NONE = std::numeric_limits<unsigned>::max();
+
+    m_vertexIndex.assign(d.m_vertices.size(), NONE);
+    for (unsigned v = 0; v < Delaunay<F>::SUPER_VERTICES; v++) {
+        m_vertexIndex[v] = v;
+    }
+    m_cellIndex.assign(d.m_cells.size(), -1);
+    int cellCount = 0;
+    for (std::size_t c = 0; c < d.m_cells.size(); c++) {
+        if (d.m_cells[c].alive) {
+            m_cellIndex[c] = cellCount++;
+            for (const unsigned v : d.m_cells[c].vertex) {
+                if (v >= Delaunay<F>::SUPER_VERTICES) {
+                    m_vertexIndex[v] = 0;
+                }
+            }
+        }
+    }
+
+    unsigned vertexCount = Delaunay<F>::SUPER_VERTICES;
+    for (std::size_t v = Delaunay<F>::SUPER_VERTICES; v < d.m_vertices.size(); v++) {
+        if (m_vertexIndex[v] != NONE) {
+            m_vertexIndex[v] = vertexCount;
+            d.m_vertices[vertexCount] = d.m_vertices[v];
+            m_ids[vertexCount++] = m_ids[v];
+        }
+    }
+    d.m_vertices.resize(vertexCount);
+    m_ids.resize(vertexCount);
+
+    for (std::size_t c = 0; c < d.m_cells.size(); c++) {
+        if (m_cellIndex[c] < 0) {
+            continue;
+        }
+        typename Delaunay<F>::Cell& cell = d.m_cells[m_cellIndex[c]];
+        cell = d.m_cells[c];
+        for (unsigned i = 0; i < 3; i++) {
+            cell.vertex[i] = m_vertexIndex[cell.vertex[i]];
+            if (cell.neighbour[i] >= 0) {
+                cell.neighbour[i] = m_cellIndex[cell.neighbour[i]];
+            }
+        }
+    }
+    d.m_lastCell = (d.m_lastCell >= 0 && m_cellIndex[d.m_lastCell] >= 0) ? m_cellIndex[d.m_lastCell] : 0;
+    d.m_cells.resize(cellCount);
+    d.m_freeCells.clear();
+    d.m_badStamp.assign(cellCount, 0);
+    d.m_testedStamp.assign(cellCount, 0);
+    d.m_startCell.assign(vertexCount, -1);
+    d.m_startStamp.assign(vertexCount, 0);
+}
@@ -0,0 +1,539 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 Hans-Peter Schadler <hps@abyle.org>
+**
+** This program is free software: you can redistribute it and/or modify it
+** under the terms of the GNU General Public License as published by the Free
+** Software Foundation, either version 3 of the License, or (at your option)
+** any later version.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT
+** ANY WARRANTY; without even the implied warranty of  MERCHANTABILITY or
+** FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+** more details.
+**
+** You should have received a copy of the GNU General Public License along with
+** this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+****************************************************************************/
+
+
+#include "terrainmosaic.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+
+namespace {
+    const double INVALID_HEIGHT = -10000.0;
+    const int INVALID_ORIGIN = std::numeric_limits<int>::min();
+
+    // Splits [0, count) into runs of consecutive indices with the same tile origin
+    template <typename Origin>
+    std::vector<std::pair<int, int>> tileRuns(const int count, Origin origin)
+    {
+        std::vector<std::pair<int, int>> runs;
+
+        int first = 0;
+        for (int i = 1; i <= count; i++) {
+            if (i == count || origin(i) != origin(first)) {
+                runs.push_back(std::make_pair(first, i));
+                first = i;
+            }
+        }
+
+        return runs;
+    }
+
+    // Prefers the plain tile, falls back to the archives the tiles are distributed in
+    std::string findTileFile(const std::string& fileName)
+    {
+        for (const char* extension : { "", ".zip", ".gz" }) {
+            if (std::ifstream(fileName + extension).good()) {
+                return fileName + extension;
+            }
+        }
+
+        return fileName;
+    }
+}
+
+const std::size_t TerrainMosaic::DEFAULT_MEMORY_BUDGET = std::size_t(512) << 20;
+const unsigned TerrainMosaic::DEFAULT_PREFETCH_DEPTH = 2;
+
+TerrainMosaic::TerrainMosaic(const std::string& hgtPath, const std::size_t memoryBudget) :
+    m_hgtPath(hgtPath),
+    m_memoryBudget(memoryBudget),
+    m_memoryUsage(0),
+    m_prefetchDepth(DEFAULT_PREFETCH_DEPTH),
+    m_lastTile(0, 0),
+    m_hasLastTile(false),
+    m_stopPrefetch(false)
+{ }
+
+TerrainMosaic::~TerrainMosaic()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopPrefetch = true;
+    }
+    m_prefetchWork.notify_all();
+
+    if (m_prefetchThread.joinable()) {
+        m_prefetchThread.join();
+    }
+}
+
+int TerrainMosaic::tileOrigin(const double coordinate, const double limit)
+{
+    // also catches NaN
+    if (not (std::fabs(coordinate) <= limit)) {
+        return INVALID_ORIGIN;
+    }
+
+    return int(std::floor(coordinate));
+}
+
+bool TerrainMosaic::isValidTile(const TileKey& key)
+{
+    return key.first >= -90 && key.first < 90 && key.second >= -180 && key.second < 180;
+}
+
+std::string TerrainMosaic::getTileName(const int latOrigin, const int lonOrigin)
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "%c%02d%c%03d.hgt",
+                  (latOrigin >= 0) ? 'N' : 'S', std::abs(latOrigin),
+                  (lonOrigin >= 0) ? 'E' : 'W', std::abs(lonOrigin));
+    return std::string(name);
+}
+
+std::shared_ptr<SRTMParser> TerrainMosaic::getTile(const int latOrigin, const int lonOrigin)
+{
+    const TileKey key(latOrigin, lonOrigin);
+    if (not isValidTile(key)) {
+        return nullptr;
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    observe(key);
+    return acquireTile(key, lock);
+}
+
+std::shared_ptr<SRTMParser> TerrainMosaic::acquireTile(const TileKey& key, std::unique_lock<std::mutex>& lock)
+{
+    while (true) {
+        auto it = m_tiles.find(key);
+        if (it != m_tiles.end()) {
+            m_lru.splice(m_lru.begin(), m_lru, it->second.lruPosition);
+            return it->second.tile;
+        }
+
+        if (m_missingTiles.count(key) > 0) {
+            return nullptr;
+        }
+
+        if (m_loadingTiles.count(key) == 0) {
+            break;
+        }
+
+        // loaded by another thread right now
+        m_tileLoaded.wait(lock);
+    }
+
+    // parse without holding the lock, other tiles stay available meanwhile
+    m_loadingTiles.insert(key);
+    const std::string cacheFolder = m_cacheFolder;
+    lock.unlock();
+
+    std::shared_ptr<SRTMParser> tile = loadTile(key, cacheFolder);
+    const bool ok = (tile != nullptr);
+
+    lock.lock();
+    m_loadingTiles.erase(key);
+
+    if (ok) {
+        m_lru.push_front(key);
+        CacheEntry entry;
+        entry.tile = tile;
+        entry.lruPosition = m_lru.begin();
+        m_tiles[key] = entry;
+        m_memoryUsage += tile->getMemoryUsage();
+
+        evict(key);
+    } else {
+        m_missingTiles.insert(key);
+        tile.reset();
+    }
+
+    m_tileLoaded.notify_all();
+
+    return tile;
+}
+
+std::shared_ptr<SRTMParser> TerrainMosaic::loadTile(const TileKey& key, const std::string& cacheFolder) const
+{
+    const std::string tileName = getTileName(key.first, key.second);
+    const std::string cacheFileName = cacheFolder + "/" + tileName + TileCache::FILE_EXTENSION;
+
+    if (not cacheFolder.empty() && std::ifstream(cacheFileName).good()) {
+        std::shared_ptr<SRTMParser> tile = std::make_shared<SRTMParser>(cacheFileName);
+        if (tile->parseData()) {
+            return tile;
+        }
+        // outdated or damaged, rewritten below
+    }
+
+    std::shared_ptr<SRTMParser> tile = std::make_shared<SRTMParser>(findTileFile(m_hgtPath + "/" + tileName));
+    if (not tile->parseData()) {
+        return nullptr;
+    }
+
+    if (not cacheFolder.empty()) {
+        tile->writeCache(cacheFileName);
+    }
+
+    return tile;
+}
+
+bool TerrainMosaic::isKnownTile(const TileKey& key) const
+{
+    return m_tiles.count(key) > 0 || m_missingTiles.count(key) > 0 || m_loadingTiles.count(key) > 0;
+}
+
+void TerrainMosaic::evict(const TileKey& keep)
+{
+    // The tile just requested always stays, even if it alone exceeds the budget.
+    // Evicted tiles stay valid for callers still holding them.
+    while (m_memoryUsage > m_memoryBudget && m_lru.size() > 1 && m_lru.back() != keep) {
+        auto it = m_tiles.find(m_lru.back());
+        m_memoryUsage -= it->second.tile->getMemoryUsage();
+        m_prefetchedTiles.erase(it->first);
+        m_tiles.erase(it);
+        m_lru.pop_back();
+    }
+}
+
+void TerrainMosaic::observe(const TileKey& key)
+{
+    if (m_prefetchedTiles.erase(key) > 0) {
+        // room for the next prefetch
+        m_prefetchWork.notify_all();
+    }
+
+    if (m_hasLastTile && key != m_lastTile && m_prefetchQueue.empty()) {
+        // guess that the queries keep moving in the same direction
+        const int dLat = (key.first > m_lastTile.first) - (key.first < m_lastTile.first);
+        const int dLon = (key.second > m_lastTile.second) - (key.second < m_lastTile.second);
+        schedule(std::vector<TileKey>(1, TileKey(key.first + dLat, key.second + dLon)));
+    }
+
+    m_lastTile = key;
+    m_hasLastTile = true;
+}
+
+void TerrainMosaic::schedule(const std::vector<TileKey>& tiles, const bool replace)
+{
+    if (replace) {
+        m_prefetchQueue.clear();
+    }
+
+    if (m_prefetchDepth == 0) {
+        return;
+    }
+
+    std::vector<TileKey> pending;
+    for (const TileKey& key : tiles) {
+        if (isValidTile(key) && not isKnownTile(key) && std::find(pending.begin(), pending.end(), key) == pending.end()) {
+            pending.push_back(key);
+        }
+    }
+
+    // the tiles needed next go in front of the ones queued by prefetch()
+    m_prefetchQueue.erase(std::remove_if(m_prefetchQueue.begin(), m_prefetchQueue.end(), [&pending](const TileKey& key) {
+        return std::find(pending.begin(), pending.end(), key) != pending.end();
+    }), m_prefetchQueue.end());
+    m_prefetchQueue.insert(m_prefetchQueue.begin(), pending.begin(), pending.end());
+
+    if (m_prefetchQueue.empty()) {
+        return;
+    }
+
+    if (not m_prefetchThread.joinable()) {
+        m_prefetchThread = std::thread(&TerrainMosaic::prefetchLoop, this);
+    }
+    m_prefetchWork.notify_all();
+}
+
+void TerrainMosaic::prefetchLoop()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while (true) {
+        m_prefetchWork.wait(lock, [this]() {
+            return m_stopPrefetch || (not m_prefetchQueue.empty() && m_prefetchedTiles.size() < m_prefetchDepth);
+        });
+
+        if (m_stopPrefetch) {
+            return;
+        }
+
+        const TileKey key = m_prefetchQueue.front();
+        m_prefetchQueue.pop_front();
+
+        if (not isKnownTile(key) && acquireTile(key, lock)) {
+            m_prefetchedTiles.insert(key);
+        }
+
+        // wakes waitForPrefetch() even if nothing was loaded
+        m_tileLoaded.notify_all();
+    }
+}
+
+void TerrainMosaic::prefetch(const double latStart, const double latEnd, const double lonStart, const double lonEnd)
+{
+    std::vector<TileKey> tiles;
+
+    const int latFirst = tileOrigin(std::min(latStart, latEnd), 90.0);
+    const int latLast = tileOrigin(std::max(latStart, latEnd), 90.0);
+    const int lonFirst = tileOrigin(std::min(lonStart, lonEnd), 180.0);
+    const int lonLast = tileOrigin(std::max(lonStart, lonEnd), 180.0);
+
+    if (latFirst != INVALID_ORIGIN && latLast != INVALID_ORIGIN && lonFirst != INVALID_ORIGIN && lonLast != INVALID_ORIGIN) {
+        for (int lat = latFirst; lat <= latLast; lat++) {
+            for (int lon = lonFirst; lon <= lonLast; lon++) {
+                tiles.push_back(TileKey(lat, lon));
+            }
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    schedule(tiles, true);
+}
+
+void TerrainMosaic::prefetch(const std::vector<double>& latitudes, const std::vector<double>& longitudes)
+{
+    std::vector<TileKey> tiles;
+    std::set<TileKey> visited;
+
+    for (std::size_t i = 0; i < std::min(latitudes.size(), longitudes.size()); i++) {
+        const TileKey key(tileOrigin(latitudes[i], 90.0), tileOrigin(longitudes[i], 180.0));
+        if (visited.insert(key).second) {
+            tiles.push_back(key);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    schedule(tiles, true);
+}
+
+void TerrainMosaic::waitForPrefetch()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_tileLoaded.wait(lock, [this]() {
+        return m_loadingTiles.empty() && (m_prefetchQueue.empty() || m_prefetchedTiles.size() >= m_prefetchDepth);
+    });
+}
+
+void TerrainMosaic::setPrefetchDepth(const unsigned prefetchDepth)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_prefetchDepth = prefetchDepth;
+    if (m_prefetchDepth == 0) {
+        m_prefetchQueue.clear();
+    }
+    m_prefetchWork.notify_all();
+}
+
+void TerrainMosaic::setCacheFolder(const std::string& cacheFolder)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_cacheFolder = cacheFolder;
+}
+
+std::string TerrainMosaic::getCacheFolder() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_cacheFolder;
+}
+
+unsigned TerrainMosaic::getPrefetchDepth() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_prefetchDepth;
+}
+
+double TerrainMosaic::getHeight(const double latitude, const double longitude,
+                                const SRTMParser::InterpolationType interpolationType)
+{
+    const int latOrigin = tileOrigin(latitude, 90.0);
+    const int lonOrigin = tileOrigin(longitude, 180.0);
+    if (latOrigin == INVALID_ORIGIN || lonOrigin == INVALID_ORIGIN) {
+        return INVALID_HEIGHT;
+    }
+
+    // Neighbouring tiles share their border samples, a point on the south/west
+    // border can be answered by the tile below/left of it as well.
+    const int latCandidates = (latitude == latOrigin) ? 2 : 1;
+    const int lonCandidates = (longitude == lonOrigin) ? 2 : 1;
+
+    for (int dLat = 0; dLat < latCandidates; dLat++) {
+        for (int dLon = 0; dLon < lonCandidates; dLon++) {
+            std::shared_ptr<SRTMParser> tile = getTile(latOrigin - dLat, lonOrigin - dLon);
+            if (tile) {
+                return tile->getHeight(latitude, longitude, interpolationType);
+            }
+        }
+    }
+
+    return INVALID_HEIGHT;
+}
+
+void TerrainMosaic::getHeights(const double* latitudes, const double* longitudes, double* heights, const std::size_t count,
+                               const SRTMParser::InterpolationType interpolationType)
+{
+    struct Run {
+        std::size_t first;
+        std::size_t last;
+        TileKey key;
+    };
+
+    // queries along a path stay within a tile for long stretches, hand those to the tile at once
+    std::vector<Run> runs;
+    std::size_t first = 0;
+    while (first < count) {
+        Run run;
+        run.first = first;
+        run.key = TileKey(tileOrigin(latitudes[first], 90.0), tileOrigin(longitudes[first], 180.0));
+
+        run.last = first + 1;
+        while (run.last < count && tileOrigin(latitudes[run.last], 90.0) == run.key.first && tileOrigin(longitudes[run.last], 180.0) == run.key.second) {
+            run.last++;
+        }
+
+        runs.push_back(run);
+        first = run.last;
+    }
+
+    if (runs.size() > 1) {
+        std::vector<TileKey> tiles;
+        for (std::size_t i = 1; i < runs.size(); i++) {
+            tiles.push_back(runs[i].key);
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        schedule(tiles);
+    }
+
+    for (const Run& run : runs) {
+        std::shared_ptr<SRTMParser> tile = getTile(run.key.first, run.key.second);
+
+        if (tile) {
+            tile->getHeights(latitudes + run.first, longitudes + run.first, heights + run.first, run.last - run.first, interpolationType);
+        } else {
+            for (std::size_t i = run.first; i < run.last; i++) {
+                heights[i] = getHeight(latitudes[i], longitudes[i], interpolationType);
+            }
+        }
+    }
+}
+
+std::vector<double> TerrainMosaic::getHeights(const std::vector<double>& latitudes, const std::vector<double>& longitudes,
+                                              const SRTMParser::InterpolationType interpolationType)
+{
+    std::vector<double> heights(std::min(latitudes.size(), longitudes.size()));
+    getHeights(latitudes.data(), longitudes.data(), heights.data(), heights.size(), interpolationType);
+    return heights;
+}
+
+std::vector<double> TerrainMosaic::resample(const RegularGrid& grid, const SRTMParser::InterpolationType interpolationType,
+                                            unsigned threads)
+{
+    std::vector<double> heights(grid.size(), INVALID_HEIGHT);
+
+    const std::vector<std::pair<int, int>> rowRuns = tileRuns(grid.getRows(), [&grid](const int row) {
+        return tileOrigin(grid.getLatitude(row), 90.0);
+    });
+    const std::vector<std::pair<int, int>> colRuns = tileRuns(grid.getCols(), [&grid](const int col) {
+        return tileOrigin(grid.getLongitude(col), 180.0);
+    });
+
+    std::vector<TileKey> tiles;
+    for (const auto& rowRun : rowRuns) {
+        for (const auto& colRun : colRuns) {
+            tiles.push_back(TileKey(tileOrigin(grid.getLatitude(rowRun.first), 90.0), tileOrigin(grid.getLongitude(colRun.first), 180.0)));
+        }
+    }
+    if (tiles.size() > 1) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        schedule(std::vector<TileKey>(tiles.begin() + 1, tiles.end()));
+    }
+
+    for (const auto& rowRun : rowRuns) {
+        for (const auto& colRun : colRuns) {
+            const int rows = rowRun.second - rowRun.first;
+            const int cols = colRun.second - colRun.first;
+
+            const int latOrigin = tileOrigin(grid.getLatitude(rowRun.first), 90.0);
+            const int lonOrigin = tileOrigin(grid.getLongitude(colRun.first), 180.0);
+            if (latOrigin == INVALID_ORIGIN || lonOrigin == INVALID_ORIGIN) {
+                continue;
+            }
+
+            std::shared_ptr<SRTMParser> tile = getTile(latOrigin, lonOrigin);
+            std::vector<double> block;
+            if (tile) {
+                RegularGrid blockGrid(grid.getLatitude(rowRun.first), grid.getLongitude(colRun.first),
+                                      grid.getLatSpacing(), grid.getLonSpacing(), rows, cols);
+                block = GridResampler(*tile).resample(blockGrid, interpolationType, threads);
+            }
+
+            for (int row = 0; row < rows; row++) {
+                for (int col = 0; col < cols; col++) {
+                    double& height = heights[std::size_t(rowRun.first + row)*grid.getCols() + colRun.first + col];
+                    if (tile) {
+                        height = block[std::size_t(row)*cols + col];
+                    }
+
+                    // missing tile, or a point that rounded across the tile border in the block grid
+                    if (height == INVALID_HEIGHT) {
+                        height = getHeight(grid.getLatitude(rowRun.first + row), grid.getLongitude(colRun.first + col), interpolationType);
+                    }
+                }
+            }
+        }
+    }
+
+    return heights;
+}
+
+std::vector<std::string> TerrainMosaic::getMissingTiles() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    std::vector<std::string> names;
+    for (const TileKey& key : m_missingTiles) {
+        names.push_back(getTileName(key.first, key.second));
+    }
+    return names;
+}
+
+std::size_t TerrainMosaic::getCachedTileCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_tiles.size();
+}
+
+std::size_t TerrainMosaic::getMemoryUsage() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_memoryUsage;
+}
+
+std::size_t TerrainMosaic::getMemoryBudget() const
+{
+    return m_memoryBudget;
+}
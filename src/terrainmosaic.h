@@ -0,0 +1,149 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 Hans-Peter Schadler <hps@abyle.org>
+**
+** This program is free software: you can redistribute it and/or modify it
+** under the terms of the GNU General Public License as published by the Free
+** Software Foundation, either version 3 of the License, or (at your option)
+** any later version.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT
+** ANY WARRANTY; without even the implied warranty of  MERCHANTABILITY or
+** FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+** more details.
+**
+** You should have received a copy of the GNU General Public License along with
+** this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+****************************************************************************/
+
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "gridresampler.h"
+#include "srtmparser.h"
+
+// Height queries over all tiles found in a folder of N47E015.hgt style files,
+// N47E015.hgt.zip and N47E015.hgt.gz are used if there is no plain tile.
+// Tiles are loaded on first use and kept in a least recently used cache whose
+// decoded size is bounded by a memory budget. A query is answered by the tile
+// containing it; points on a tile border fall back to the neighbouring tile if
+// the first one is missing.
+//
+// Tiles are prefetched on a background thread: the batch queries and resample()
+// schedule the tiles they will visit ahead of the pending ones, prefetch() takes
+// an area or path from the caller, and otherwise the next tile in the direction
+// the queries move in is loaded ahead. At most getPrefetchDepth() tiles are loaded ahead of use.
+// All methods may be called from several threads.
+class TerrainMosaic
+{
+public:
+    static const std::size_t DEFAULT_MEMORY_BUDGET;
+    static const unsigned DEFAULT_PREFETCH_DEPTH;
+
+    TerrainMosaic(const std::string& hgtPath, const std::size_t memoryBudget = DEFAULT_MEMORY_BUDGET);
+    ~TerrainMosaic();
+
+    TerrainMosaic(const TerrainMosaic&) = delete;
+    TerrainMosaic& operator=(const TerrainMosaic&) = delete;
+
+    double getHeight(const double latitude, const double longitude,
+                     const SRTMParser::InterpolationType interpolationType = SRTMParser::InterpolationType::NO_INTERPOLATION);
+
+    void getHeights(const double* latitudes, const double* longitudes, double* heights, const std::size_t count,
+                    const SRTMParser::InterpolationType interpolationType = SRTMParser::InterpolationType::NO_INTERPOLATION);
+    std::vector<double> getHeights(const std::vector<double>& latitudes, const std::vector<double>& longitudes,
+                                   const SRTMParser::InterpolationType interpolationType = SRTMParser::InterpolationType::NO_INTERPOLATION);
+
+    // Row-major heights like GridResampler::resample(), the grid may span any number of tiles
+    std::vector<double> resample(const RegularGrid& grid,
+                                 const SRTMParser::InterpolationType interpolationType = SRTMParser::InterpolationType::LINEAR_INTERPOLATION,
+                                 unsigned threads = 0);
+
+    // Tile with the given south west corner, nullptr if it doesn't exist or can't be parsed.
+    // Waits for the tile if the prefetcher is loading it.
+    std::shared_ptr<SRTMParser> getTile(const int latOrigin, const int lonOrigin);
+
+    // Replace the pending prefetches by the tiles of an area, south to north and west to east,
+    // or by the tiles along a path in the order they are visited
+    void prefetch(const double latStart, const double latEnd, const double lonStart, const double lonEnd);
+    void prefetch(const std::vector<double>& latitudes, const std::vector<double>& longitudes);
+
+    // Blocks until the prefetcher has nothing left to do or is waiting for tiles to be used
+    void waitForPrefetch();
+
+    // Folder of TileCache files. Tiles are read from there if cached and cached after
+    // parsing them otherwise. Replaced hgt files need their cache file removed.
+    // Empty, the default, disables the cache.
+    void setCacheFolder(const std::string& cacheFolder);
+    std::string getCacheFolder() const;
+
+    // 0 disables prefetching
+    void setPrefetchDepth(const unsigned prefetchDepth);
+    unsigned getPrefetchDepth() const;
+
+    static std::string getTileName(const int latOrigin, const int lonOrigin);
+
+    // File names of the tiles which were requested but could not be loaded
+    std::vector<std::string> getMissingTiles() const;
+
+    std::size_t getCachedTileCount() const;
+    std::size_t getMemoryUsage() const;
+    std::size_t getMemoryBudget() const;
+
+private:
+    typedef std::pair<int, int> TileKey;
+
+    struct CacheEntry {
+        std::shared_ptr<SRTMParser> tile;
+        std::list<TileKey>::iterator lruPosition;
+    };
+
+    static int tileOrigin(const double coordinate, const double limit);
+    static bool isValidTile(const TileKey& key);
+    std::shared_ptr<SRTMParser> loadTile(const TileKey& key, const std::string& cacheFolder) const;
+
+    // The following expect m_mutex to be locked
+    std::shared_ptr<SRTMParser> acquireTile(const TileKey& key, std::unique_lock<std::mutex>& lock);
+    bool isKnownTile(const TileKey& key) const;
+    void evict(const TileKey& keep);
+    void observe(const TileKey& key);
+    // Queues tiles ahead of the pending ones, or instead of them if replace is set
+    void schedule(const std::vector<TileKey>& tiles, const bool replace = false);
+
+    void prefetchLoop();
+
+    std::string m_hgtPath;
+    std::string m_cacheFolder;
+    std::size_t m_memoryBudget;
+    std::size_t m_memoryUsage;
+
+    std::map<TileKey, CacheEntry> m_tiles;
+    std::list<TileKey> m_lru; // most recently used tile first
+    std::set<TileKey> m_missingTiles;
+    std::set<TileKey> m_loadingTiles;
+
+    std::deque<TileKey> m_prefetchQueue;
+    std::set<TileKey> m_prefetchedTiles; // loaded ahead and not requested yet
+    unsigned m_prefetchDepth;
+    TileKey m_lastTile;
+    bool m_hasLastTile;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_tileLoaded;
+    std::condition_variable m_prefetchWork;
+    std::thread m_prefetchThread;
+    bool m_stopPrefetch;
+};
@@ -0,0 +1,262 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 Hans-Peter Schadler <hps@abyle.org>
+**
+** This program is free software: you can redistribute it and/or modify it
+** under the terms of the GNU General Public License as published by the Free
+** Software Foundation, either version 3 of the License, or (at your option)
+** any later version.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT
+** ANY WARRANTY; without even the implied warranty of  MERCHANTABILITY or
+** FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+** more details.
+**
+** You should have received a copy of the GNU General Public License along with
+** this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+****************************************************************************/
+
+
+#include "tilecache.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#ifdef _WIN32
+    #include <process.h>
+#else
+    #include <unistd.h>
+#endif
+
+namespace {
+    const char MAGIC[8] = { 'Q', 'W', 'P', 'T', 'I', 'L', 'E', '\n' };
+
+    bool isLittleEndianHost()
+    {
+        const uint16_t value = 1;
+        unsigned char first;
+        std::memcpy(&first, &value, 1);
+        return first == 1;
+    }
+
+    void putLittleEndian(unsigned char* c, const uint64_t value, const int bytes)
+    {
+        for (int i = 0; i < bytes; i++) {
+            c[i] = (value >> (8*i)) & 0xFF;
+        }
+    }
+
+    uint64_t getLittleEndian(const unsigned char* c, const int bytes)
+    {
+        uint64_t value = 0;
+        for (int i = bytes - 1; i >= 0; i--) {
+            value = (value << 8) | c[i];
+        }
+        return value;
+    }
+
+    // Name next to fileName no other writer uses at the same time: the process id
+    // keeps processes apart, the counter the writers within this process.
+    std::string tempFileName(const std::string& fileName)
+    {
+        static std::atomic<unsigned> counter(0);
+#ifdef _WIN32
+        const long processId = _getpid();
+#else
+        const long processId = getpid();
+#endif
+        std::ostringstream name;
+        name << fileName << "." << processId << "." << counter++ << ".tmp";
+        return name.str();
+    }
+
+    std::size_t alignUp(const std::size_t offset)
+    {
+        return (offset + HeightRaster::ALIGNMENT - 1)/HeightRaster::ALIGNMENT*HeightRaster::ALIGNMENT;
+    }
+}
+
+const uint32_t TileCache::VERSION;
+const int TileCache::DEFAULT_BLOCK_SIZE;
+const std::size_t TileCache::HEADER_SIZE;
+const char* const TileCache::FILE_EXTENSION = ".qwtile";
+
+bool TileCache::isTileCache(const std::string& fileName)
+{
+    std::ifstream file(fileName, std::ios::binary);
+    char magic[sizeof(MAGIC)];
+    return file.read(magic, sizeof(magic)) && std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+bool TileCache::write(const std::string& fileName, const HeightRaster& heightData, const int latOrigin, const int lonOrigin,
+                      const HgtStatistics& statistics, const int blockSize)
+{
+    if (not isLittleEndianHost()) {
+        std::cerr << "TileCache::write(): Tile caches are only supported on little-endian hosts" << std::endl;
+        return false;
+    }
+    if (heightData.isEmpty() || heightData.rows() != heightData.cols() || blockSize < 0) {
+        return false;
+    }
+
+    const int samples = heightData.rows();
+    const std::size_t stride = HeightRaster::alignedStride(samples);
+    const int blockCount = (blockSize > 0) ? (samples + blockSize - 1)/blockSize : 0;
+
+    std::vector<int16_t> blockSummary(2*blockCount*blockCount);
+    for (int blockRow = 0; blockRow < blockCount; blockRow++) {
+        for (int blockCol = 0; blockCol < blockCount; blockCol++) {
+            int16_t blockMin = INT16_MAX;
+            int16_t blockMax = INT16_MIN;
+            for (int row = blockRow*blockSize; row < std::min(samples, (blockRow + 1)*blockSize); row++) {
+                const int16_t* rowData = heightData.rowData(row);
+                for (int col = blockCol*blockSize; col < std::min(samples, (blockCol + 1)*blockSize); col++) {
+                    if (rowData[col] != HgtDecoder::VOID_VALUE) {
+                        blockMin = std::min(blockMin, rowData[col]);
+                        blockMax = std::max(blockMax, rowData[col]);
+                    }
+                }
+            }
+            blockSummary[2*(blockRow*blockCount + blockCol)] = blockMin;
+            blockSummary[2*(blockRow*blockCount + blockCol) + 1] = blockMax;
+        }
+    }
+
+    const std::size_t dataOffset = alignUp(HEADER_SIZE + blockSummary.size()*sizeof(int16_t));
+
+    unsigned char header[HEADER_SIZE] = {};
+    std::memcpy(header, MAGIC, sizeof(MAGIC));
+    putLittleEndian(header + 8, VERSION, 4);
+    putLittleEndian(header + 12, uint32_t(latOrigin), 4);
+    putLittleEndian(header + 16, uint32_t(lonOrigin), 4);
+    putLittleEndian(header + 20, samples, 4);
+    putLittleEndian(header + 24, stride, 4);
+    putLittleEndian(header + 28, uint16_t(statistics.min), 2);
+    putLittleEndian(header + 30, uint16_t(statistics.max), 2);
+    putLittleEndian(header + 32, statistics.voidCount, 8);
+    putLittleEndian(header + 40, blockSize, 4);
+    putLittleEndian(header + 44, blockCount, 4);
+    putLittleEndian(header + 48, dataOffset, 8);
+
+    // written next to the target and renamed, readers never see a partial cache and
+    // writers of the same tile don't share the temporary file
+    const std::string tempName = tempFileName(fileName);
+    std::ofstream file(tempName, std::ios::binary | std::ios::trunc);
+    if (not file.is_open()) {
+        std::cerr << "TileCache::write(): Can't write " << tempName << std::endl;
+        return false;
+    }
+
+    file.write(reinterpret_cast<const char*>(header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(blockSummary.data()), blockSummary.size()*sizeof(int16_t));
+
+    const std::vector<char> padding(std::max(dataOffset - HEADER_SIZE - blockSummary.size()*sizeof(int16_t),
+                                             (stride - samples)*sizeof(int16_t)), 0);
+    file.write(padding.data(), dataOffset - HEADER_SIZE - blockSummary.size()*sizeof(int16_t));
+
+    for (int row = 0; row < samples; row++) {
+        file.write(reinterpret_cast<const char*>(heightData.rowData(row)), samples*sizeof(int16_t));
+        file.write(padding.data(), (stride - samples)*sizeof(int16_t));
+    }
+
+    file.close();
+    if (not file) {
+        std::remove(tempName.c_str());
+        return false;
+    }
+
+    std::remove(fileName.c_str());
+    if (std::rename(tempName.c_str(), fileName.c_str()) != 0) {
+        std::remove(tempName.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+TileCache::TileCache() :
+    m_latOrigin(0),
+    m_lonOrigin(0),
+    m_samples(0),
+    m_stride(0),
+    m_blockSize(0),
+    m_blockCount(0),
+    m_blockSummary(nullptr),
+    m_data(nullptr)
+{ }
+
+bool TileCache::open(const std::string& fileName)
+{
+    if (not isLittleEndianHost()) {
+        std::cerr << "TileCache::open(): Tile caches are only supported on little-endian hosts" << std::endl;
+        return false;
+    }
+
+    std::shared_ptr<MappedFile> mappedFile = std::make_shared<MappedFile>();
+    if (not mappedFile->open(fileName) || mappedFile->size() < HEADER_SIZE) {
+        return false;
+    }
+
+    const unsigned char* header = mappedFile->data();
+    if (std::memcmp(header, MAGIC, sizeof(MAGIC)) != 0) {
+        return false;
+    }
+
+    const uint32_t version = getLittleEndian(header + 8, 4);
+    if (version != VERSION) {
+        std::cout << "TileCache::open(): " << fileName << " has version " << version << ", expected " << VERSION << std::endl;
+        return false;
+    }
+
+    const int samples = int32_t(getLittleEndian(header + 20, 4));
+    const std::size_t stride = getLittleEndian(header + 24, 4);
+    const int blockSize = int32_t(getLittleEndian(header + 40, 4));
+    const int blockCount = int32_t(getLittleEndian(header + 44, 4));
+    const std::size_t dataOffset = getLittleEndian(header + 48, 8);
+
+    const bool validLayout = (samples == 1201 || samples == 3601)
+            && stride >= std::size_t(samples)
+            && (stride*sizeof(int16_t)) % HeightRaster::ALIGNMENT == 0
+            && blockSize >= 0
+            && blockCount == ((blockSize > 0) ? (samples + blockSize - 1)/blockSize : 0)
+            && dataOffset % HeightRaster::ALIGNMENT == 0
+            && dataOffset >= HEADER_SIZE + 2*sizeof(int16_t)*blockCount*blockCount
+            // in two steps, a huge offset must not wrap around
+            && dataOffset <= mappedFile->size()
+            && samples*stride*sizeof(int16_t) <= mappedFile->size() - dataOffset;
+    if (not validLayout) {
+        std::cout << "TileCache::open(): " << fileName << " is damaged" << std::endl;
+        return false;
+    }
+
+    m_latOrigin = int32_t(getLittleEndian(header + 12, 4));
+    m_lonOrigin = int32_t(getLittleEndian(header + 16, 4));
+    m_samples = samples;
+    m_stride = stride;
+    m_statistics.min = int16_t(getLittleEndian(header + 28, 2));
+    m_statistics.max = int16_t(getLittleEndian(header + 30, 2));
+    m_statistics.voidCount = getLittleEndian(header + 32, 8);
+    m_blockSize = blockSize;
+    m_blockCount = blockCount;
+    m_blockSummary = reinterpret_cast<const int16_t*>(header + HEADER_SIZE);
+    m_data = reinterpret_cast<const int16_t*>(header + dataOffset);
+    m_mappedFile = mappedFile;
+
+    return true;
+}
+
+HeightRaster TileCache::getHeightData() const
+{
+    if (not m_mappedFile) {
+        return HeightRaster();
+    }
+
+    return HeightRaster::view(m_data, m_samples, m_samples, m_stride, m_mappedFile);
+}
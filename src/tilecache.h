@@ -0,0 +1,97 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 Hans-Peter Schadler <hps@abyle.org>
+**
+** This program is free software: you can redistribute it and/or modify it
+** under the terms of the GNU General Public License as published by the Free
+** Software Foundation, either version 3 of the License, or (at your option)
+** any later version.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT
+** ANY WARRANTY; without even the implied warranty of  MERCHANTABILITY or
+** FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+** more details.
+**
+** You should have received a copy of the GNU General Public License along with
+** this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+****************************************************************************/
+
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "heightraster.h"
+#include "hgtdecoder.h"
+#include "mappedfile.h"
+
+// Packed tile cache file written from a parsed tile. The samples are stored as
+// native little-endian int16 rows padded to HeightRaster::alignedStride(), so a
+// cache file is mapped and used as raster without any decoding. The header keeps
+// the origin, the resolution and the statistics, optionally followed by the
+// min/max of every block of blockSize x blockSize samples.
+//
+// Layout (little-endian):
+//     0  char[8]  magic "QWPTILE\n"
+//     8  uint32   version
+//    12  int32    latitude origin
+//    16  int32    longitude origin
+//    20  int32    samples per row and column
+//    24  int32    stride, samples per stored row
+//    28  int16    min, int16 max
+//    32  uint64   void count
+//    40  int32    block size, 0 without block summary
+//    44  int32    blocks per row and column
+//    48  uint64   offset of the samples, a multiple of HeightRaster::ALIGNMENT
+//    56  uint64   reserved
+//    64  int16[2] min/max per block, row-major from the north west block
+class TileCache
+{
+public:
+    static const uint32_t VERSION = 1;
+    static const int DEFAULT_BLOCK_SIZE = 128;
+    static const char* const FILE_EXTENSION;
+
+    static bool isTileCache(const std::string& fileName);
+
+    // Cache files are only written and read on little-endian hosts
+    static bool write(const std::string& fileName, const HeightRaster& heightData, const int latOrigin, const int lonOrigin,
+                      const HgtStatistics& statistics, const int blockSize = DEFAULT_BLOCK_SIZE);
+
+    TileCache();
+
+    bool open(const std::string& fileName);
+
+    // Read-only view into the mapped file
+    HeightRaster getHeightData() const;
+
+    int getLatOrigin() const { return m_latOrigin; }
+    int getLonOrigin() const { return m_lonOrigin; }
+    int getSampleCount() const { return m_samples; }
+    HgtStatistics getStatistics() const { return m_statistics; }
+
+    int getBlockSize() const { return m_blockSize; }
+    int getBlockCount() const { return m_blockCount; }
+
+    // Min/max of the valid samples in a block, min > max if the block is void only
+    int16_t getBlockMin(const int blockRow, const int blockCol) const { return m_blockSummary[2*(blockRow*m_blockCount + blockCol)]; }
+    int16_t getBlockMax(const int blockRow, const int blockCol) const { return m_blockSummary[2*(blockRow*m_blockCount + blockCol) + 1]; }
+
+private:
+    static const std::size_t HEADER_SIZE = 64;
+
+    std::shared_ptr<MappedFile> m_mappedFile;
+
+    int m_latOrigin;
+    int m_lonOrigin;
+    int m_samples;
+    std::size_t m_stride;
+    HgtStatistics m_statistics;
+    int m_blockSize;
+    int m_blockCount;
+    const int16_t* m_blockSummary;
+    const int16_t* m_data;
+};
@@ -0,0 +1,299 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 Hans-Peter Schadler <hps@abyle.org>
+**
+** This program is free software: you can redistribute it and/or modify it
+** under the terms of the GNU General Public License as published by the Free
+** Software Foundation, either version 3 of the License, or (at your option)
+** any later version.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT
+** ANY WARRANTY; without even the implied warranty of  MERCHANTABILITY or
+** FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+** more details.
+**
+** You should have received a copy of the GNU General Public License along with
+** this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+****************************************************************************/
+
+
+#include "tinbuilder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#include "hgtdecoder.h"
+
+const double TinBuilder::DEFAULT_TOLERANCE = 1.0;
+
+namespace {
+    // floor(a/b) and ceil(a/b) for b > 0
+    int64_t floorDiv(const int64_t a, const int64_t b)
+    {
+        return (a >= 0) ? a/b : -((-a + b - 1)/b);
+    }
+
+    int64_t ceilDiv(const int64_t a, const int64_t b)
+    {
+        return (a >= 0) ? (a + b - 1)/b : -((-a)/b);
+    }
+}
+
+TinBuilder::TinBuilder(const SRTMParser& srtmParser) :
+    m_heightData(srtmParser.getHeightData()),
+    m_latOrigin(srtmParser.getLatOrigin()),
+    m_lonOrigin(srtmParser.getLonOrigin()),
+    m_cornerHeights(),
+    m_tolerance(DEFAULT_TOLERANCE),
+    m_maxVertices(0),
+    m_maxError(0.0)
+{ }
+
+double TinBuilder::sampleHeight(const int row, const int col) const
+{
+    const int16_t height = m_heightData.at(row, col);
+    if (height != HgtDecoder::VOID_VALUE) {
+        return height;
+    }
+    // only the tile corners are inserted without a valid sample
+    return m_cornerHeights[(row == 0 ? 0 : 2) + (col == 0 ? 0 : 1)];
+}
+
+bool TinBuilder::closestHeight(const int row, const int col, double& height) const
+{
+    // mean of the valid samples on the smallest square ring around the sample which has any
+    const int rows = m_heightData.rows();
+    const int cols = m_heightData.cols();
+    double sum = 0.0;
+    int count = 0;
+    auto add = [this, &sum, &count](const int r, const int c) {
+        const int16_t sample = m_heightData.at(r, c);
+        if (sample != HgtDecoder::VOID_VALUE) {
+            sum += sample;
+            count++;
+        }
+    };
+
+    for (int distance = 0; distance < std::max(rows, cols); distance++) {
+        const int top = row - distance, bottom = row + distance;
+        const int left = col - distance, right = col + distance;
+        const int firstCol = std::max(left, 0), lastCol = std::min(right, cols - 1);
+
+        // the border rows of the ring, then its border columns between them
+        if (top >= 0) {
+            for (int c = firstCol; c <= lastCol; c++) {
+                add(top, c);
+            }
+        }
+        if (distance > 0 && bottom < rows) {
+            for (int c = firstCol; c <= lastCol; c++) {
+                add(bottom, c);
+            }
+        }
+        for (int r = std::max(top + 1, 0); r <= std::min(bottom - 1, rows - 1); r++) {
+            if (left >= 0) {
+                add(r, left);
+            }
+            if (right < cols) {
+                add(r, right);
+            }
+        }
+
+        if (count > 0) {
+            height = sum/count;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool TinBuilder::build()
+{
+    if (m_heightData.isEmpty() || m_heightData.rows() < 2 || m_heightData.cols() < 2) {
+        std::cerr << "TinBuilder::build(): No height data" << std::endl;
+        return false;
+    }
+
+    const int rows = m_heightData.rows();
+    const int cols = m_heightData.cols();
+
+    const int cornerRows[4] = { 0, 0, rows - 1, rows - 1 };
+    const int cornerCols[4] = { 0, cols - 1, 0, cols - 1 };
+    for (int i = 0; i < 4; i++) {
+        if (not closestHeight(cornerRows[i], cornerCols[i], m_cornerHeights[i])) {
+            std::cerr << "TinBuilder::build(): No valid height sample" << std::endl;
+            return false;
+        }
+    }
+
+    m_samples.clear();
+    m_queue.clear();
+    m_delaunay.initCells(Delaunay<double>::superTriangle(0, 0, cols - 1, rows - 1), 0);
+
+    for (int i = 0; i < 4; i++) {
+        insertSample(cornerRows[i], cornerCols[i]);
+    }
+
+    m_cellVersion.assign(m_delaunay.m_cells.size(), 0);
+    for (std::size_t c = 0; c < m_delaunay.m_cells.size(); c++) {
+        if (m_delaunay.isInnerCell(c)) {
+            scanCell(c);
+        }
+    }
+
+    m_maxError = 0.0;
+    while (not m_queue.empty()) {
+        std::pop_heap(m_queue.begin(), m_queue.end());
+        const Candidate candidate = m_queue.back();
+        m_queue.pop_back();
+
+        // the triangle was replaced since it was scanned
+        if (not m_delaunay.m_cells[candidate.cell].alive || m_cellVersion[candidate.cell] != candidate.version) {
+            continue;
+        }
+
+        if (candidate.error <= m_tolerance || (m_maxVertices > 0 && m_samples.size() >= m_maxVertices)) {
+            m_maxError = candidate.error;
+            break;
+        }
+
+        if (not insertSample(candidate.row, candidate.col)) {
+            continue;
+        }
+
+        m_cellVersion.resize(m_delaunay.m_cells.size(), 0);
+        for (const int c : m_delaunay.m_newCells) {
+            m_cellVersion[c]++;
+            if (m_delaunay.isInnerCell(c)) {
+                scanCell(c);
+            }
+        }
+    }
+
+    // Mesh in latitude and longitude, the vertices in insertion order
+    const double rowSpacing = 1.0/(rows - 1);
+    const double colSpacing = 1.0/(cols - 1);
+    std::vector<Point<double>> points;
+    points.reserve(m_samples.size());
+    m_heights.clear();
+    m_heights.reserve(m_samples.size());
+    for (const uint32_t sample : m_samples) {
+        const int row = sample/cols;
+        const int col = sample % cols;
+        points.push_back(Point<double>(m_latOrigin + 1.0 - row*rowSpacing, m_lonOrigin + col*colSpacing, sample));
+        m_heights.push_back(sampleHeight(row, col));
+    }
+
+    m_delaunay.m_order.resize(m_samples.size());
+    for (std::size_t i = 0; i < m_samples.size(); i++) {
+        m_delaunay.m_order[i] = i;
+    }
+    m_delaunay.extractMesh();
+    m_delaunay.releaseCells();
+
+    // (col, row) to (latitude, longitude) is a rotation, the triangles stay counter-clockwise
+    const Mesh<double>& triangulation = m_delaunay.m_mesh;
+    m_mesh.setVertices(std::move(points));
+    m_mesh.resizeTriangles(triangulation.getTriangleCount());
+    for (uint32_t t = 0; t < triangulation.getTriangleCount(); t++) {
+        m_mesh.setTriangle(t, triangulation.getIndex(t, 0), triangulation.getIndex(t, 1), triangulation.getIndex(t, 2));
+        for (unsigned e = 0; e < 3; e++) {
+            m_mesh.setNeighbour(t, e, triangulation.getNeighbour(t, e));
+        }
+    }
+
+    m_queue.clear();
+    m_queue.shrink_to_fit();
+    m_cellVersion.clear();
+    m_cellVersion.shrink_to_fit();
+
+    std::cout << "TinBuilder::build(): " << m_mesh.getVertexCount() << " vertices, " << m_mesh.getTriangleCount()
+              << " triangles, max error " << m_maxError << " m" << std::endl;
+    return true;
+}
+
+bool TinBuilder::insertSample(const int row, const int col)
+{
+    if (not m_delaunay.appendVertex(Point<double>(col, row))) {
+        return false;
+    }
+    m_samples.push_back(uint32_t(row)*m_heightData.cols() + col);
+    return true;
+}
+
+void TinBuilder::scanCell(const int cell)
+{
+    const Delaunay<double>::Cell& triangle = m_delaunay.m_cells[cell];
+    int64_t x[3], y[3];
+    double h[3];
+    for (int i = 0; i < 3; i++) {
+        const Delaunay<double>::Vertex& vertex = m_delaunay.m_vertices[triangle.vertex[i]];
+        x[i] = int64_t(vertex.getX());
+        y[i] = int64_t(vertex.getY());
+        h[i] = sampleHeight(y[i], x[i]);
+    }
+
+    // plane through the corners, h = h0 + dhdx*(x - x0) + dhdy*(y - y0)
+    const double det = double((x[1] - x[0])*(y[2] - y[0]) - (x[2] - x[0])*(y[1] - y[0]));
+    const double dhdx = ((h[1] - h[0])*(y[2] - y[0]) - (h[2] - h[0])*(y[1] - y[0]))/det;
+    const double dhdy = ((h[2] - h[0])*(x[1] - x[0]) - (h[1] - h[0])*(x[2] - x[0]))/det;
+
+    // Samples inside or on the counter-clockwise triangle satisfy a*x + b*y + c >= 0 for all edges
+    int64_t a[3], b[3], c[3];
+    for (int i = 0; i < 3; i++) {
+        const int j = (i + 1) % 3;
+        a[i] = y[i] - y[j];
+        b[i] = x[j] - x[i];
+        c[i] = x[i]*y[j] - x[j]*y[i];
+    }
+
+    Candidate candidate;
+    candidate.error = -1.0;
+    candidate.cell = cell;
+    candidate.version = m_cellVersion[cell];
+    candidate.row = 0;
+    candidate.col = 0;
+
+    const int64_t minY = std::min(y[0], std::min(y[1], y[2]));
+    const int64_t maxY = std::max(y[0], std::max(y[1], y[2]));
+    for (int64_t row = minY; row <= maxY; row++) {
+        int64_t first = std::min(x[0], std::min(x[1], x[2]));
+        int64_t last = std::max(x[0], std::max(x[1], x[2]));
+        for (int i = 0; i < 3; i++) {
+            const int64_t rest = b[i]*row + c[i];
+            if (a[i] > 0) {
+                first = std::max(first, ceilDiv(-rest, a[i]));
+            } else if (a[i] < 0) {
+                last = std::min(last, floorDiv(rest, -a[i]));
+            } else if (rest < 0) {
+                last = first - 1;
+            }
+        }
+
+        const int16_t* samples = m_heightData.rowData(row);
+        const double rowHeight = h[0] + dhdy*(row - y[0]);
+        for (int64_t col = first; col <= last; col++) {
+            if (samples[col] == HgtDecoder::VOID_VALUE) {
+                continue;
+            }
+            const double error = std::fabs(samples[col] - (rowHeight + dhdx*(col - x[0])));
+            if (error > candidate.error) {
+                candidate.error = error;
+                candidate.row = row;
+                candidate.col = col;
+            }
+        }
+    }
+
+    // the corners themselves have no error, a triangle without other samples needs no entry
+    const bool isCorner = (candidate.col == x[0] && candidate.row == y[0]) || (candidate.col == x[1] && candidate.row == y[1])
+                       || (candidate.col == x[2] && candidate.row == y[2]);
+    if (candidate.error <= 0.0 || isCorner) {
+        return;
+    }
+
+    m_queue.push_back(candidate);
+    std::push_heap(m_queue.begin(), m_queue.end());
+}
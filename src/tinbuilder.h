@@ -0,0 +1,102 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 Hans-Peter Schadler <hps@abyle.org>
+**
+** This program is free software: you can redistribute it and/or modify it
+** under the terms of the GNU General Public License as published by the Free
+** Software Foundation, either version 3 of the License, or (at your option)
+** any later version.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT
+** ANY WARRANTY; without even the implied warranty of  MERCHANTABILITY or
+** FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+** more details.
+**
+** You should have received a copy of the GNU General Public License along with
+** this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+****************************************************************************/
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "delaunay.hpp"
+#include "heightraster.h"
+#include "mesh.hpp"
+#include "srtmparser.h"
+
+// Triangulated irregular network of a parsed tile by greedy insertion: the
+// mesh starts with the four tile corners, then the height sample with the
+// largest vertical distance to the mesh is inserted into the Delaunay
+// triangulation until that distance is within the tolerance or the vertex
+// budget is used up. Every triangle keeps its worst sample in a priority
+// queue and only the triangles created by an insertion are scanned again.
+//
+// The mesh vertices are Point(latitude, longitude, id) with id the sample
+// index row*cols + col of the tile, row 0 being the northern border. Void
+// samples are left out. A void tile corner is kept for the coverage and gets
+// the mean height of the closest valid samples.
+class TinBuilder
+{
+public:
+    static const double DEFAULT_TOLERANCE;    // metres
+
+    // srtmParser has to be parsed already
+    explicit TinBuilder(const SRTMParser& srtmParser);
+
+    // Largest vertical error in metres that is accepted
+    void setTolerance(const double tolerance) { m_tolerance = tolerance; }
+    double getTolerance() const { return m_tolerance; }
+
+    // Stop after this many vertices even if the tolerance isn't reached, 0 for no limit
+    void setMaxVertices(const std::size_t maxVertices) { m_maxVertices = maxVertices; }
+    std::size_t getMaxVertices() const { return m_maxVertices; }
+
+    bool build();
+
+    const Mesh<double>& getMesh() const { return m_mesh; }
+
+    // Height of every mesh vertex
+    const std::vector<double>& getHeights() const { return m_heights; }
+
+    // Largest vertical error of the samples against the built mesh
+    double getMaxError() const { return m_maxError; }
+
+private:
+    struct Candidate {
+        double error;
+        int cell;
+        unsigned version;
+        int row;
+        int col;
+
+        bool operator<(const Candidate& other) const { return error < other.error; }
+    };
+
+    bool insertSample(const int row, const int col);
+    void scanCell(const int cell);
+    double sampleHeight(const int row, const int col) const;
+    bool closestHeight(const int row, const int col, double& height) const;
+
+    HeightRaster m_heightData;
+    int m_latOrigin;
+    int m_lonOrigin;
+    double m_cornerHeights[4];    // NW, NE, SW, SE
+
+    double m_tolerance;
+    std::size_t m_maxVertices;
+
+    // triangulation in sample coordinates, x = col and y = row
+    Delaunay<double> m_delaunay;
+    std::vector<unsigned> m_cellVersion;
+    std::vector<Candidate> m_queue;     // heap of the worst sample per triangle
+    std::vector<uint32_t> m_samples;    // sample index of the inserted vertices
+
+    Mesh<double> m_mesh;
+    std::vector<double> m_heights;
+    double m_maxError;
+};
@@ -23,6 +23,7 @@
 #include <iostream>
 
 #include "edge.hpp"
+#include "predicates.hpp"
 
 template <class T, class F>
 class Triangle
@@ -148,10 +149,12 @@ F Triangle<T, F>::getCircumRadius()
 template <class T, class F>
 bool Triangle<T, F>::isInCircle(const T& p)
 {
-    auto center = getCircumCenter();
-
-    F dist = sqrt(   (center.getX() - p.getX())*(center.getX() - p.getX())
-                   + (center.getY() - p.getY())*(center.getY() - p.getY()) );
+    // exact test instead of comparing the rounded distance to the circumcenter with the radius
+    const double orientation = Predicates::orient2d(m_A, m_B, m_C);
+    if (orientation == 0.0) {
+        return false; // degenerate, no circumcircle
+    }
 
-    return dist <= getCircumRadius();
+    const double inCircle = Predicates::incircle(m_A, m_B, m_C, p);
+    return (orientation > 0.0) ? inCircle >= 0.0 : inCircle <= 0.0;
 }
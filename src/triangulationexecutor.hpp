@@ -0,0 +1,232 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 Hans-Peter Schadler <hps@abyle.org>
+**
+** This program is free software: you can redistribute it and/or modify it
+** under the terms of the GNU General Public License as published by the Free
+** Software Foundation, either version 3 of the License, or (at your option)
+** any later version.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT
+** ANY WARRANTY; without even the implied warranty of  MERCHANTABILITY or
+** FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+** more details.
+**
+** You should have received a copy of the GNU General Public License along with
+** this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+****************************************************************************/
+
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "delaunay.hpp"
+#include "gridmesh.hpp"
+#include "mesh.hpp"
+#include "point.hpp"
+
+// Runs independent triangulation jobs, like the segments of an export, on a
+// pool of threads. A job is a point set triangulated by Delaunay or a regular
+// grid meshed by GridMesh. Its source produces the points on the thread
+// which runs the job, so only the jobs in flight hold points, and the result
+// goes to the writer right there. Every worker keeps its Delaunay workspace
+// and buffers for all the jobs it runs, also across run() calls.
+//
+// The jobs are dealt to one queue per worker up front. A worker takes its
+// own jobs from the front and, once it has none left, steals from the back of
+// the others, so jobs of uneven size still keep all workers busy.
+template <class F>
+class TriangulationExecutor
+{
+public:
+    // Fills the points of a job, and the heights if it has them
+    typedef std::function<void(std::vector<Point<F>>& points, std::vector<double>& heights)> Source;
+
+    // Receives the mesh of a job and the heights of its vertices
+    typedef std::function<void(const std::size_t job, const Mesh<F>& mesh, const std::vector<double>& heights)> Writer;
+
+    // threads = 0 uses all hardware threads
+    explicit TriangulationExecutor(const unsigned threads = 0)
+        :m_threads(threads)
+    {}
+
+    void setThreads(const unsigned threads) { m_threads = threads; }
+    unsigned getThreads() const { return m_threads; }
+
+    // Queue a point set to triangulate, returns the index of the job passed to the writer
+    std::size_t addPoints(const Source& source);
+
+    // Queue a grid of rows x cols row-major points, HEIGHT_DIAGONAL needs the heights
+    std::size_t addGrid(const unsigned rows, const unsigned cols, const Source& source,
+                        const typename GridMesh<F>::DiagonalType diagonalType = GridMesh<F>::FORWARD_DIAGONAL);
+
+    std::size_t getJobCount() const { return m_jobs.size(); }
+
+    // Runs the queued jobs and empties the queue. The writer is called on the worker threads,
+    // for several jobs at the same time. Returns the number of failed jobs, those aren't written.
+    std::size_t run(const Writer& writer);
+
+    // Bytes kept by the workers between the runs
+    std::size_t getMemoryUsage() const;
+
+private:
+    struct Job {
+        Source source;
+        unsigned rows;          // 0 for a point set
+        unsigned cols;
+        typename GridMesh<F>::DiagonalType diagonalType;
+    };
+
+    struct Worker {
+        typename Delaunay<F>::Workspace workspace;
+        Delaunay<F> delaunay;
+        Mesh<F> gridMesh;
+        std::vector<Point<F>> points;
+        std::vector<double> heights;
+        std::deque<std::size_t> queue;
+        std::mutex mutex;
+    };
+
+    bool nextJob(const unsigned worker, const unsigned workerCount, std::size_t& job);
+    bool runJob(Worker& worker, const std::size_t job, const Writer& writer);
+
+    unsigned m_threads;
+    std::vector<Job> m_jobs;
+    std::vector<std::unique_ptr<Worker>> m_workers;
+};
+
+template <class F>
+std::size_t TriangulationExecutor<F>::addPoints(const Source& source)
+{
+    Job job;
+    job.source = source;
+    job.rows = 0;
+    job.cols = 0;
+    job.diagonalType = GridMesh<F>::FORWARD_DIAGONAL;
+    m_jobs.push_back(job);
+    return m_jobs.size() - 1;
+}
+
+template <class F>
+std::size_t TriangulationExecutor<F>::addGrid(const unsigned rows, const unsigned cols, const Source& source,
+                                              const typename GridMesh<F>::DiagonalType diagonalType)
+{
+    Job job;
+    job.source = source;
+    job.rows = rows;
+    job.cols = cols;
+    job.diagonalType = diagonalType;
+    m_jobs.push_back(job);
+    return m_jobs.size() - 1;
+}
+
+template <class F>
+std::size_t TriangulationExecutor<F>::run(const Writer& writer)
+{
+    if (m_jobs.empty()) {
+        return 0;
+    }
+
+    unsigned threads = m_threads;
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    const unsigned workerCount = std::min<std::size_t>(threads, m_jobs.size());
+    while (m_workers.size() < workerCount) {
+        m_workers.push_back(std::unique_ptr<Worker>(new Worker()));
+    }
+    for (std::size_t job = 0; job < m_jobs.size(); job++) {
+        m_workers[job % workerCount]->queue.push_back(job);
+    }
+
+    std::atomic<std::size_t> failed(0);
+    auto work = [&](const unsigned w) {
+        std::size_t job = 0;
+        while (nextJob(w, workerCount, job)) {
+            if (not runJob(*m_workers[w], job, writer)) {
+                failed++;
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned w = 1; w < workerCount; w++) {
+        workers.push_back(std::thread(work, w));
+    }
+    work(0);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    m_jobs.clear();
+    return failed;
+}
+
+template <class F>
+bool TriangulationExecutor<F>::nextJob(const unsigned worker, const unsigned workerCount, std::size_t& job)
+{
+    // No jobs are added during a run, once all queues are empty they stay empty
+    for (unsigned k = 0; k < workerCount; k++) {
+        Worker& victim = *m_workers[(worker + k) % workerCount];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (victim.queue.empty()) {
+            continue;
+        }
+        if (k == 0) {
+            job = victim.queue.front();
+            victim.queue.pop_front();
+        } else {
+            job = victim.queue.back();
+            victim.queue.pop_back();
+        }
+        return true;
+    }
+    return false;
+}
+
+template <class F>
+bool TriangulationExecutor<F>::runJob(Worker& worker, const std::size_t job, const Writer& writer)
+{
+    const Job& description = m_jobs[job];
+    worker.points.clear();
+    worker.heights.clear();
+    description.source(worker.points, worker.heights);
+
+    if (description.rows > 0) {
+        if (not GridMesh<F>::build(worker.points, description.rows, description.cols, worker.gridMesh,
+                                   description.diagonalType, worker.heights)) {
+            return false;
+        }
+        writer(job, worker.gridMesh, worker.heights);
+        return true;
+    }
+
+    worker.delaunay.setWorkspace(&worker.workspace);
+    worker.delaunay.setPoints(worker.points);
+    worker.delaunay.triangulate();
+    writer(job, worker.delaunay.getMesh(), worker.heights);
+    return true;
+}
+
+template <class F>
+std::size_t TriangulationExecutor<F>::getMemoryUsage() const
+{
+    std::size_t bytes = 0;
+    for (const auto& worker : m_workers) {
+        bytes += worker->workspace.getMemoryUsage()
+               + worker->delaunay.getMesh().getMemoryUsage()
+               + worker->gridMesh.getMemoryUsage()
+               + worker->points.capacity()*sizeof(Point<F>)
+               + worker->heights.capacity()*sizeof(double);
+    }
+    return bytes;
+}
@@ -0,0 +1,144 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 Hans-Peter Schadler <hps@abyle.org>
+**
+** This program is free software: you can redistribute it and/or modify it
+** under the terms of the GNU General Public License as published by the Free
+** Software Foundation, either version 3 of the License, or (at your option)
+** any later version.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT
+** ANY WARRANTY; without even the implied warranty of  MERCHANTABILITY or
+** FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+** more details.
+**
+** You should have received a copy of the GNU General Public License along with
+** this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+****************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <iostream>
+#include <vector>
+
+#include "point.hpp"
+#include "point2.hpp"
+
+// Vertices as structure of arrays: the x, y and z coordinates and the ids each
+// in an array of their own, vertex i is (xs[i], ys[i], zs[i]) with ids[i]. A
+// pass over one coordinate reads only that array, loops over xs and ys
+// vectorise and nothing is padded. The arrays are exposed without copying.
+template <class T>
+class VertexBuffer
+{
+public:
+    VertexBuffer() {}
+
+    // The points with their ids, heights are the z coordinates or all 0 if empty
+    explicit VertexBuffer(const std::vector<Point<T>>& points, const std::vector<double>& heights = std::vector<double>()) {
+        assign(points, heights);
+    }
+
+    bool assign(const std::vector<Point<T>>& points, const std::vector<double>& heights = std::vector<double>());
+
+    std::size_t size() const { return m_xs.size(); }
+    bool empty() const { return m_xs.empty(); }
+
+    void clear() {
+        m_xs.clear();
+        m_ys.clear();
+        m_zs.clear();
+        m_ids.clear();
+    }
+
+    void reserve(const std::size_t count) {
+        m_xs.reserve(count);
+        m_ys.reserve(count);
+        m_zs.reserve(count);
+        m_ids.reserve(count);
+    }
+
+    // New vertices are at the origin with id 0
+    void resize(const std::size_t count) {
+        m_xs.resize(count, T(0));
+        m_ys.resize(count, T(0));
+        m_zs.resize(count, T(0));
+        m_ids.resize(count, 0);
+    }
+
+    void add(const T x, const T y, const T z, const unsigned id) {
+        m_xs.push_back(x);
+        m_ys.push_back(y);
+        m_zs.push_back(z);
+        m_ids.push_back(id);
+    }
+
+    void add(const Point<T>& point, const T z = T(0)) {
+        add(point.getX(), point.getY(), z, point.getId());
+    }
+
+    T getX(const std::size_t i) const { return m_xs[i]; }
+    T getY(const std::size_t i) const { return m_ys[i]; }
+    T getZ(const std::size_t i) const { return m_zs[i]; }
+    unsigned getId(const std::size_t i) const { return m_ids[i]; }
+
+    Point<T> getPoint(const std::size_t i) const { return Point<T>(m_xs[i], m_ys[i], m_ids[i]); }
+    Point2<T> getPoint2(const std::size_t i) const { return Point2<T>(m_xs[i], m_ys[i]); }
+
+    // The vertices as points with their ids, the z coordinates are dropped
+    std::vector<Point<T>> toPoints() const;
+
+    const std::vector<T>& getXs() const { return m_xs; }
+    const std::vector<T>& getYs() const { return m_ys; }
+    const std::vector<T>& getZs() const { return m_zs; }
+    const std::vector<unsigned>& getIds() const { return m_ids; }
+
+    std::vector<T>& getXs() { return m_xs; }
+    std::vector<T>& getYs() { return m_ys; }
+    std::vector<T>& getZs() { return m_zs; }
+    std::vector<unsigned>& getIds() { return m_ids; }
+
+private:
+    std::vector<T> m_xs;
+    std::vector<T> m_ys;
+    std::vector<T> m_zs;
+    std::vector<unsigned> m_ids;
+};
+
+template <class T>
+bool VertexBuffer<T>::assign(const std::vector<Point<T>>& points, const std::vector<double>& heights)
+{
+    clear();
+    if (not heights.empty() && heights.size() != points.size()) {
+        std::cerr << "VertexBuffer::assign(): " << heights.size() << " heights for " << points.size() << " points" << std::endl;
+        return false;
+    }
+
+    const std::size_t count = points.size();
+    m_xs.resize(count);
+    m_ys.resize(count);
+    m_zs.resize(count);
+    m_ids.resize(count);
+    for (std::size_t i = 0; i < count; i++) {
+        m_xs[i] = points[i].getX();
+        m_ys[i] = points[i].getY();
+        m_ids[i] = points[i].getId();
+    }
+    for (std::size_t i = 0; i < count; i++) {
+        m_zs[i] = heights.empty() ? T(0) : T(heights[i]);
+    }
+    return true;
+}
+
+template <class T>
+std::vector<Point<T>> VertexBuffer<T>::toPoints() const
+{
+    std::vector<Point<T>> points;
+    points.reserve(size());
+    for (std::size_t i = 0; i < size(); i++) {
+        points.push_back(Point<T>(m_xs[i], m_ys[i], m_ids[i]));
+    }
+    return points;
+}
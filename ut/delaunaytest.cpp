@@ -19,7 +19,107 @@
 
 #include <catch.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <set>
+#include <utility>
+#include <vector>
+
 #include <delaunay.hpp>
+#include <predicates.hpp>
+#include <testutils.h>
+
+namespace {
+    template <class F>
+    double signedArea(const Triangle<Point<F>, F>& triangle)
+    {
+        return 0.5*((triangle.getB().getX() - triangle.getA().getX())*(triangle.getC().getY() - triangle.getA().getY())
+                  - (triangle.getB().getY() - triangle.getA().getY())*(triangle.getC().getX() - triangle.getA().getX()));
+    }
+
+    template <class F>
+    std::vector<std::pair<F, F>> sortedCorners(const Triangle<Point<F>, F>& triangle)
+    {
+        std::vector<std::pair<F, F>> corners = { { triangle.getA().getX(), triangle.getA().getY() },
+                                                 { triangle.getB().getX(), triangle.getB().getY() },
+                                                 { triangle.getC().getX(), triangle.getC().getY() } };
+        std::sort(corners.begin(), corners.end());
+        return corners;
+    }
+    // Every triangle is Delaunay with respect to its neighbours, which makes the whole mesh Delaunay
+    template <class F>
+    bool isLocallyDelaunay(const Mesh<F>& mesh)
+    {
+        for (uint32_t t = 0; t < mesh.getTriangleCount(); t++) {
+            if (Predicates::orient2d(mesh.getCorner(t, 0), mesh.getCorner(t, 1), mesh.getCorner(t, 2)) <= 0) {
+                return false;
+            }
+            for (unsigned e = 0; e < 3; e++) {
+                const int32_t n = mesh.getNeighbour(t, e);
+                if (n == Mesh<F>::NO_NEIGHBOUR) {
+                    continue;
+                }
+                for (unsigned c = 0; c < 3; c++) {
+                    if (Predicates::incircle(mesh.getCorner(t, 0), mesh.getCorner(t, 1), mesh.getCorner(t, 2), mesh.getCorner(n, c)) > 0) {
+                        return false;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+    // Like isLocallyDelaunay(), but a constraint may have the opposite vertex inside the circumcircle
+    template <class F>
+    bool isConstrainedDelaunay(const Delaunay<F>& delaunay)
+    {
+        const Mesh<F>& mesh = delaunay.getMesh();
+        for (uint32_t t = 0; t < mesh.getTriangleCount(); t++) {
+            if (Predicates::orient2d(mesh.getCorner(t, 0), mesh.getCorner(t, 1), mesh.getCorner(t, 2)) <= 0) {
+                return false;
+            }
+            for (unsigned e = 0; e < 3; e++) {
+                const int32_t n = mesh.getNeighbour(t, e);
+                if (n == Mesh<F>::NO_NEIGHBOUR || delaunay.isConstrainedEdge(t, e)) {
+                    continue;
+                }
+                for (unsigned c = 0; c < 3; c++) {
+                    if (Predicates::incircle(mesh.getCorner(t, 0), mesh.getCorner(t, 1), mesh.getCorner(t, 2), mesh.getCorner(n, c)) > 0) {
+                        return false;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+    template <class F>
+    bool hasEdge(const Mesh<F>& mesh, const uint32_t a, const uint32_t b)
+    {
+        for (uint32_t t = 0; t < mesh.getTriangleCount(); t++) {
+            for (unsigned e = 0; e < 3; e++) {
+                const uint32_t from = mesh.getIndex(t, (e + 1) % 3);
+                const uint32_t to = mesh.getIndex(t, (e + 2) % 3);
+                if ((from == a && to == b) || (from == b && to == a)) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    template <class F>
+    double meshArea(const Mesh<F>& mesh)
+    {
+        double area = 0.0;
+        for (uint32_t t = 0; t < mesh.getTriangleCount(); t++) {
+            area += signedArea(mesh.getTriangle(t));
+        }
+        return area;
+    }
+
+}
 
 TEST_CASE( "Delaunay Class tests", "[delaunay]" ) {
     SECTION("Delaunay triangulation - one triangle") {
@@ -60,12 +160,661 @@ TEST_CASE( "Delaunay Class tests", "[delaunay]" ) {
 
         REQUIRE(triangles.size() == 2);
 
-        REQUIRE( triangles[0].getA() == Point<float>(0.0f, 0.0f) );
-        REQUIRE( triangles[0].getB() == Point<float>(0.0f, 1.0f) );
-        REQUIRE( triangles[0].getC() == Point<float>(1.0f, 1.0f) );
+        // split along the diagonal (0,0)-(1,1), in any order and rotation
+        std::vector<std::vector<std::pair<float, float>>> corners;
+        for (auto& triangle : triangles) {
+            REQUIRE( signedArea(triangle) > 0 );
+            corners.push_back(sortedCorners(triangle));
+        }
+        std::sort(corners.begin(), corners.end());
+
+        REQUIRE( corners[0] == (std::vector<std::pair<float, float>>{ {0.0f, 0.0f}, {0.0f, 1.0f}, {1.0f, 1.0f} }) );
+        REQUIRE( corners[1] == (std::vector<std::pair<float, float>>{ {0.0f, 0.0f}, {1.0f, 0.0f}, {1.0f, 1.0f} }) );
+    }
+
+    SECTION("Delaunay triangulation - random points") {
+        std::vector<Point<double>> points;
+        unsigned state = 12345;
+        for (unsigned id = 1; id <= 400; id++) {
+            state = state*1103515245u + 12345u;
+            double x = (state >> 8) % 10000 / 100.0;
+            state = state*1103515245u + 12345u;
+            double y = (state >> 8) % 10000 / 100.0;
+            points.push_back({ x, y, id });
+        }
+
+        Delaunay<double> delaunay(points);
+        delaunay.triangulate();
+        auto triangles = delaunay.getTriangles();
+
+        REQUIRE( triangles.size() > points.size() );
+        for (auto& triangle : triangles) {
+            REQUIRE( signedArea(triangle) > 0 );
+
+            // no point inside the circumcircle, up to the rounding of center and radius
+            auto center = triangle.getCircumCenter();
+            double radius = triangle.getCircumRadius();
+            for (auto& point : points) {
+                double distance = std::hypot(point.getX() - center.getX(), point.getY() - center.getY());
+                REQUIRE( distance >= radius*(1.0 - 1e-9) );
+            }
+        }
+    }
+
+    SECTION("Delaunay triangulation - regular grid") {
+        const int size = 40;
+        std::vector<Point<double>> points;
+        unsigned id = 0;
+        for (int row = 0; row < size; row++) {
+            for (int col = 0; col < size; col++) {
+                points.push_back({ double(row), double(col), ++id });
+            }
+        }
+        // duplicates are skipped
+        points.push_back({ 3.0, 4.0, ++id });
+
+        Delaunay<double> delaunay(points);
+        delaunay.triangulate();
+        auto triangles = delaunay.getTriangles();
+
+        // two triangles per cell covering the whole grid
+        REQUIRE( triangles.size() == 2*(size - 1)*(size - 1) );
+        double area = 0.0;
+        for (auto& triangle : triangles) {
+            REQUIRE( signedArea(triangle) > 0 );
+            area += signedArea(triangle);
+        }
+        REQUIRE( area == Approx((size - 1)*(size - 1)) );
+    }
+
+    SECTION("Delaunay triangulation - cocircular points") {
+        // every point falls into the circumcircle of almost all triangles, the cavities span the whole disc
+        const unsigned count = 300;
+        const double pi = std::acos(-1.0);
+        std::vector<Point<double>> points;
+        for (unsigned i = 0; i < count; i++) {
+            points.push_back({ 100.0*std::cos(2*pi*i/count), 100.0*std::sin(2*pi*i/count), i });
+        }
+        points.push_back({ 0.0, 0.0, count });
+
+        Delaunay<double> delaunay(points);
+        delaunay.triangulate();
+        const Mesh<double>& mesh = delaunay.getMesh();
+
+        // one interior point, all others on the hull
+        REQUIRE( mesh.getTriangleCount() == count );
+        double area = 0.0;
+        for (uint32_t t = 0; t < mesh.getTriangleCount(); t++) {
+            const double triangleArea = signedArea(mesh.getTriangle(t));
+            REQUIRE( triangleArea > 0 );
+            area += triangleArea;
+            for (unsigned e = 0; e < 3; e++) {
+                const int32_t n = mesh.getNeighbour(t, e);
+                REQUIRE( (n == Mesh<double>::NO_NEIGHBOUR || (n >= 0 && uint32_t(n) < mesh.getTriangleCount())) );
+            }
+        }
+        REQUIRE( area == Approx(0.5*count*100.0*100.0*std::sin(2*pi/count)) );
+    }
+
+    SECTION("Delaunay triangulation - degenerate lattice points") {
+        // many collinear, cocircular and duplicate points
+        std::vector<Point<double>> points;
+        unsigned state = 777;
+        for (unsigned id = 0; id < 300; id++) {
+            state = state*1103515245u + 12345u;
+            double x = (state >> 8) % 12;
+            state = state*1103515245u + 12345u;
+            double y = (state >> 8) % 12;
+            points.push_back({ 1000.0 + x/4.0, -2000.0 + y/4.0, id });
+        }
+
+        Delaunay<double> delaunay(points);
+        delaunay.triangulate();
+        const Mesh<double>& mesh = delaunay.getMesh();
+
+        REQUIRE( mesh.getTriangleCount() > 0 );
+        for (uint32_t t = 0; t < mesh.getTriangleCount(); t++) {
+            REQUIRE( Predicates::orient2d(mesh.getCorner(t, 0), mesh.getCorner(t, 1), mesh.getCorner(t, 2)) > 0 );
+            for (auto& point : points) {
+                REQUIRE( Predicates::incircle(mesh.getCorner(t, 0), mesh.getCorner(t, 1), mesh.getCorner(t, 2), point) <= 0 );
+            }
+        }
+    }
+
+    SECTION("Delaunay triangulation - float and double agree") {
+        const int size = 25;
+        std::vector<Point<float>> floatPoints;
+        std::vector<Point<double>> doublePoints;
+        unsigned id = 0;
+        for (int row = 0; row < size; row++) {
+            for (int col = 0; col < size; col++) {
+                // SRTM like spacing, exactly representable in float
+                const float x = 15.0f + col/128.0f;
+                const float y = 47.0f + row/128.0f;
+                floatPoints.push_back({ x, y, id });
+                doublePoints.push_back({ double(x), double(y), id });
+                id++;
+            }
+        }
+
+        Delaunay<float> floatDelaunay(floatPoints);
+        floatDelaunay.triangulate();
+        Delaunay<double> doubleDelaunay(doublePoints);
+        doubleDelaunay.triangulate();
+
+        REQUIRE( floatDelaunay.getMesh().getTriangleCount() == 2*(size - 1)*(size - 1) );
+        REQUIRE( floatDelaunay.getMesh().getIndices() == doubleDelaunay.getMesh().getIndices() );
+    }
+
+    SECTION("Delaunay triangulation - double keeps its precision") {
+        // closer than float resolves at 1000, in float all four points would be the same
+        const double d = 1e-6;
+        std::vector<Point<double>> points { { 1000.0, 1000.0, 0 },
+                                            { 1000.0 + d, 1000.0, 1 },
+                                            { 1000.0 + d, 1000.0 + d, 2 },
+                                            { 1000.0, 1000.0 + d, 3 } };
+        Delaunay<double> delaunay(points);
+        delaunay.triangulate();
+
+        REQUIRE( delaunay.getMesh().getTriangleCount() == 2 );
+        REQUIRE( delaunay.getMesh().getVertices()[1].getX() == 1000.0 + d );
+        for (auto& triangle : delaunay.getTriangles()) {
+            REQUIRE( signedArea(triangle) > 0 );
+        }
+    }
+
+    SECTION("Delaunay triangulation - strips in parallel, random points") {
+        std::vector<Point<double>> points;
+        unsigned state = 4242;
+        for (unsigned id = 0; id < 4*Delaunay<double>::MIN_STRIP_SIZE; id++) {
+            state = state*1103515245u + 12345u;
+            double x = (state >> 4) % 1000000 / 1000.0;
+            state = state*1103515245u + 12345u;
+            double y = (state >> 4) % 1000000 / 1000.0;
+            points.push_back({ x, y, id });
+        }
+
+        Delaunay<double> serial(points);
+        serial.triangulate();
+
+        Delaunay<double> parallel(points);
+        parallel.setThreads(4);
+        REQUIRE( parallel.getThreads() == 4 );
+        parallel.triangulate();
+        const Mesh<double>& mesh = parallel.getMesh();
+
+        REQUIRE( TestUtils::triangleSet(mesh) == TestUtils::triangleSet(serial.getMesh()) );
+        REQUIRE( isLocallyDelaunay(mesh) );
+
+        Mesh<double> rebuilt = mesh;
+        rebuilt.buildAdjacency();
+        REQUIRE( rebuilt.getNeighbours() == mesh.getNeighbours() );
+    }
+
+    SECTION("Delaunay triangulation - strips in parallel, regular grid") {
+        const int size = 200;
+        std::vector<Point<double>> points;
+        unsigned id = 0;
+        for (int row = 0; row < size; row++) {
+            for (int col = 0; col < size; col++) {
+                points.push_back({ double(col), double(row), id++ });
+            }
+        }
+
+        Delaunay<double> delaunay(points);
+        delaunay.setThreads(4);
+        delaunay.triangulate();
+        const Mesh<double>& mesh = delaunay.getMesh();
+
+        // the cocircular cells may be split the other way than in one piece, the count and area can't change
+        REQUIRE( mesh.getTriangleCount() == 2*(size - 1)*(size - 1) );
+        double area = 0.0;
+        for (uint32_t t = 0; t < mesh.getTriangleCount(); t++) {
+            area += signedArea(mesh.getTriangle(t));
+        }
+        REQUIRE( area == Approx((size - 1)*(size - 1)) );
+        REQUIRE( isLocallyDelaunay(mesh) );
+
+        Mesh<double> rebuilt = mesh;
+        rebuilt.buildAdjacency();
+        REQUIRE( rebuilt.getNeighbours() == mesh.getNeighbours() );
+    }
+
+    SECTION("Delaunay triangulation - strips in parallel, a column of equal x") {
+        // more than half of the right side shares x = 5, the split there leaves a strip empty
+        std::vector<Point<double>> points;
+        unsigned state = 777;
+        auto random = [&state]() {
+            state = state*1103515245u + 12345u;
+            return (state >> 4)/double(1u << 28);
+        };
+        for (unsigned id = 0; id < 40000; id++) {
+            const double x = (id < 12000) ? random() : (id < 28000) ? 5.0 : 5.0 + 1e-3 + random();
+            points.push_back({ x, 100.0*random(), id });
+        }
+
+        Delaunay<double> serial(points);
+        serial.triangulate();
+
+        Delaunay<double> parallel(points);
+        parallel.setThreads(4);
+        parallel.triangulate();
+
+        REQUIRE( TestUtils::triangleSet(parallel.getMesh()) == TestUtils::triangleSet(serial.getMesh()) );
+        REQUIRE( isLocallyDelaunay(parallel.getMesh()) );
+    }
+
+    SECTION("Delaunay triangulation - strips in parallel, triangles at the hull") {
+        // the super triangle of a strip keeps a sliver at the hull which the one of all points removes
+        std::vector<Point<double>> points;
+        unsigned state = 2;
+        auto random = [&state]() {
+            state = state*1103515245u + 12345u;
+            return (state >> 4)/double(1u << 28);
+        };
+        for (unsigned id = 0; id < 20000; id++) {
+            const double x = random();
+            points.push_back({ x, random(), id });
+        }
+
+        Delaunay<double> serial(points);
+        serial.triangulate();
+
+        Delaunay<double> parallel(points);
+        parallel.setThreads(4);
+        parallel.triangulate();
+
+        REQUIRE( TestUtils::triangleSet(parallel.getMesh()) == TestUtils::triangleSet(serial.getMesh()) );
+        REQUIRE( isLocallyDelaunay(parallel.getMesh()) );
+    }
+
+    SECTION("Delaunay triangulation - strips in parallel, collinear strips") {
+        // three columns, every strip holds a single column and has no triangle of its own
+        const unsigned rows = Delaunay<double>::MIN_STRIP_SIZE;
+        std::vector<Point<double>> points;
+        for (unsigned row = 0; row < rows; row++) {
+            for (unsigned col = 0; col < 3; col++) {
+                points.push_back({ double(col), double(row), row*3 + col });
+            }
+        }
+
+        Delaunay<double> delaunay(points);
+        delaunay.setThreads(3);
+        delaunay.triangulate();
+
+        REQUIRE( delaunay.getMesh().getTriangleCount() == 4*(rows - 1) );
+        REQUIRE( isLocallyDelaunay(delaunay.getMesh()) );
+    }
+
+    SECTION("Constrained Delaunay triangulation - constraints through a grid") {
+        const unsigned size = 20;
+        std::vector<Point<double>> points;
+        for (unsigned row = 0; row < size; row++) {
+            for (unsigned col = 0; col < size; col++) {
+                points.push_back({ double(row), double(col), row*size + col });
+            }
+        }
+
+        // the first one passes no other point, the second one is split at every third row
+        Delaunay<double> delaunay(points);
+        delaunay.setConstraints({ { 0, 19*size + 6 }, { 19, 18*size + 13 } });
+        delaunay.triangulate();
+        const Mesh<double>& mesh = delaunay.getMesh();
+
+        REQUIRE( mesh.getTriangleCount() == 2*(size - 1)*(size - 1) );
+        REQUIRE( meshArea(mesh) == Approx((size - 1)*(size - 1)) );
+        REQUIRE( isConstrainedDelaunay(delaunay) );
+
+        REQUIRE( hasEdge(mesh, 0, 19*size + 6) );
+        for (unsigned k = 0; k < 6; k++) {
+            REQUIRE( hasEdge(mesh, 3*k*size + 19 - k, 3*(k + 1)*size + 18 - k) );
+        }
+
+        unsigned constrained = 0;
+        for (uint32_t t = 0; t < mesh.getTriangleCount(); t++) {
+            for (unsigned e = 0; e < 3; e++) {
+                constrained += delaunay.isConstrainedEdge(t, e);
+            }
+        }
+        REQUIRE( constrained == 2*(1 + 6) );
+
+        Mesh<double> rebuilt = mesh;
+        rebuilt.buildAdjacency();
+        REQUIRE( rebuilt.getNeighbours() == mesh.getNeighbours() );
+    }
+
+    SECTION("Constrained Delaunay triangulation - hole and outside removed") {
+        // L shaped boundary with a square hole, the random points cover the bounding box
+        std::vector<Point<double>> points { { 0, 0, 0 }, { 10, 0, 1 }, { 10, 5, 2 }, { 5, 5, 3 }, { 5, 10, 4 }, { 0, 10, 5 },
+                                            { 2, 2, 6 }, { 4, 2, 7 }, { 4, 4, 8 }, { 2, 4, 9 } };
+        unsigned state = 777;
+        for (unsigned id = 10; id < 400; id++) {
+            state = state*1103515245u + 12345u;
+            double x = (state >> 8) % 10000 / 1000.0;
+            state = state*1103515245u + 12345u;
+            double y = (state >> 8) % 10000 / 1000.0;
+            points.push_back({ x, y, id });
+        }
+
+        Delaunay<double> delaunay(points);
+        delaunay.setConstraints({ { 0, 1 }, { 1, 2 }, { 2, 3 }, { 3, 4 }, { 4, 5 }, { 5, 0 },
+                                  { 6, 7 }, { 7, 8 }, { 8, 9 }, { 9, 6 } });
+        delaunay.setHoles({ { 3.0, 3.0 } });
+        delaunay.setRemoveOutside(true);
+        delaunay.triangulate();
+        const Mesh<double>& mesh = delaunay.getMesh();
+
+        REQUIRE( meshArea(mesh) == Approx(75.0 - 4.0) );
+        REQUIRE( isConstrainedDelaunay(delaunay) );
+        for (uint32_t t = 0; t < mesh.getTriangleCount(); t++) {
+            const Triangle<Point<double>, double> triangle = mesh.getTriangle(t);
+            const double x = (triangle.getA().getX() + triangle.getB().getX() + triangle.getC().getX())/3;
+            const double y = (triangle.getA().getY() + triangle.getB().getY() + triangle.getC().getY())/3;
+            REQUIRE( (x < 5 || y < 5) );
+            REQUIRE( not (x > 2 && x < 4 && y > 2 && y < 4) );
+        }
+
+        Mesh<double> rebuilt = mesh;
+        rebuilt.buildAdjacency();
+        REQUIRE( rebuilt.getNeighbours() == mesh.getNeighbours() );
+    }
+
+    SECTION("Constrained Delaunay triangulation - crossing constraint skipped") {
+        std::vector<Point<double>> points { { 0, 0, 0 }, { 1, 0, 1 }, { 1, 1, 2 }, { 0, 1, 3 } };
+
+        Delaunay<double> delaunay(points);
+        delaunay.setSpatialSort(false);
+        delaunay.setConstraints({ { 1, 3 }, { 0, 2 } });
+        delaunay.triangulate();
+        const Mesh<double>& mesh = delaunay.getMesh();
+
+        REQUIRE( mesh.getTriangleCount() == 2 );
+        REQUIRE( hasEdge(mesh, 1, 3) );
+        REQUIRE( not hasEdge(mesh, 0, 2) );
+
+        // the second constraint passes a point before the crossing, its first piece is not kept either
+        std::vector<Point<double>> collinear { { -2, 0, 0 }, { 0, 0, 1 }, { 3, 0, 2 }, { 1, -1, 3 }, { 1, 1, 4 },
+                                               { -3, -2, 5 }, { 4, -2, 6 }, { 4, 2, 7 }, { -3, 2, 8 } };
+        Delaunay<double> skipped(collinear);
+        skipped.setConstraints({ { 3, 4 }, { 0, 2 } });
+        skipped.triangulate();
+        const Mesh<double>& skippedMesh = skipped.getMesh();
+
+        REQUIRE( hasEdge(skippedMesh, 3, 4) );
+        unsigned constrained = 0;
+        for (uint32_t t = 0; t < skippedMesh.getTriangleCount(); t++) {
+            for (unsigned e = 0; e < 3; e++) {
+                constrained += skipped.isConstrainedEdge(t, e);
+            }
+        }
+        REQUIRE( constrained == 2 );
+        REQUIRE( isConstrainedDelaunay(skipped) );
+    }
+
+    SECTION("Constrained Delaunay triangulation - neighbouring segments share their border") {
+        // two segments with the points on the common border, each one bounded by its corners only
+        std::vector<Point<double>> left { { 0, 0, 0 }, { 1, 0, 1 }, { 1, 1, 2 }, { 0, 1, 3 } };
+        std::vector<Point<double>> right { { 1, 0, 0 }, { 2, 0, 1 }, { 2, 1, 2 }, { 1, 1, 3 } };
+        for (unsigned k = 1; k < 10; k++) {
+            left.push_back({ 1.0, k/10.0, unsigned(left.size()) });
+            right.push_back({ 1.0, k/10.0, unsigned(right.size()) });
+        }
+        unsigned state = 99;
+        for (unsigned i = 0; i < 200; i++) {
+            state = state*1103515245u + 12345u;
+            double x = 0.01 + (state >> 8) % 980 / 1000.0;
+            state = state*1103515245u + 12345u;
+            double y = 0.01 + (state >> 8) % 980 / 1000.0;
+            left.push_back({ x, y, unsigned(left.size()) });
+            right.push_back({ 2.0 - x, y, unsigned(right.size()) });
+        }
+
+        std::vector<std::set<std::pair<double, double>>> borders;
+        for (auto* points : { &left, &right }) {
+            Delaunay<double> delaunay(*points);
+            delaunay.setConstraints({ { 0, 1 }, { 1, 2 }, { 2, 3 }, { 3, 0 } });
+            delaunay.setRemoveOutside(true);
+            delaunay.triangulate();
+            const Mesh<double>& mesh = delaunay.getMesh();
+            REQUIRE( meshArea(mesh) == Approx(1.0) );
+            REQUIRE( isConstrainedDelaunay(delaunay) );
+
+            std::set<std::pair<double, double>> border;
+            for (uint32_t t = 0; t < mesh.getTriangleCount(); t++) {
+                for (unsigned e = 0; e < 3; e++) {
+                    const Point<double>& from = mesh.getCorner(t, (e + 1) % 3);
+                    const Point<double>& to = mesh.getCorner(t, (e + 2) % 3);
+                    if (from.getX() == 1.0 && to.getX() == 1.0) {
+                        REQUIRE( delaunay.isConstrainedEdge(t, e) );
+                        border.insert(std::make_pair(std::min(from.getY(), to.getY()), std::max(from.getY(), to.getY())));
+                    }
+                }
+            }
+            borders.push_back(border);
+        }
+
+        REQUIRE( borders[0].size() == 10 );
+        REQUIRE( borders[0] == borders[1] );
+    }
+
+    SECTION("Delaunay triangulation - workspace reused across triangulations") {
+        Delaunay<double>::Workspace workspace;
+        REQUIRE( workspace.getMemoryUsage() == 0 );
+
+        std::size_t memory = 0;
+        unsigned state = 31;
+        for (unsigned segment = 0; segment < 3; segment++) {
+            std::vector<Point<double>> points;
+            for (unsigned id = 0; id < 2000; id++) {
+                state = state*1103515245u + 12345u;
+                double x = segment + (state >> 8) % 10000 / 10000.0;
+                state = state*1103515245u + 12345u;
+                double y = (state >> 8) % 10000 / 10000.0;
+                points.push_back({ x, y, id });
+            }
+
+            Delaunay<double> reference(points);
+            reference.triangulate();
+
+            Delaunay<double> delaunay(points);
+            delaunay.setWorkspace(&workspace);
+            REQUIRE( delaunay.getWorkspace() == &workspace );
+            delaunay.triangulate();
+
+            REQUIRE( delaunay.getMesh().getIndices() == reference.getMesh().getIndices() );
+            REQUIRE( delaunay.getMesh().getNeighbours() == reference.getMesh().getNeighbours() );
+
+            // the buffers stay in the workspace, segments of the same size need no more memory
+            if (segment == 0) {
+                memory = workspace.getMemoryUsage();
+                REQUIRE( memory > 0 );
+            }
+            REQUIRE( workspace.getMemoryUsage() == memory );
+        }
+
+        workspace.release();
+        REQUIRE( workspace.getMemoryUsage() == 0 );
+    }
+
+    SECTION("Delaunay triangulation - workspace for strips in parallel") {
+        std::vector<Point<double>> points;
+        unsigned state = 77;
+        for (unsigned id = 0; id < 2*Delaunay<double>::MIN_STRIP_SIZE; id++) {
+            state = state*1103515245u + 12345u;
+            double x = (state >> 4) % 1000000 / 1000.0;
+            state = state*1103515245u + 12345u;
+            double y = (state >> 4) % 1000000 / 1000.0;
+            points.push_back({ x, y, id });
+        }
+
+        Delaunay<double> serial(points);
+        serial.triangulate();
+
+        Delaunay<double>::Workspace workspace;
+        for (unsigned run = 0; run < 2; run++) {
+            Delaunay<double> parallel(points);
+            parallel.setThreads(2);
+            parallel.setWorkspace(&workspace);
+            parallel.triangulate();
+            REQUIRE( TestUtils::triangleSet(parallel.getMesh()) == TestUtils::triangleSet(serial.getMesh()) );
+            REQUIRE( workspace.getMemoryUsage() > 0 );
+        }
+    }
+
+    SECTION("Delaunay triangulation - editing, insert and remove points") {
+        // the corners fix the bounds and with them the super triangle
+        std::vector<Point<double>> points { { 0, 0, 0 }, { 100, 0, 1 }, { 0, 100, 2 }, { 100, 100, 3 } };
+        unsigned state = 4711;
+        auto randomPoint = [&state](const unsigned id) {
+            state = state*1103515245u + 12345u;
+            double x = 1 + (state >> 4) % 98000 / 1000.0;
+            state = state*1103515245u + 12345u;
+            double y = 1 + (state >> 4) % 98000 / 1000.0;
+            return Point<double>(x, y, id);
+        };
+        for (unsigned id = 4; id < 2000; id++) {
+            points.push_back(randomPoint(id));
+        }
+
+        Delaunay<double> delaunay(points);
+        REQUIRE( not delaunay.insert(randomPoint(0)) );
+        delaunay.setEditable(true);
+        REQUIRE( delaunay.getEditable() );
+        delaunay.triangulate();
+        const Mesh<double>& mesh = delaunay.getMesh();
+
+        // triangles not listed as changed keep their index and corners
+        auto requireOnlyChangedDiffer = [&](const std::vector<uint32_t>& before) {
+            const std::vector<uint32_t>& changed = delaunay.getChangedTriangles();
+            REQUIRE( not changed.empty() );
+            const uint32_t common = std::min<std::size_t>(before.size()/3, mesh.getTriangleCount());
+            for (uint32_t t = 0; t < common; t++) {
+                if (not std::binary_search(changed.begin(), changed.end(), t)) {
+                    REQUIRE( std::equal(before.begin() + 3*t, before.begin() + 3*t + 3, mesh.getTriangleIndices(t)) );
+                }
+            }
+        };
+
+        for (unsigned i = 0; i < 100; i++) {
+            const std::vector<uint32_t> before = mesh.getIndices();
+            REQUIRE( delaunay.insert(randomPoint(mesh.getVertexCount())) );
+            requireOnlyChangedDiffer(before);
+        }
+        REQUIRE( mesh.getVertexCount() == 2100 );
+        REQUIRE( not delaunay.insert(mesh.getVertex(10)) );
+
+        std::vector<char> removed(mesh.getVertexCount(), 0);
+        for (uint32_t vertex = 4; vertex < mesh.getVertexCount(); vertex += 21) {
+            const std::vector<uint32_t> before = mesh.getIndices();
+            REQUIRE( delaunay.remove(vertex) );
+            requireOnlyChangedDiffer(before);
+            removed[vertex] = 1;
+        }
+        REQUIRE( not delaunay.remove(4) );
+        REQUIRE( not delaunay.remove(mesh.getVertexCount()) );
+
+        REQUIRE( isLocallyDelaunay(mesh) );
+        Mesh<double> rebuilt = mesh;
+        rebuilt.buildAdjacency();
+        REQUIRE( rebuilt.getNeighbours() == mesh.getNeighbours() );
+
+        std::vector<Point<double>> remaining;
+        for (uint32_t vertex = 0; vertex < mesh.getVertexCount(); vertex++) {
+            if (not removed[vertex]) {
+                remaining.push_back(mesh.getVertex(vertex));
+            }
+        }
+        Delaunay<double> reference(remaining);
+        reference.triangulate();
+        REQUIRE( TestUtils::triangleIds(mesh) == TestUtils::triangleIds(reference.getMesh()) );
+
+        // edits on the hull, the triangles there border the super triangle
+        REQUIRE( delaunay.remove(1) );
+        REQUIRE( delaunay.insert({ 120, 50, uint32_t(mesh.getVertexCount()) }) );
+        REQUIRE( isLocallyDelaunay(mesh) );
+        rebuilt = mesh;
+        rebuilt.buildAdjacency();
+        REQUIRE( rebuilt.getNeighbours() == mesh.getNeighbours() );
+    }
+
+    SECTION("Delaunay triangulation - editing keeps the constraints") {
+        const unsigned size = 10;
+        std::vector<Point<double>> points;
+        for (unsigned row = 0; row < size; row++) {
+            for (unsigned col = 0; col < size; col++) {
+                points.push_back({ double(row), double(col), row*size + col });
+            }
+        }
+
+        Delaunay<double> delaunay(points);
+        delaunay.setConstraints({ { 0, 9*size + 4 } });
+        delaunay.setEditable(true);
+        delaunay.triangulate();
+        const Mesh<double>& mesh = delaunay.getMesh();
+
+        // close to the constraint, its circumcircles reach across it
+        REQUIRE( delaunay.insert({ 4.6, 2.1, 100 }) );
+        REQUIRE( hasEdge(mesh, 0, 9*size + 4) );
+        REQUIRE( isConstrainedDelaunay(delaunay) );
+
+        // on the constraint, it is split there
+        REQUIRE( delaunay.insert({ 2.25, 1.0, 101 }) );
+        REQUIRE( not hasEdge(mesh, 0, 9*size + 4) );
+        REQUIRE( hasEdge(mesh, 0, 101) );
+        REQUIRE( hasEdge(mesh, 101, 9*size + 4) );
+        REQUIRE( isConstrainedDelaunay(delaunay) );
+
+        unsigned constrained = 0;
+        for (uint32_t t = 0; t < mesh.getTriangleCount(); t++) {
+            for (unsigned e = 0; e < 3; e++) {
+                constrained += delaunay.isConstrainedEdge(t, e);
+            }
+        }
+        REQUIRE( constrained == 4 );
+
+        REQUIRE( delaunay.remove(100) );
+        REQUIRE( meshArea(mesh) == Approx((size - 1)*(size - 1)) );
+        REQUIRE( isConstrainedDelaunay(delaunay) );
+        REQUIRE( hasEdge(mesh, 0, 101) );
+
+        // the pieces of the constraint end at the point, they go with it
+        REQUIRE( delaunay.remove(101) );
+        REQUIRE( meshArea(mesh) == Approx((size - 1)*(size - 1)) );
+        REQUIRE( isLocallyDelaunay(mesh) );
+        Mesh<double> rebuilt = mesh;
+        rebuilt.buildAdjacency();
+        REQUIRE( rebuilt.getNeighbours() == mesh.getNeighbours() );
+    }
+
+    SECTION("Delaunay triangulation - removing points next to constraints") {
+        // Random points with constraints, every third point is removed, among them ends of
+        // constraints. Around some of them each ear has a corner behind a constraint in its circle.
+        std::vector<Point<double>> points;
+        unsigned state = 99;
+        for (uint32_t id = 0; id < 300; id++) {
+            state = state*1103515245u + 12345u;
+            const double x = (state >> 4) % 100000 / 1000.0;
+            state = state*1103515245u + 12345u;
+            const double y = (state >> 4) % 100000 / 1000.0;
+            points.push_back({ x, y, id });
+        }
+        std::vector<std::pair<unsigned, unsigned>> constraints;
+        for (unsigned i = 0; i < 40; i += 2) {
+            constraints.push_back(std::make_pair(i, i + 1));
+        }
+
+        Delaunay<double> delaunay(points);
+        delaunay.setConstraints(constraints);
+        delaunay.setEditable(true);
+        delaunay.triangulate();
+        const Mesh<double>& mesh = delaunay.getMesh();
 
-        REQUIRE( triangles[1].getB() == Point<float>(0.0f, 0.0f) );
-        REQUIRE( triangles[1].getA() == Point<float>(1.0f, 0.0f) );
-        REQUIRE( triangles[1].getC() == Point<float>(1.0f, 1.0f) );
+        for (uint32_t vertex = 0; vertex < 300; vertex += 3) {
+            REQUIRE( delaunay.remove(vertex) );
+            REQUIRE( isConstrainedDelaunay(delaunay) );
+        }
+        Mesh<double> rebuilt = mesh;
+        rebuilt.buildAdjacency();
+        REQUIRE( rebuilt.getNeighbours() == mesh.getNeighbours() );
     }
 }
@@ -0,0 +1,161 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 Hans-Peter Schadler <hps@abyle.org>
+**
+** This program is free software: you can redistribute it and/or modify it
+** under the terms of the GNU General Public License as published by the Free
+** Software Foundation, either version 3 of the License, or (at your option)
+** any later version.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT
+** ANY WARRANTY; without even the implied warranty of  MERCHANTABILITY or
+** FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+** more details.
+**
+** You should have received a copy of the GNU General Public License along with
+** this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+****************************************************************************/
+
+
+#include <catch.hpp>
+
+#include <cstdint>
+#include <vector>
+
+#include <delaunay.hpp>
+#include <gridmesh.hpp>
+#include <predicates.hpp>
+
+namespace {
+    std::vector<Point<double>> lattice(const unsigned rows, const unsigned cols, const bool rowsAlongX)
+    {
+        std::vector<Point<double>> points;
+        for (unsigned row = 0; row < rows; row++) {
+            for (unsigned col = 0; col < cols; col++) {
+                // SRTM like spacing, the GUI puts the latitude (row) into x
+                const double along = 0.25*col;
+                const double across = 47.0 + 0.5*row;
+                points.push_back(rowsAlongX ? Point<double>(across, along, row*cols + col)
+                                            : Point<double>(along, across, row*cols + col));
+            }
+        }
+        return points;
+    }
+
+    bool isValidMesh(const Mesh<double>& mesh)
+    {
+        for (uint32_t t = 0; t < mesh.getTriangleCount(); t++) {
+            if (Predicates::orient2d(mesh.getCorner(t, 0), mesh.getCorner(t, 1), mesh.getCorner(t, 2)) <= 0) {
+                return false;
+            }
+            for (unsigned e = 0; e < 3; e++) {
+                const int32_t n = mesh.getNeighbour(t, e);
+                if (n == Mesh<double>::NO_NEIGHBOUR) {
+                    continue;
+                }
+                for (unsigned c = 0; c < 3; c++) {
+                    if (Predicates::incircle(mesh.getCorner(t, 0), mesh.getCorner(t, 1), mesh.getCorner(t, 2), mesh.getCorner(n, c)) > 0) {
+                        return false;
+                    }
+                }
+            }
+        }
+
+        // the neighbours match the ones derived from the shared edges
+        Mesh<double> rebuilt = mesh;
+        rebuilt.buildAdjacency();
+        return rebuilt.getNeighbours() == mesh.getNeighbours();
+    }
+
+    bool hasEdge(const Mesh<double>& mesh, const uint32_t a, const uint32_t b)
+    {
+        for (uint32_t t = 0; t < mesh.getTriangleCount(); t++) {
+            for (unsigned e = 0; e < 3; e++) {
+                if (mesh.getIndex(t, e) == a && mesh.getIndex(t, (e + 1) % 3) == b) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+}
+
+TEST_CASE( "GridMesh Class tests", "[gridmesh]" ) {
+    SECTION("GridMesh - forward and backward diagonals") {
+        const unsigned rows = 5, cols = 7;
+        const std::vector<Point<double>> points = lattice(rows, cols, false);
+
+        Mesh<double> forward;
+        REQUIRE( GridMesh<double>::build(points, rows, cols, forward) );
+        REQUIRE( forward.getVertexCount() == points.size() );
+        REQUIRE( forward.getTriangleCount() == 2*(rows - 1)*(cols - 1) );
+        REQUIRE( isValidMesh(forward) );
+        REQUIRE( (hasEdge(forward, 0, cols + 1) || hasEdge(forward, cols + 1, 0)) );
+
+        Mesh<double> backward;
+        REQUIRE( GridMesh<double>::build(points, rows, cols, backward, GridMesh<double>::BACKWARD_DIAGONAL) );
+        REQUIRE( backward.getTriangleCount() == 2*(rows - 1)*(cols - 1) );
+        REQUIRE( isValidMesh(backward) );
+        REQUIRE( (hasEdge(backward, 1, cols) || hasEdge(backward, cols, 1)) );
+        REQUIRE_FALSE( (hasEdge(backward, 0, cols + 1) || hasEdge(backward, cols + 1, 0)) );
+    }
+
+    SECTION("GridMesh - mirrored lattice stays counter-clockwise") {
+        const unsigned rows = 4, cols = 6;
+        Mesh<double> mesh;
+        REQUIRE( GridMesh<double>::build(lattice(rows, cols, true), rows, cols, mesh) );
+        REQUIRE( mesh.getTriangleCount() == 2*(rows - 1)*(cols - 1) );
+        REQUIRE( isValidMesh(mesh) );
+    }
+
+    SECTION("GridMesh - diagonal by height") {
+        const unsigned rows = 2, cols = 3;
+        const std::vector<Point<double>> points = lattice(rows, cols, true);
+
+        // left cell: a ridge from (0,0) to (1,1), right cell: a ridge from (0,2) to (1,1)
+        const std::vector<double> heights { 100.0, 10.0, 100.0,
+                                            20.0, 100.0, 30.0 };
+
+        Mesh<double> mesh;
+        REQUIRE( GridMesh<double>::build(points, rows, cols, mesh, GridMesh<double>::HEIGHT_DIAGONAL, heights) );
+        REQUIRE( isValidMesh(mesh) );
+        REQUIRE( (hasEdge(mesh, 0, 4) || hasEdge(mesh, 4, 0)) );
+        REQUIRE( (hasEdge(mesh, 2, 4) || hasEdge(mesh, 4, 2)) );
+        REQUIRE_FALSE( (hasEdge(mesh, 1, 3) || hasEdge(mesh, 3, 1)) );
+        REQUIRE_FALSE( (hasEdge(mesh, 1, 5) || hasEdge(mesh, 5, 1)) );
+    }
+
+    SECTION("GridMesh - same cover as the Delaunay triangulation") {
+        const unsigned rows = 30, cols = 40;
+        const std::vector<Point<double>> points = lattice(rows, cols, true);
+
+        Mesh<double> mesh;
+        REQUIRE( GridMesh<double>::build(points, rows, cols, mesh) );
+
+        Delaunay<double> delaunay(points);
+        delaunay.triangulate();
+
+        REQUIRE( mesh.getTriangleCount() == delaunay.getMesh().getTriangleCount() );
+        double area = 0.0, delaunayArea = 0.0;
+        for (uint32_t t = 0; t < mesh.getTriangleCount(); t++) {
+            area += Predicates::orient2d(mesh.getCorner(t, 0), mesh.getCorner(t, 1), mesh.getCorner(t, 2));
+            delaunayArea += Predicates::orient2d(delaunay.getMesh().getCorner(t, 0), delaunay.getMesh().getCorner(t, 1),
+                                                 delaunay.getMesh().getCorner(t, 2));
+        }
+        REQUIRE( area == Approx(delaunayArea) );
+    }
+
+    SECTION("GridMesh - bad input") {
+        const std::vector<Point<double>> points = lattice(3, 3, false);
+        Mesh<double> mesh;
+
+        REQUIRE_FALSE( GridMesh<double>::build(points, 3, 4, mesh) );
+        REQUIRE( mesh.getTriangleCount() == 0 );
+        REQUIRE_FALSE( GridMesh<double>::build(points, 3, 3, mesh, GridMesh<double>::HEIGHT_DIAGONAL) );
+
+        // a single row has no cells
+        REQUIRE( GridMesh<double>::build(lattice(1, 5, false), 1, 5, mesh) );
+        REQUIRE( mesh.getTriangleCount() == 0 );
+    }
+}
@@ -0,0 +1,91 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 Hans-Peter Schadler <hps@abyle.org>
+**
+** This program is free software: you can redistribute it and/or modify it
+** under the terms of the GNU General Public License as published by the Free
+** Software Foundation, either version 3 of the License, or (at your option)
+** any later version.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT
+** ANY WARRANTY; without even the implied warranty of  MERCHANTABILITY or
+** FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+** more details.
+**
+** You should have received a copy of the GNU General Public License along with
+** this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+****************************************************************************/
+
+
+#include <catch.hpp>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <gridresampler.h>
+#include <testutils.h>
+
+namespace {
+    void writeTestHgt(const std::string& fileName, const int samples)
+    {
+        TestUtils::writeHgt(fileName, samples, [](const int row, const int col) {
+            return (row*row + col*13) % 4000 - 300;
+        });
+    }
+}
+
+TEST_CASE( "GridResampler tests", "[gridresampler]" ) {
+    SECTION("RegularGrid from a range") {
+        RegularGrid grid = RegularGrid::fromRange(47.0, 47.1, 0.01, 15.0, 15.05, 0.01);
+        REQUIRE( grid.getRows() == 11 );
+        REQUIRE( grid.getCols() == 6 );
+        REQUIRE( grid.size() == 66 );
+        REQUIRE( grid.getLatitude(10) == Approx(47.1) );
+        REQUIRE( grid.getLongitude(5) == Approx(15.05) );
+    }
+
+    SECTION("Resampling matches single queries") {
+        const std::string fileName = "N47E015.hgt";
+        const int samples = GENERATE(1201, 3601);
+        writeTestHgt(fileName, samples);
+
+        SRTMParser parser(fileName);
+        REQUIRE( parser.parseData() );
+
+        // partially outside the tile and touching the north/east borders
+        RegularGrid grid(46.9, 14.95, 0.0107, 0.0089, 104, 119);
+        GridResampler resampler(parser);
+
+        for (auto interpolationType : { SRTMParser::InterpolationType::NO_INTERPOLATION, SRTMParser::InterpolationType::LINEAR_INTERPOLATION }) {
+            std::vector<double> heights = resampler.resample(grid, interpolationType, 3);
+            REQUIRE( heights.size() == grid.size() );
+
+            for (int row = 0; row < grid.getRows(); row++) {
+                for (int col = 0; col < grid.getCols(); col++) {
+                    double expected = parser.getHeight(grid.getLatitude(row), grid.getLongitude(col), interpolationType);
+                    REQUIRE( heights[row*grid.getCols() + col] == Approx(expected).margin(1e-6) );
+                }
+            }
+        }
+
+        std::remove(fileName.c_str());
+    }
+
+    SECTION("Result does not depend on the number of threads") {
+        const std::string fileName = "N47E015.hgt";
+        writeTestHgt(fileName, 1201);
+
+        SRTMParser parser(fileName);
+        REQUIRE( parser.parseData() );
+
+        RegularGrid grid = RegularGrid::fromRange(47.0, 48.0, 0.0003, 15.2, 15.4, 0.0003);
+        GridResampler resampler(parser);
+
+        REQUIRE( resampler.resample(grid, SRTMParser::InterpolationType::LINEAR_INTERPOLATION, 1)
+                 == resampler.resample(grid, SRTMParser::InterpolationType::LINEAR_INTERPOLATION, 7) );
+
+        std::remove(fileName.c_str());
+    }
+}
@@ -0,0 +1,90 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 Hans-Peter Schadler <hps@abyle.org>
+**
+** This program is free software: you can redistribute it and/or modify it
+** under the terms of the GNU General Public License as published by the Free
+** Software Foundation, either version 3 of the License, or (at your option)
+** any later version.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT
+** ANY WARRANTY; without even the implied warranty of  MERCHANTABILITY or
+** FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+** more details.
+**
+** You should have received a copy of the GNU General Public License along with
+** this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+****************************************************************************/
+
+
+#include <catch.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <heightraster.h>
+
+TEST_CASE( "HeightRaster Class tests", "[heightraster]" ) {
+    SECTION("Create an empty HeightRaster") {
+        HeightRaster raster;
+        REQUIRE( raster.isEmpty() );
+        REQUIRE( raster.rows() == 0 );
+        REQUIRE( raster.cols() == 0 );
+    }
+
+    SECTION("Rows are aligned") {
+        HeightRaster raster(1201, 1201);
+        REQUIRE( not raster.isEmpty() );
+        REQUIRE( raster.isWritable() );
+        REQUIRE( raster.rows() == 1201 );
+        REQUIRE( raster.cols() == 1201 );
+        REQUIRE( raster.stride() >= 1201 );
+
+        for (int row = 0; row < raster.rows(); row += 100) {
+            REQUIRE( reinterpret_cast<std::uintptr_t>(raster.rowData(row)) % HeightRaster::ALIGNMENT == 0 );
+        }
+    }
+
+    SECTION("Set and get samples") {
+        HeightRaster raster(3, 5);
+        raster.fill(0);
+        raster.set(0, 0, -32768);
+        raster.set(2, 4, 8848);
+        raster.set(1, 2, -12);
+
+        REQUIRE( raster.at(0, 0) == -32768 );
+        REQUIRE( raster.at(2, 4) == 8848 );
+        REQUIRE( raster.at(1, 2) == -12 );
+        REQUIRE( raster.at(1, 3) == 0 );
+        REQUIRE( raster.rowData(1)[2] == -12 );
+
+        raster.writableRowData(2)[0] = 7;
+        REQUIRE( raster.at(2, 0) == 7 );
+        REQUIRE( raster.writableRowData(1) == raster.rowData(1) );
+    }
+
+    SECTION("Copies share the samples") {
+        HeightRaster raster(2, 2);
+        raster.fill(1);
+        HeightRaster copy = raster;
+        raster.set(1, 1, 42);
+
+        REQUIRE( copy.at(1, 1) == 42 );
+    }
+
+    SECTION("View on external samples") {
+        std::shared_ptr<std::vector<int16_t>> samples = std::make_shared<std::vector<int16_t>>(std::vector<int16_t>{ 1, 2, 3, 0,
+                                                                                                                    4, 5, 6, 0 });
+        HeightRaster raster = HeightRaster::view(samples->data(), 2, 3, 4, samples);
+        samples.reset();
+
+        REQUIRE( not raster.isWritable() );
+        REQUIRE( raster.stride() == 4 );
+        REQUIRE( raster.at(0, 2) == 3 );
+        REQUIRE( raster.at(1, 0) == 4 );
+        REQUIRE( raster.at(1, 2) == 6 );
+        REQUIRE( raster.rowData(1) == raster.data() + 4 );
+    }
+}
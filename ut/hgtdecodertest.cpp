@@ -0,0 +1,117 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 Hans-Peter Schadler <hps@abyle.org>
+**
+** This program is free software: you can redistribute it and/or modify it
+** under the terms of the GNU General Public License as published by the Free
+** Software Foundation, either version 3 of the License, or (at your option)
+** any later version.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT
+** ANY WARRANTY; without even the implied warranty of  MERCHANTABILITY or
+** FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+** more details.
+**
+** You should have received a copy of the GNU General Public License along with
+** this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+****************************************************************************/
+
+
+#include <catch.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <hgtdecoder.h>
+
+namespace {
+    std::vector<unsigned char> makePayload(const std::vector<int16_t>& values)
+    {
+        std::vector<unsigned char> payload;
+        for (auto value : values) {
+            payload.push_back((static_cast<uint16_t>(value) >> 8) & 0xFF);
+            payload.push_back(static_cast<uint16_t>(value) & 0xFF);
+        }
+        return payload;
+    }
+}
+
+TEST_CASE( "HgtDecoder tests", "[hgtdecoder]" ) {
+    // odd length so every kernel also runs its scalar tail
+    std::vector<int16_t> values;
+    for (int i = 0; i < 1001; i++) {
+        values.push_back((i*7919) % 9000 - 450);
+    }
+    values[3] = HgtDecoder::VOID_VALUE;
+    values[500] = HgtDecoder::VOID_VALUE;
+    values[1000] = HgtDecoder::VOID_VALUE;
+    values[17] = 8848;
+    values[999] = -430;
+
+    std::vector<unsigned char> payload = makePayload(values);
+
+    const HgtDecoder::Kernel originalKernel = HgtDecoder::getKernel();
+
+    SECTION("All supported kernels decode the same values") {
+        for (auto kernel : { HgtDecoder::SCALAR, HgtDecoder::SSE2, HgtDecoder::AVX2 }) {
+            if (not HgtDecoder::setKernel(kernel)) {
+                continue;
+            }
+            REQUIRE( HgtDecoder::getKernel() == kernel );
+
+            std::vector<int16_t> decoded(values.size());
+            HgtDecoder::decode(payload.data(), decoded.data(), values.size());
+            REQUIRE( decoded == values );
+        }
+    }
+
+    SECTION("All supported kernels collect the same statistics") {
+        for (auto kernel : { HgtDecoder::SCALAR, HgtDecoder::SSE2, HgtDecoder::AVX2 }) {
+            if (not HgtDecoder::setKernel(kernel)) {
+                continue;
+            }
+
+            std::vector<int16_t> decoded(values.size());
+            HgtStatistics statistics;
+            HgtDecoder::decode(payload.data(), decoded.data(), values.size(), statistics);
+
+            REQUIRE( decoded == values );
+            REQUIRE( statistics.voidCount == 3 );
+            REQUIRE( statistics.max == 8848 );
+            REQUIRE( statistics.min == -450 );
+        }
+    }
+
+    SECTION("Decoding in place") {
+        for (auto kernel : { HgtDecoder::SCALAR, HgtDecoder::SSE2, HgtDecoder::AVX2 }) {
+            if (not HgtDecoder::setKernel(kernel)) {
+                continue;
+            }
+
+            std::vector<int16_t> buffer(values.size());
+            std::memcpy(buffer.data(), payload.data(), payload.size());
+
+            HgtStatistics statistics;
+            HgtDecoder::decode(reinterpret_cast<const unsigned char*>(buffer.data()), buffer.data(), buffer.size(), statistics);
+
+            REQUIRE( buffer == values );
+            REQUIRE( statistics.voidCount == 3 );
+        }
+    }
+
+    SECTION("Statistics of void only data") {
+        std::vector<int16_t> voids(40, HgtDecoder::VOID_VALUE);
+        std::vector<unsigned char> voidPayload = makePayload(voids);
+        std::vector<int16_t> decoded(voids.size());
+
+        HgtStatistics statistics;
+        HgtDecoder::decode(voidPayload.data(), decoded.data(), voids.size(), statistics);
+
+        REQUIRE( statistics.voidCount == 40 );
+        REQUIRE( statistics.min > statistics.max );
+    }
+
+    HgtDecoder::setKernel(originalKernel);
+}
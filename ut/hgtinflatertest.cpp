@@ -0,0 +1,260 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 Hans-Peter Schadler <hps@abyle.org>
+**
+** This program is free software: you can redistribute it and/or modify it
+** under the terms of the GNU General Public License as published by the Free
+** Software Foundation, either version 3 of the License, or (at your option)
+** any later version.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT
+** ANY WARRANTY; without even the implied warranty of  MERCHANTABILITY or
+** FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+** more details.
+**
+** You should have received a copy of the GNU General Public License along with
+** this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+****************************************************************************/
+
+
+
+#include <catch.hpp>
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <hgtinflater.h>
+#include <srtmparser.h>
+
+#ifdef QWORLDPARSER_HAVE_ZLIB
+    #include <zlib.h>
+#endif
+
+namespace {
+    std::vector<unsigned char> makeTilePayload(const int samples)
+    {
+        std::vector<unsigned char> payload;
+        for (int row = 0; row < samples; row++) {
+            for (int col = 0; col < samples; col++) {
+                int height = (row*11 + col*5) % 2500 - 200;
+                if (row == 7 && col == 9) {
+                    height = HgtDecoder::VOID_VALUE;
+                }
+                payload.push_back((height >> 8) & 0xFF);
+                payload.push_back(height & 0xFF);
+            }
+        }
+        return payload;
+    }
+
+    void writeFile(const std::string& fileName, const std::vector<unsigned char>& data)
+    {
+        std::ofstream file(fileName, std::ios::binary);
+        file.write(reinterpret_cast<const char*>(data.data()), data.size());
+    }
+
+    void append(std::vector<unsigned char>& data, const uint32_t value, const int bytes)
+    {
+        for (int i = 0; i < bytes; i++) {
+            data.push_back((value >> (8*i)) & 0xFF);
+        }
+    }
+
+    // Zip file with a readme in front of the tile, the tile data is stored or deflated
+    std::vector<unsigned char> makeZip(const std::string& entryName, const std::vector<unsigned char>& payload,
+                                       const std::vector<unsigned char>& data, const int method)
+    {
+        struct Entry {
+            std::string name;
+            std::vector<unsigned char> data;
+            int method;
+            uint32_t size;
+            uint32_t offset;
+        };
+        std::string readme = "SRTM tile";
+        std::vector<Entry> entries = {
+            { "readme.txt", std::vector<unsigned char>(readme.begin(), readme.end()), 0, uint32_t(readme.size()), 0 },
+            { entryName, data, method, uint32_t(payload.size()), 0 }
+        };
+
+        std::vector<unsigned char> zip;
+        for (auto& entry : entries) {
+            entry.offset = zip.size();
+            append(zip, 0x04034b50, 4);
+            append(zip, 20, 2);
+            append(zip, 0, 2);
+            append(zip, entry.method, 2);
+            append(zip, 0, 4); // time, date
+            append(zip, 0, 4); // crc, not checked by the reader
+            append(zip, entry.data.size(), 4);
+            append(zip, entry.size, 4);
+            append(zip, entry.name.size(), 2);
+            append(zip, 0, 2);
+            zip.insert(zip.end(), entry.name.begin(), entry.name.end());
+            zip.insert(zip.end(), entry.data.begin(), entry.data.end());
+        }
+
+        const uint32_t directoryOffset = zip.size();
+        for (auto& entry : entries) {
+            append(zip, 0x02014b50, 4);
+            append(zip, 20, 2);
+            append(zip, 20, 2);
+            append(zip, 0, 2);
+            append(zip, entry.method, 2);
+            append(zip, 0, 4);
+            append(zip, 0, 4);
+            append(zip, entry.data.size(), 4);
+            append(zip, entry.size, 4);
+            append(zip, entry.name.size(), 2);
+            append(zip, 0, 2); // extra
+            append(zip, 0, 2); // comment
+            append(zip, 0, 2); // disk
+            append(zip, 0, 2);
+            append(zip, 0, 4);
+            append(zip, entry.offset, 4);
+            zip.insert(zip.end(), entry.name.begin(), entry.name.end());
+        }
+        const uint32_t directorySize = zip.size() - directoryOffset;
+
+        append(zip, 0x06054b50, 4);
+        append(zip, 0, 2);
+        append(zip, 0, 2);
+        append(zip, entries.size(), 2);
+        append(zip, entries.size(), 2);
+        append(zip, directorySize, 4);
+        append(zip, directoryOffset, 4);
+        append(zip, 0, 2);
+
+        return zip;
+    }
+
+#ifdef QWORLDPARSER_HAVE_ZLIB
+    std::vector<unsigned char> compress(const std::vector<unsigned char>& payload, const bool gzip)
+    {
+        z_stream stream;
+        stream.zalloc = Z_NULL;
+        stream.zfree = Z_NULL;
+        stream.opaque = Z_NULL;
+        deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, gzip ? 16 + MAX_WBITS : -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+
+        std::vector<unsigned char> data(deflateBound(&stream, payload.size()) + 32);
+        stream.next_in = const_cast<Bytef*>(payload.data());
+        stream.avail_in = payload.size();
+        stream.next_out = data.data();
+        stream.avail_out = data.size();
+        deflate(&stream, Z_FINISH);
+        data.resize(stream.total_out);
+        deflateEnd(&stream);
+
+        return data;
+    }
+#endif
+
+    void requireSameTile(const std::string& fileName, const std::string& referenceFileName,
+                         const SRTMParser::LoadMode loadMode = SRTMParser::LoadMode::LOAD_READ)
+    {
+        SRTMParser reference(referenceFileName);
+        REQUIRE( reference.parseData() );
+        SRTMParser parser(fileName);
+        REQUIRE( parser.parseData(loadMode) );
+
+        REQUIRE( parser.getLatOrigin() == 47 );
+        REQUIRE( parser.getLonOrigin() == 15 );
+
+        HeightRaster expected = reference.getHeightData();
+        HeightRaster heightData = parser.getHeightData();
+        REQUIRE( heightData.rows() == expected.rows() );
+        REQUIRE( heightData.cols() == expected.cols() );
+        int mismatches = 0;
+        for (int row = 0; row < expected.rows(); row++) {
+            for (int col = 0; col < expected.cols(); col++) {
+                mismatches += (heightData.at(row, col) != expected.at(row, col));
+            }
+        }
+        REQUIRE( mismatches == 0 );
+
+        HgtStatistics statistics = parser.getStatistics();
+        REQUIRE( statistics.voidCount == 1 );
+        REQUIRE( statistics.min == reference.getStatistics().min );
+        REQUIRE( statistics.max == reference.getStatistics().max );
+    }
+}
+
+TEST_CASE( "HgtInflater tests", "[hgtinflater]" ) {
+    const int samples = 1201;
+    const std::vector<unsigned char> payload = makeTilePayload(samples);
+    writeFile("N47E015.hgt", payload);
+
+    SECTION("Formats are detected from the content") {
+        REQUIRE( HgtInflater::detectFormat("N47E015.hgt") == HgtInflater::PLAIN );
+
+        writeFile("N47E015.hgt.zip", makeZip("N47E015.hgt", payload, payload, 0));
+        REQUIRE( HgtInflater::detectFormat("N47E015.hgt.zip") == HgtInflater::ZIP );
+
+        HgtInflater inflater;
+        REQUIRE( not inflater.open("N47E015.hgt") );
+        REQUIRE( inflater.open("N47E015.hgt.zip") );
+        REQUIRE( inflater.getUncompressedSize() == payload.size() );
+
+        std::remove("N47E015.hgt.zip");
+    }
+
+    SECTION("Stored zip entry") {
+        writeFile("N47E015.hgt.zip", makeZip("N47E015.hgt", payload, payload, 0));
+        requireSameTile("N47E015.hgt.zip", "N47E015.hgt");
+        std::remove("N47E015.hgt.zip");
+    }
+
+    SECTION("Payloads of the wrong size are rejected") {
+        std::vector<unsigned char> shortPayload(payload.begin(), payload.end() - 2);
+        writeFile("N47E015.hgt.zip", makeZip("N47E015.hgt", shortPayload, shortPayload, 0));
+
+        SRTMParser parser("N47E015.hgt.zip");
+        REQUIRE( not parser.parseData() );
+        std::remove("N47E015.hgt.zip");
+    }
+
+#ifdef QWORLDPARSER_HAVE_ZLIB
+    SECTION("Deflated zip entry") {
+        REQUIRE( HgtInflater::isSupported() );
+        writeFile("N47E015.hgt.zip", makeZip("N47E015.hgt", payload, compress(payload, false), 8));
+        requireSameTile("N47E015.hgt.zip", "N47E015.hgt");
+        std::remove("N47E015.hgt.zip");
+    }
+
+    SECTION("Gzip file") {
+        writeFile("N47E015.hgt.gz", compress(payload, true));
+        REQUIRE( HgtInflater::detectFormat("N47E015.hgt.gz") == HgtInflater::GZIP );
+        requireSameTile("N47E015.hgt.gz", "N47E015.hgt");
+
+        // can't be mapped, decoded into memory instead
+        requireSameTile("N47E015.hgt.gz", "N47E015.hgt", SRTMParser::LoadMode::LOAD_MMAP);
+        std::remove("N47E015.hgt.gz");
+    }
+
+    SECTION("Damaged gzip file") {
+        std::vector<unsigned char> data = compress(payload, true);
+
+        // checksum mismatch
+        std::vector<unsigned char> corrupt = data;
+        corrupt[corrupt.size() - 8] ^= 0xFF;
+        writeFile("N47E015.hgt.gz", corrupt);
+        SRTMParser corruptParser("N47E015.hgt.gz");
+        REQUIRE( not corruptParser.parseData() );
+
+        // truncated, the trailer no longer matches the tile size
+        std::vector<unsigned char> truncated(data.begin(), data.begin() + data.size()/2);
+        writeFile("N47E015.hgt.gz", truncated);
+        SRTMParser truncatedParser("N47E015.hgt.gz");
+        REQUIRE( not truncatedParser.parseData() );
+
+        std::remove("N47E015.hgt.gz");
+    }
+#endif
+
+    std::remove("N47E015.hgt");
+}
@@ -0,0 +1,131 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 Hans-Peter Schadler <hps@abyle.org>
+**
+** This program is free software: you can redistribute it and/or modify it
+** under the terms of the GNU General Public License as published by the Free
+** Software Foundation, either version 3 of the License, or (at your option)
+** any later version.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT
+** ANY WARRANTY; without even the implied warranty of  MERCHANTABILITY or
+** FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+** more details.
+**
+** You should have received a copy of the GNU General Public License along with
+** this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+****************************************************************************/
+
+
+#include <catch.hpp>
+
+#include <cstdint>
+#include <vector>
+
+#include <delaunay.hpp>
+#include <mesh.hpp>
+
+TEST_CASE( "Mesh Class tests", "[mesh]" ) {
+    SECTION("Mesh - accessors and adjacency of a square") {
+        const std::vector<Point<float>> points { {0, 0, 10}, {1, 0, 11}, {1, 1, 12}, {0, 1, 13} };
+
+        Mesh<float> mesh(points);
+        REQUIRE(mesh.addTriangle(0, 1, 2) == 0);
+        REQUIRE(mesh.addTriangle(0, 2, 3) == 1);
+
+        REQUIRE(mesh.getVertexCount() == 4);
+        REQUIRE(mesh.getTriangleCount() == 2);
+        REQUIRE(mesh.getIndices().size() == 6);
+        REQUIRE(mesh.getTriangleIndices(1)[2] == 3);
+        REQUIRE(mesh.getIndex(1, 1) == 2);
+        REQUIRE(mesh.getCorner(0, 1).getId() == 11);
+        REQUIRE(mesh.getVertices().data() == &mesh.getVertex(0));
+
+        // no neighbours before buildAdjacency()
+        for (const int32_t neighbour : mesh.getNeighbours()) {
+            REQUIRE(neighbour == Mesh<float>::NO_NEIGHBOUR);
+        }
+
+        mesh.buildAdjacency();
+
+        // the diagonal 0-2 is opposite corner 1 of the first and corner 2 of the second triangle
+        REQUIRE(mesh.getNeighbour(0, 1) == 1);
+        REQUIRE(mesh.getNeighbour(1, 2) == 0);
+        REQUIRE(mesh.getNeighbour(0, 0) == Mesh<float>::NO_NEIGHBOUR);
+        REQUIRE(mesh.getNeighbour(0, 2) == Mesh<float>::NO_NEIGHBOUR);
+        REQUIRE(mesh.getNeighbour(1, 0) == Mesh<float>::NO_NEIGHBOUR);
+        REQUIRE(mesh.getNeighbour(1, 1) == Mesh<float>::NO_NEIGHBOUR);
+
+        const Triangle<Point<float>, float> triangle = mesh.getTriangle(1);
+        REQUIRE(triangle.getA().getId() == 10);
+        REQUIRE(triangle.getB().getId() == 12);
+        REQUIRE(triangle.getC().getId() == 13);
+
+        mesh.clearTriangles();
+        REQUIRE(mesh.getTriangleCount() == 0);
+        REQUIRE(mesh.getVertexCount() == 4);
+    }
+
+    SECTION("Mesh - Delaunay output of a grid") {
+        const unsigned size = 30;
+        std::vector<Point<double>> points;
+        for (unsigned row = 0; row < size; ++row) {
+            for (unsigned col = 0; col < size; ++col) {
+                points.push_back(Point<double>(col, row, 1000 + row*size + col));
+            }
+        }
+
+        Delaunay<double> delaunay(points);
+        delaunay.triangulate();
+
+        const Mesh<double>& mesh = delaunay.getMesh();
+        REQUIRE(mesh.getVertexCount() == points.size());
+        REQUIRE(mesh.getTriangleCount() == 2*(size - 1)*(size - 1));
+
+        // indices are positions in the given points, the ids are untouched
+        for (std::size_t v = 0; v < points.size(); ++v) {
+            REQUIRE(mesh.getVertex(v) == points[v]);
+            REQUIRE(mesh.getVertex(v).getId() == points[v].getId());
+        }
+
+        unsigned borderEdges = 0;
+        for (uint32_t t = 0; t < mesh.getTriangleCount(); ++t) {
+            const Point<double>& a = mesh.getCorner(t, 0);
+            const Point<double>& b = mesh.getCorner(t, 1);
+            const Point<double>& c = mesh.getCorner(t, 2);
+            REQUIRE((b.getX() - a.getX())*(c.getY() - a.getY()) - (b.getY() - a.getY())*(c.getX() - a.getX()) > 0);
+
+            for (unsigned e = 0; e < 3; ++e) {
+                const int32_t n = mesh.getNeighbour(t, e);
+                if (n == Mesh<double>::NO_NEIGHBOUR) {
+                    borderEdges++;
+                    continue;
+                }
+
+                // the neighbour shares the edge in the opposite direction and points back
+                const uint32_t from = mesh.getIndex(t, (e + 1) % 3);
+                const uint32_t to = mesh.getIndex(t, (e + 2) % 3);
+                bool found = false;
+                for (unsigned f = 0; f < 3; ++f) {
+                    if (mesh.getIndex(n, (f + 1) % 3) == to && mesh.getIndex(n, (f + 2) % 3) == from) {
+                        REQUIRE(mesh.getNeighbour(n, f) == static_cast<int32_t>(t));
+                        found = true;
+                    }
+                }
+                REQUIRE(found);
+            }
+        }
+        REQUIRE(borderEdges == 4*(size - 1));
+
+        // rebuilding the adjacency from the indices gives the same neighbours
+        Mesh<double> rebuilt = mesh;
+        rebuilt.buildAdjacency();
+        REQUIRE(rebuilt.getNeighbours() == mesh.getNeighbours());
+
+        // getTriangles() is the same triangulation with copied corners
+        const auto triangles = delaunay.getTriangles();
+        REQUIRE(triangles.size() == mesh.getTriangleCount());
+        REQUIRE(triangles[5].getB().getId() == mesh.getCorner(5, 1).getId());
+    }
+}
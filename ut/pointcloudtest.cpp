@@ -0,0 +1,189 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 Hans-Peter Schadler <hps@abyle.org>
+**
+** This program is free software: you can redistribute it and/or modify it
+** under the terms of the GNU General Public License as published by the Free
+** Software Foundation, either version 3 of the License, or (at your option)
+** any later version.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT
+** ANY WARRANTY; without even the implied warranty of  MERCHANTABILITY or
+** FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+** more details.
+**
+** You should have received a copy of the GNU General Public License along with
+** this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+****************************************************************************/
+
+
+#include <catch.hpp>
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include <point.hpp>
+#include <pointcloud.h>
+#include <srtmparser.h>
+
+namespace {
+    // Stands in for SRTMParser and TerrainMosaic, the height is a plane over latitude and longitude
+    struct PlaneHeights
+    {
+        void getHeights(const double* latitudes, const double* longitudes, double* heights, const std::size_t count,
+                        const SRTMParser::InterpolationType interpolationType = SRTMParser::InterpolationType::NO_INTERPOLATION)
+        {
+            lastInterpolationType = interpolationType;
+            for (std::size_t i = 0; i < count; i++) {
+                heights[i] = 1000.0*(latitudes[i] - 47.0) + 10.0*(longitudes[i] - 15.0);
+            }
+        }
+
+        SRTMParser::InterpolationType lastInterpolationType = SRTMParser::InterpolationType::LINEAR_INTERPOLATION;
+    };
+}
+
+TEST_CASE( "PointCloud tests", "[pointcloud]" ) {
+    // odd length so every kernel also runs its scalar tail
+    PointCloud cloud;
+    unsigned state = 4711;
+    for (unsigned id = 0; id < 1001; id++) {
+        state = state*1103515245u + 12345u;
+        const double x = 47.0 + ((state >> 8) % 100000)/100000.0;
+        state = state*1103515245u + 12345u;
+        const double y = 15.0 + ((state >> 8) % 100000)/100000.0;
+        cloud.add(x, y, (id % 97)*3.5 - 100.0, id);
+    }
+    cloud.getXs()[17] = 46.5;
+    cloud.getYs()[1000] = 16.25;
+    cloud.getZs()[3] = std::numeric_limits<double>::quiet_NaN();
+
+    const PointCloud::Kernel originalKernel = PointCloud::getKernel();
+
+    SECTION("All supported kernels find the same bounds") {
+        PointCloud::setKernel(PointCloud::SCALAR);
+        const PointCloudBounds expected = cloud.getBounds();
+        REQUIRE( expected.minX == 46.5 );
+        REQUIRE( expected.maxY == 16.25 );
+        REQUIRE( expected.minZ == -100.0 );
+        REQUIRE( expected.maxZ == 96*3.5 - 100.0 );
+
+        for (auto kernel : { PointCloud::SCALAR, PointCloud::SSE2, PointCloud::AVX2 }) {
+            if (not PointCloud::setKernel(kernel)) {
+                continue;
+            }
+            REQUIRE( PointCloud::getKernel() == kernel );
+
+            const PointCloudBounds bounds = cloud.getBounds();
+            REQUIRE( bounds.minX == expected.minX );
+            REQUIRE( bounds.minY == expected.minY );
+            REQUIRE( bounds.minZ == expected.minZ );
+            REQUIRE( bounds.maxX == expected.maxX );
+            REQUIRE( bounds.maxY == expected.maxY );
+            REQUIRE( bounds.maxZ == expected.maxZ );
+        }
+    }
+
+    SECTION("All supported kernels transform the same way") {
+        AffineTransform transform = AffineTransform::translation(-47.0, -15.0, 5.0)
+                .then(AffineTransform::scaling(111000.0, 76000.0, 100.0));
+        transform.xy = 0.25;
+
+        std::vector<PointCloud> results;
+        for (auto kernel : { PointCloud::SCALAR, PointCloud::SSE2, PointCloud::AVX2 }) {
+            if (not PointCloud::setKernel(kernel)) {
+                continue;
+            }
+            PointCloud transformed = cloud;
+            transformed.transform(transform);
+            results.push_back(transformed);
+        }
+
+        const PointCloud& scalar = results.front();
+        for (std::size_t i = 0; i < cloud.size(); i += 50) {
+            REQUIRE( scalar.getX(i) == transform.xx*cloud.getX(i) + transform.xy*cloud.getY(i) + transform.dx );
+            REQUIRE( scalar.getY(i) == transform.yx*cloud.getX(i) + transform.yy*cloud.getY(i) + transform.dy );
+        }
+        REQUIRE( scalar.getZ(0) == 100.0*(cloud.getZ(0) + 5.0) );
+        REQUIRE( std::isnan(scalar.getZ(3)) );
+        REQUIRE( scalar.getIds() == cloud.getIds() );
+
+        for (const PointCloud& result : results) {
+            REQUIRE( result.getXs() == scalar.getXs() );
+            REQUIRE( result.getYs() == scalar.getYs() );
+            for (std::size_t i = 0; i < cloud.size(); i++) {
+                if (i != 3) {
+                    REQUIRE( result.getZ(i) == scalar.getZ(i) );
+                }
+            }
+        }
+    }
+
+    SECTION("Compose and invert transforms") {
+        const AffineTransform scale = AffineTransform::scaling(2.0, 4.0, 0.5);
+        const AffineTransform shift = AffineTransform::translation(1.0, -1.0, 3.0);
+        const AffineTransform both = scale.then(shift);
+        REQUIRE( both.xx == 2.0 );
+        REQUIRE( both.yy == 4.0 );
+        REQUIRE( both.dx == 1.0 );
+        REQUIRE( both.dy == -1.0 );
+        REQUIRE( both.zz == 0.5 );
+        REQUIRE( both.dz == 3.0 );
+
+        AffineTransform inverse;
+        REQUIRE( both.invert(inverse) );
+        const AffineTransform identity = both.then(inverse);
+        REQUIRE( identity.xx == Approx(1.0) );
+        REQUIRE( identity.xy == Approx(0.0) );
+        REQUIRE( identity.dx == Approx(0.0) );
+        REQUIRE( identity.yy == Approx(1.0) );
+        REQUIRE( identity.dy == Approx(0.0) );
+        REQUIRE( identity.zz == Approx(1.0) );
+        REQUIRE( identity.dz == Approx(0.0) );
+
+        REQUIRE( not AffineTransform::scaling(0.0, 1.0).invert(inverse) );
+    }
+
+    SECTION("Latitude and longitude to metres and back") {
+        const double latMetres = PointCloud::getMetresPerDegreeLat(47.0, 15.0);
+        const double lonMetres = PointCloud::getMetresPerDegreeLon(47.0, 15.0);
+        REQUIRE( latMetres == Approx(111195.0).epsilon(1e-4) );
+        REQUIRE( lonMetres == Approx(0.5*(std::cos(47.0*M_PI/180.0) + std::cos(48.0*M_PI/180.0))*111195.0).epsilon(1e-3) );
+
+        PointCloud metres = cloud;
+        metres.toMetres(47.0, 15.0);
+        REQUIRE( metres.getX(17) == Approx(-0.5*latMetres) );
+        REQUIRE( metres.getY(1000) == Approx(1.25*lonMetres) );
+
+        metres.toLatLon(47.0, 15.0);
+        for (std::size_t i = 0; i < cloud.size(); i++) {
+            REQUIRE( metres.getX(i) == Approx(cloud.getX(i)).epsilon(1e-12) );
+            REQUIRE( metres.getY(i) == Approx(cloud.getY(i)).epsilon(1e-12) );
+        }
+    }
+
+    SECTION("Attach heights") {
+        PlaneHeights source;
+        cloud.attachHeights(source);
+        REQUIRE( source.lastInterpolationType == SRTMParser::InterpolationType::NO_INTERPOLATION );
+        cloud.attachHeights(source, SRTMParser::InterpolationType::LINEAR_INTERPOLATION);
+        REQUIRE( source.lastInterpolationType == SRTMParser::InterpolationType::LINEAR_INTERPOLATION );
+        for (std::size_t i = 0; i < cloud.size(); i++) {
+            REQUIRE( cloud.getZ(i) == 1000.0*(cloud.getX(i) - 47.0) + 10.0*(cloud.getY(i) - 15.0) );
+        }
+    }
+
+    SECTION("Empty point cloud") {
+        const PointCloudBounds bounds = PointCloud().getBounds();
+        REQUIRE( bounds.isEmpty() );
+
+        PointCloudBounds merged = bounds;
+        merged.merge(cloud.getBounds());
+        REQUIRE( not merged.isEmpty() );
+        REQUIRE( merged.minX == 46.5 );
+    }
+
+    PointCloud::setKernel(originalKernel);
+}
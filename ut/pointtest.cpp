@@ -20,6 +20,7 @@
 #include <catch.hpp>
 
 #include <point.hpp>
+#include <point2.hpp>
 
 TEST_CASE( "Point Class tests", "[point]" ) {
     SECTION("Create a Point") {
@@ -107,4 +108,46 @@ TEST_CASE( "Point Class tests", "[point]" ) {
         REQUIRE( C->getId() == 3 );
         REQUIRE( A->getId() == alsoA->getId() );
     }
+
+    SECTION("Coordinates keep the precision of T") {
+        Point<double> A(0.1, 1000.000001);
+        REQUIRE( A.getX() == 0.1 );
+        REQUIRE( A.getY() == 1000.000001 );
+        REQUIRE( not(A == Point<double>(0.1, 1000.0)) );
+    }
+}
+
+TEST_CASE( "Point2 Class tests", "[point]" ) {
+    SECTION("Create a Point2") {
+        Point2<double> A;
+        REQUIRE( A.getX() == 0.0 );
+        REQUIRE( A.getY() == 0.0 );
+
+        Point2<double> B(-3.4, 624.0);
+        REQUIRE( B.getX() == -3.4 );
+        REQUIRE( B.getY() == 624.0 );
+        REQUIRE( sizeof(Point2<double>) == 2*sizeof(double) );
+        REQUIRE( sizeof(Point2<float>) == 2*sizeof(float) );
+    }
+
+    SECTION("Arithmetic of two Point2") {
+        Point2<double> A(-10.2, 4.0);
+        Point2<double> B(8.0, -2.9);
+
+        REQUIRE( (A + B) == Point2<double>(-10.2 + 8.0, 4.0 + -2.9) );
+        REQUIRE( (A - B) == Point2<double>(-10.2 - 8.0, 4.0 - -2.9) );
+        REQUIRE( A.dot(B) == -10.2*8.0 + 4.0*-2.9 );
+        REQUIRE( A.distance(B) == Approx(std::hypot(18.2, 6.9)) );
+    }
+
+    SECTION("Convert between Point and Point2") {
+        Point<double> A(-10.2, 4.0, 7);
+        Point2<double> B = A;
+        REQUIRE( B.getX() == -10.2 );
+        REQUIRE( B.getY() == 4.0 );
+
+        Point<double> C = B.toPoint(9);
+        REQUIRE( C == A );
+        REQUIRE( C.getId() == 9 );
+    }
 }
@@ -0,0 +1,90 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 Hans-Peter Schadler <hps@abyle.org>
+**
+** This program is free software: you can redistribute it and/or modify it
+** under the terms of the GNU General Public License as published by the Free
+** Software Foundation, either version 3 of the License, or (at your option)
+** any later version.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT
+** ANY WARRANTY; without even the implied warranty of  MERCHANTABILITY or
+** FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+** more details.
+**
+** You should have received a copy of the GNU General Public License along with
+** this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+****************************************************************************/
+
+
+#include <catch.hpp>
+
+#include <cmath>
+
+#include <point.hpp>
+#include <predicates.hpp>
+
+TEST_CASE( "Predicates Class tests", "[predicates]" ) {
+    SECTION("orient2d - signs") {
+        REQUIRE( Predicates::orient2d(0.0, 0.0, 1.0, 0.0, 0.0, 1.0) > 0 );
+        REQUIRE( Predicates::orient2d(0.0, 0.0, 0.0, 1.0, 1.0, 0.0) < 0 );
+        REQUIRE( Predicates::orient2d(0.0, 0.0, 1.0, 1.0, 2.0, 2.0) == 0 );
+
+        const Point<float> a(0.0f, 0.0f), b(1.0f, 0.0f), c(0.0f, 1.0f);
+        REQUIRE( Predicates::orient2d(a, b, c) > 0 );
+    }
+
+    SECTION("orient2d - beyond double precision") {
+        // exact determinant M*M - (M + 1)*(M - 1) = 1, in double both products round to 2^56
+        const double m = std::ldexp(1.0, 28);
+        REQUIRE( m*m - (m + 1)*(m - 1) == 0.0 );
+        REQUIRE( Predicates::orient2d(0.0, 0.0, m, m + 1, m - 1, m) > 0 );
+        REQUIRE( Predicates::orient2d(0.0, 0.0, m - 1, m, m, m + 1) < 0 );
+
+        // collinear points far from the origin
+        const double o = 1e15;
+        REQUIRE( Predicates::orient2d(o, o + 3, o + 2, o + 7, o + 4, o + 11) == 0 );
+        REQUIRE( Predicates::orient2d(o, o + 3, o + 2, o + 7, o + 4, o + 12) > 0 );
+        REQUIRE( Predicates::orient2d(o, o + 3, o + 2, o + 7, o + 4, o + 10) < 0 );
+    }
+
+    SECTION("orient2d - nearly collinear points, consistent along the line") {
+        // sliding a point along a line through two fixed points never changes the exact answer
+        const double step = std::ldexp(1.0, -50);
+        for (int i = 0; i < 64; i++) {
+            const double x = 0.5 + i*step;
+            REQUIRE( Predicates::orient2d(x, x, 12.0, 12.0, 24.0, 24.0) == 0 );
+            // a, b, c are counter-clockwise with a above the line and clockwise with a below
+            REQUIRE( Predicates::orient2d(x, x + step, 12.0, 12.0, 24.0, 24.0) > 0 );
+            REQUIRE( Predicates::orient2d(x, x - step, 12.0, 12.0, 24.0, 24.0) < 0 );
+        }
+    }
+
+    SECTION("incircle - signs") {
+        // circle through (0,0), (1,0), (0,1) has center (0.5,0.5)
+        REQUIRE( Predicates::incircle(0.0, 0.0, 1.0, 0.0, 0.0, 1.0, 0.5, 0.5) > 0 );
+        REQUIRE( Predicates::incircle(0.0, 0.0, 1.0, 0.0, 0.0, 1.0, 2.0, 2.0) < 0 );
+
+        // clockwise triangle flips the sign
+        REQUIRE( Predicates::incircle(0.0, 0.0, 0.0, 1.0, 1.0, 0.0, 0.5, 0.5) < 0 );
+    }
+
+    SECTION("incircle - cocircular grid corners") {
+        for (const double offset : { 0.0, 1024.0, 123456.75, 1e9 }) {
+            const double x = offset, y = -offset;
+            REQUIRE( Predicates::incircle(x, y, x + 1, y, x + 1, y + 1, x, y + 1) == 0 );
+
+            // a fourth corner moved by far less than the rounding of the naive determinant
+            const double eps = std::ldexp(std::fabs(x) + 1.0, -45);
+            REQUIRE( Predicates::incircle(x, y, x + 1, y, x + 1, y + 1, x, y + 1 + eps) < 0 );
+            REQUIRE( Predicates::incircle(x, y, x + 1, y, x + 1, y + 1, x, y + 1 - eps) > 0 );
+        }
+    }
+
+    SECTION("incircle - points given as Point") {
+        const Point<float> a(0.0f, 0.0f), b(2.0f, 0.0f), c(2.0f, 2.0f), d(0.0f, 2.0f);
+        REQUIRE( Predicates::incircle(a, b, c, d) == 0 );
+        REQUIRE( Predicates::incircle(a, b, c, Point<float>(1.0f, 1.0f)) > 0 );
+    }
+}
@@ -0,0 +1,124 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 Hans-Peter Schadler <hps@abyle.org>
+**
+** This program is free software: you can redistribute it and/or modify it
+** under the terms of the GNU General Public License as published by the Free
+** Software Foundation, either version 3 of the License, or (at your option)
+** any later version.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT
+** ANY WARRANTY; without even the implied warranty of  MERCHANTABILITY or
+** FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+** more details.
+**
+** You should have received a copy of the GNU General Public License along with
+** this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+****************************************************************************/
+
+
+#include <catch.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <map>
+#include <vector>
+
+#include <delaunay.hpp>
+#include <spatialsort.hpp>
+#include <testutils.h>
+
+TEST_CASE( "SpatialSort Class tests", "[spatialsort]" ) {
+    SECTION("Hilbert index - neighbouring cells along the curve") {
+        // consecutive indices of a full curve on a 4x4 corner of the grid are adjacent cells
+        std::map<uint32_t, std::pair<uint32_t, uint32_t>> cells;
+        for (uint32_t y = 0; y < 4; ++y) {
+            for (uint32_t x = 0; x < 4; ++x) {
+                cells[SpatialSort::hilbertIndex(x, y)] = std::make_pair(x, y);
+            }
+        }
+
+        REQUIRE(cells.size() == 16);
+        REQUIRE(cells.begin()->first == 0);
+        REQUIRE(cells.rbegin()->first == 15);
+
+        auto previous = cells.begin();
+        for (auto it = std::next(cells.begin()); it != cells.end(); ++it, ++previous) {
+            const int dx = std::abs(static_cast<int>(it->second.first) - static_cast<int>(previous->second.first));
+            const int dy = std::abs(static_cast<int>(it->second.second) - static_cast<int>(previous->second.second));
+            REQUIRE(dx + dy == 1);
+        }
+    }
+
+    SECTION("BRIO - small inputs keep their order") {
+        const std::vector<Point<double>> points = TestUtils::gridPoints(5, 5);
+
+        const std::vector<unsigned> order = SpatialSort::brio(points);
+
+        REQUIRE(order.size() == points.size());
+        for (unsigned i = 0; i < order.size(); ++i) {
+            REQUIRE(order[i] == i);
+        }
+    }
+
+    SECTION("BRIO - permutation, deterministic for a seed") {
+        const std::vector<Point<double>> points = TestUtils::gridPoints(50, 50);
+
+        const std::vector<unsigned> order = SpatialSort::brio(points, 7);
+        std::vector<unsigned> sorted = order;
+        std::sort(sorted.begin(), sorted.end());
+
+        REQUIRE(order.size() == points.size());
+        for (unsigned i = 0; i < sorted.size(); ++i) {
+            REQUIRE(sorted[i] == i);
+        }
+
+        REQUIRE(SpatialSort::brio(points, 7) == order);
+        REQUIRE(SpatialSort::brio(points, 8) != order);
+    }
+
+    SECTION("BRIO - last round follows the curve") {
+        const std::vector<Point<double>> points = TestUtils::gridPoints(64, 64);
+
+        const std::vector<unsigned> order = SpatialSort::brio(points);
+
+        // the final round holds half of the points, consecutive ones are close to each other
+        double length = 0.0;
+        for (std::size_t i = order.size()/2 + 1; i < order.size(); ++i) {
+            const Point<double>& a = points[order[i - 1]];
+            const Point<double>& b = points[order[i]];
+            length += std::hypot(a.getX() - b.getX(), a.getY() - b.getY());
+        }
+
+        // a random order of the same points would average about 0.52*64 per step
+        REQUIRE(length/(order.size() - order.size()/2 - 1) < 3.0);
+    }
+
+    SECTION("Delaunay triangulation - same triangles with and without sorting") {
+        std::vector<Point<double>> points;
+        srand(42);
+        for (unsigned i = 0; i < 500; ++i) {
+            points.push_back(Point<double>(rand()/static_cast<double>(RAND_MAX), rand()/static_cast<double>(RAND_MAX), i));
+        }
+
+        Delaunay<double> sorted(points);
+        sorted.triangulate();
+
+        Delaunay<double> unsorted(points);
+        unsorted.setSpatialSort(false);
+        REQUIRE_FALSE(unsorted.getSpatialSort());
+        unsorted.triangulate();
+
+        REQUIRE(sorted.getTriangles().size() == unsorted.getTriangles().size());
+        REQUIRE(TestUtils::triangleIds(sorted.getTriangles()) == TestUtils::triangleIds(unsorted.getTriangles()));
+
+        // ids still point back to the caller's points
+        for (const auto& triangle : sorted.getTriangles()) {
+            REQUIRE(triangle.getA() == points[triangle.getA().getId()]);
+            REQUIRE(triangle.getB() == points[triangle.getB().getId()]);
+            REQUIRE(triangle.getC() == points[triangle.getC().getId()]);
+        }
+    }
+}
@@ -0,0 +1,182 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 Hans-Peter Schadler <hps@abyle.org>
+**
+** This program is free software: you can redistribute it and/or modify it
+** under the terms of the GNU General Public License as published by the Free
+** Software Foundation, either version 3 of the License, or (at your option)
+** any later version.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT
+** ANY WARRANTY; without even the implied warranty of  MERCHANTABILITY or
+** FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+** more details.
+**
+** You should have received a copy of the GNU General Public License along with
+** this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+****************************************************************************/
+
+
+#include <catch.hpp>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <srtmparser.h>
+#include <testutils.h>
+
+namespace {
+    int testHeight(const int row, const int col)
+    {
+        return (row*7 + col*3) % 3000 - 500;
+    }
+
+    void writeTestHgt(const std::string& fileName, const int samples)
+    {
+        TestUtils::writeHgt(fileName, samples, testHeight);
+    }
+}
+
+TEST_CASE( "SRTMParser Class tests", "[srtmparser]" ) {
+    SECTION("Parse a HGT 3 file") {
+        const std::string fileName = "N47E015.hgt";
+        writeTestHgt(fileName, 1201);
+
+        SRTMParser parser(fileName);
+        REQUIRE( parser.parseData() );
+        REQUIRE( parser.getLatOrigin() == 47 );
+        REQUIRE( parser.getLonOrigin() == 15 );
+
+        // row 1200 is the southern edge of the tile
+        REQUIRE( parser.getHeight(47.0, 15.0) == testHeight(1200, 0) );
+        REQUIRE( parser.getHeight(47.5, 15.25) == testHeight(600, 300) );
+        REQUIRE( parser.getHeight(46.5, 15.0) == -10000.0 );
+
+        HgtStatistics statistics = parser.getStatistics();
+        REQUIRE( statistics.voidCount == 0 );
+        REQUIRE( statistics.min == -500 );
+        REQUIRE( statistics.max == 2499 );
+
+        std::remove(fileName.c_str());
+    }
+
+    SECTION("Memory mapped HGT 3 file") {
+        const std::string fileName = "N47E015.hgt";
+        writeTestHgt(fileName, 1201);
+
+        SRTMParser readParser(fileName);
+        SRTMParser mappedParser(fileName);
+        REQUIRE( readParser.parseData(SRTMParser::LoadMode::LOAD_READ) );
+        REQUIRE( mappedParser.parseData(SRTMParser::LoadMode::LOAD_MMAP) );
+
+        HeightRaster readData = readParser.getHeightData();
+        HeightRaster mappedData = mappedParser.getHeightData();
+        REQUIRE( readParser.getStatistics().min == mappedParser.getStatistics().min );
+        REQUIRE( readParser.getStatistics().max == mappedParser.getStatistics().max );
+
+        REQUIRE( readData.rows() == 1201 );
+        REQUIRE( mappedData.rows() == 1201 );
+        for (int row = 0; row < 1201; row += 50) {
+            for (int col = 0; col < 1201; col += 50) {
+                REQUIRE( readData.at(row, col) == testHeight(row, col) );
+                REQUIRE( mappedData.at(row, col) == testHeight(row, col) );
+            }
+        }
+
+        for (double lat = 47.0; lat <= 48.0; lat += 0.0731) {
+            for (double lon = 15.0; lon <= 16.0; lon += 0.0533) {
+                REQUIRE( readParser.getHeight(lat, lon) == mappedParser.getHeight(lat, lon) );
+            }
+        }
+
+        std::remove(fileName.c_str());
+    }
+
+    SECTION("Memory mapped HGT 1 file with interpolation") {
+        const std::string fileName = "N47E015.hgt";
+        writeTestHgt(fileName, 3601);
+
+        SRTMParser readParser(fileName);
+        SRTMParser mappedParser(fileName);
+        REQUIRE( readParser.parseData(SRTMParser::LoadMode::LOAD_READ) );
+        REQUIRE( mappedParser.parseData(SRTMParser::LoadMode::LOAD_MMAP) );
+
+        for (double lat = 47.0; lat <= 48.0; lat += 0.0731) {
+            for (double lon = 15.0; lon <= 16.0; lon += 0.0533) {
+                REQUIRE( readParser.getHeight(lat, lon, SRTMParser::InterpolationType::LINEAR_INTERPOLATION)
+                         == mappedParser.getHeight(lat, lon, SRTMParser::InterpolationType::LINEAR_INTERPOLATION) );
+            }
+        }
+
+        std::remove(fileName.c_str());
+    }
+
+    SECTION("Bilinear interpolation of a HGT 3 file") {
+        const std::string fileName = "N47E015.hgt";
+        writeTestHgt(fileName, 1201);
+
+        SRTMParser parser(fileName);
+        REQUIRE( parser.parseData() );
+
+        // half way between rows 600 and 599 and columns 300 and 301
+        double lat = 47.5 + 0.5/1200.0;
+        double lon = 15.25 + 0.5/1200.0;
+        double expected = 0.25*(testHeight(600, 300) + testHeight(600, 301) + testHeight(599, 300) + testHeight(599, 301));
+        REQUIRE( parser.getHeight(lat, lon, SRTMParser::InterpolationType::LINEAR_INTERPOLATION) == Approx(expected) );
+
+        // on a sample
+        REQUIRE( parser.getHeight(47.5, 15.25, SRTMParser::InterpolationType::LINEAR_INTERPOLATION) == Approx(testHeight(600, 300)) );
+
+        // borders are not extrapolated
+        REQUIRE( parser.getHeight(48.0, 15.25, SRTMParser::InterpolationType::LINEAR_INTERPOLATION) == testHeight(0, 300) );
+        REQUIRE( parser.getHeight(46.9, 15.25, SRTMParser::InterpolationType::LINEAR_INTERPOLATION) == -10000.0 );
+
+        std::remove(fileName.c_str());
+    }
+
+    SECTION("Batch queries match single queries") {
+        const std::string fileName = "N47E015.hgt";
+        const int samples = GENERATE(1201, 3601);
+        writeTestHgt(fileName, samples);
+
+        std::vector<double> latitudes;
+        std::vector<double> longitudes;
+        for (double lat = 46.99; lat <= 48.01; lat += 0.0173) {
+            for (double lon = 14.99; lon <= 16.01; lon += 0.0119) {
+                latitudes.push_back(lat);
+                longitudes.push_back(lon);
+            }
+        }
+        // tile corners and borders
+        latitudes.insert(latitudes.end(), { 47.0, 48.0, 47.0, 48.0, 47.5, 48.0 });
+        longitudes.insert(longitudes.end(), { 15.0, 15.0, 16.0, 16.0, 16.0, 15.5 });
+
+        for (auto loadMode : { SRTMParser::LoadMode::LOAD_READ, SRTMParser::LoadMode::LOAD_MMAP }) {
+            SRTMParser parser(fileName);
+            REQUIRE( parser.parseData(loadMode) );
+
+            for (auto interpolationType : { SRTMParser::InterpolationType::NO_INTERPOLATION, SRTMParser::InterpolationType::LINEAR_INTERPOLATION }) {
+                std::vector<double> heights = parser.getHeights(latitudes, longitudes, interpolationType);
+                REQUIRE( heights.size() == latitudes.size() );
+                for (size_t i = 0; i < heights.size(); i++) {
+                    REQUIRE( heights[i] == parser.getHeight(latitudes[i], longitudes[i], interpolationType) );
+                }
+            }
+        }
+
+        std::remove(fileName.c_str());
+    }
+
+    SECTION("Reject files with invalid size") {
+        const std::string fileName = "N47E015.hgt";
+        writeTestHgt(fileName, 100);
+
+        SRTMParser parser(fileName);
+        REQUIRE( not parser.parseData(SRTMParser::LoadMode::LOAD_READ) );
+        REQUIRE( not parser.parseData(SRTMParser::LoadMode::LOAD_MMAP) );
+
+        std::remove(fileName.c_str());
+    }
+}
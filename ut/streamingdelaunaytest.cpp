@@ -0,0 +1,128 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 Hans-Peter Schadler <hps@abyle.org>
+**
+** This program is free software: you can redistribute it and/or modify it
+** under the terms of the GNU General Public License as published by the Free
+** Software Foundation, either version 3 of the License, or (at your option)
+** any later version.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT
+** ANY WARRANTY; without even the implied warranty of  MERCHANTABILITY or
+** FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+** more details.
+**
+** You should have received a copy of the GNU General Public License along with
+** this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+****************************************************************************/
+
+
+#include <catch.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <set>
+#include <vector>
+
+#include <delaunay.hpp>
+#include <streamingdelaunay.hpp>
+#include <testutils.h>
+
+TEST_CASE( "StreamingDelaunay Class tests", "[streamingdelaunay]" ) {
+    SECTION("Streaming triangulation - same triangles as Delaunay") {
+        const std::vector<Point<double>> points = TestUtils::randomPoints(20000, 2024);
+        double minX = points[0].getX(), minY = points[0].getY(), maxX = minX, maxY = minY;
+        for (const auto& point : points) {
+            minX = std::min<double>(minX, point.getX());
+            minY = std::min<double>(minY, point.getY());
+            maxX = std::max<double>(maxX, point.getX());
+            maxY = std::max<double>(maxY, point.getY());
+        }
+
+        Delaunay<double> delaunay(points);
+        delaunay.triangulate();
+        std::set<std::vector<uint32_t>> expected;
+        for (const auto& triangle : delaunay.getTriangles()) {
+            expected.insert(TestUtils::sortedIds(triangle));
+        }
+
+        std::set<std::vector<uint32_t>> streamed;
+        bool counterClockwise = true;
+        StreamingDelaunay<double> streaming(minX, minY, maxX, maxY, [&](const Triangle<Point<double>, double>& triangle) {
+            counterClockwise = counterClockwise && Predicates::orient2d(triangle.getA(), triangle.getB(), triangle.getC()) > 0;
+            streamed.insert(TestUtils::sortedIds(triangle));
+        });
+
+        // twenty vertical chunks, each one finalized before the next arrives
+        const unsigned chunks = 20;
+        std::size_t maxActive = 0;
+        for (unsigned chunk = 0; chunk < chunks; chunk++) {
+            const double end = minX + (maxX - minX)*(chunk + 1)/chunks;
+            std::vector<Point<double>> slab;
+            for (const auto& point : points) {
+                if (point.getX() >= streaming.getFront() && (point.getX() < end || chunk + 1 == chunks)) {
+                    slab.push_back(point);
+                }
+            }
+            streaming.insert(slab);
+            maxActive = std::max(maxActive, streaming.getActiveTriangleCount());
+            streaming.finalize(end);
+        }
+        REQUIRE( streaming.getTriangleCount() > 0 );
+        REQUIRE( streaming.getActiveVertexCount() < points.size()/4 );
+        streaming.close();
+        REQUIRE( streaming.isClosed() );
+
+        REQUIRE( counterClockwise );
+        REQUIRE( streamed == expected );
+        REQUIRE( streaming.getTriangleCount() == expected.size() );
+        REQUIRE( streaming.getRejectedCount() == 0 );
+        REQUIRE( maxActive < expected.size()/4 );
+    }
+
+    SECTION("Streaming triangulation - hull points stay until closing") {
+        // a strip 200 points long and 10 wide, swept one row of points at a time
+        const std::vector<Point<double>> points = TestUtils::gridPoints(200, 10);
+        std::size_t triangles = 0;
+        StreamingDelaunay<double> streaming(0, 0, 199, 9, [&](const Triangle<Point<double>, double>&) { triangles++; });
+
+        for (unsigned row = 0; row < 150; row++) {
+            streaming.insert(std::vector<Point<double>>(points.begin() + row*10, points.begin() + (row + 1)*10));
+            streaming.finalize(row + 0.5);
+        }
+
+        // the two long sides of the strip are kept, the inside is not
+        REQUIRE( streaming.getActiveVertexCount() >= 2*150 );
+        REQUIRE( streaming.getActiveVertexCount() <= 2*150 + 10 + 3*10 );
+
+        streaming.insert(std::vector<Point<double>>(points.begin() + 150*10, points.end()));
+        streaming.close();
+        REQUIRE( triangles == 2*199*9 );
+    }
+
+    SECTION("Streaming triangulation - points behind the front and duplicates") {
+        std::size_t triangles = 0;
+        StreamingDelaunay<double> streaming(0, 0, 10, 10, [&](const Triangle<Point<double>, double>&) { triangles++; });
+
+        streaming.insert({ { 0, 0, 0 }, { 0, 10, 1 }, { 4, 5, 2 }, { 4, 5, 3 } });
+        streaming.finalize(5);
+        REQUIRE( streaming.getFront() == 5 );
+
+        // the front does not move back
+        streaming.finalize(2);
+        REQUIRE( streaming.getFront() == 5 );
+
+        streaming.insert({ { 3, 3, 4 }, { 10, 0, 5 }, { 10, 10, 6 } });
+        streaming.close();
+
+        REQUIRE( streaming.getSkippedCount() == 1 );
+        REQUIRE( streaming.getRejectedCount() == 1 );
+        REQUIRE( triangles == 4 );
+
+        // nothing goes in after closing
+        streaming.insert({ { 5, 5, 7 } });
+        REQUIRE( streaming.getRejectedCount() == 2 );
+        REQUIRE( triangles == 4 );
+    }
+}
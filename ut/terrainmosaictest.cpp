@@ -0,0 +1,256 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 Hans-Peter Schadler <hps@abyle.org>
+**
+** This program is free software: you can redistribute it and/or modify it
+** under the terms of the GNU General Public License as published by the Free
+** Software Foundation, either version 3 of the License, or (at your option)
+** any later version.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT
+** ANY WARRANTY; without even the implied warranty of  MERCHANTABILITY or
+** FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+** more details.
+**
+** You should have received a copy of the GNU General Public License along with
+** this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+****************************************************************************/
+
+
+
+#include <catch.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <terrainmosaic.h>
+#include <testutils.h>
+
+namespace {
+    // HGT 3 tile sampling one height function over the whole mosaic, so neighbouring tiles share their borders
+    void writeTestTile(const int latOrigin, const int lonOrigin)
+    {
+        TestUtils::writeHgt(TerrainMosaic::getTileName(latOrigin, lonOrigin), 1201, [latOrigin, lonOrigin](const int row, const int col) {
+            const int y = (latOrigin - 47)*1200 + 1200 - row;
+            const int x = (lonOrigin - 15)*1200 + col;
+            return (y*7 + x*3) % 3000 - 500;
+        });
+    }
+
+    void removeTestTile(const int latOrigin, const int lonOrigin)
+    {
+        std::remove(TerrainMosaic::getTileName(latOrigin, lonOrigin).c_str());
+    }
+}
+
+TEST_CASE( "TerrainMosaic tests", "[terrainmosaic]" ) {
+    SECTION("Tile names") {
+        REQUIRE( TerrainMosaic::getTileName(47, 15) == "N47E015.hgt" );
+        REQUIRE( TerrainMosaic::getTileName(-1, -1) == "S01W001.hgt" );
+        REQUIRE( TerrainMosaic::getTileName(0, -120) == "N00W120.hgt" );
+
+        writeTestTile(-12, -77);
+        SRTMParser parser(TerrainMosaic::getTileName(-12, -77));
+        REQUIRE( parser.getLatOrigin() == -12 );
+        REQUIRE( parser.getLonOrigin() == -77 );
+        removeTestTile(-12, -77);
+    }
+
+    SECTION("Queries across tile borders") {
+        for (int lat = 47; lat <= 48; lat++) {
+            for (int lon = 15; lon <= 16; lon++) {
+                writeTestTile(lat, lon);
+            }
+        }
+
+        TerrainMosaic mosaic(".");
+        SRTMParser south(TerrainMosaic::getTileName(47, 15));
+        REQUIRE( south.parseData() );
+
+        // inside a tile the mosaic answers like the tile itself
+        REQUIRE( mosaic.getHeight(47.3, 15.4, SRTMParser::InterpolationType::LINEAR_INTERPOLATION) ==
+                 south.getHeight(47.3, 15.4, SRTMParser::InterpolationType::LINEAR_INTERPOLATION) );
+
+        // shared border samples agree from both sides
+        REQUIRE( mosaic.getHeight(48.0, 15.5) == south.getHeight(48.0, 15.5) );
+
+        // a grid over all four tiles matches the single queries
+        RegularGrid grid(47.93, 15.91, 0.0013, 0.0017, 97, 83);
+        for (auto interpolationType : { SRTMParser::InterpolationType::NO_INTERPOLATION, SRTMParser::InterpolationType::LINEAR_INTERPOLATION }) {
+            std::vector<double> heights = mosaic.resample(grid, interpolationType, 2);
+            REQUIRE( heights.size() == grid.size() );
+
+            std::vector<double> latitudes;
+            std::vector<double> longitudes;
+            for (int row = 0; row < grid.getRows(); row++) {
+                for (int col = 0; col < grid.getCols(); col++) {
+                    latitudes.push_back(grid.getLatitude(row));
+                    longitudes.push_back(grid.getLongitude(col));
+                }
+            }
+            std::vector<double> batch = mosaic.getHeights(latitudes, longitudes, interpolationType);
+
+            for (std::size_t i = 0; i < heights.size(); i++) {
+                double expected = mosaic.getHeight(latitudes[i], longitudes[i], interpolationType);
+                REQUIRE( expected > -10000.0 );
+                REQUIRE( heights[i] == Approx(expected).margin(1e-6) );
+                REQUIRE( batch[i] == expected );
+            }
+        }
+        REQUIRE( mosaic.getCachedTileCount() == 4 );
+
+        for (int lat = 47; lat <= 48; lat++) {
+            for (int lon = 15; lon <= 16; lon++) {
+                removeTestTile(lat, lon);
+            }
+        }
+    }
+
+    SECTION("Missing tiles") {
+        writeTestTile(47, 15);
+
+        TerrainMosaic mosaic(".");
+        mosaic.setPrefetchDepth(0);
+        REQUIRE( mosaic.getHeight(46.5, 15.5) == -10000.0 );
+        REQUIRE( mosaic.getHeight(47.5, 15.5) > -10000.0 );
+        REQUIRE( mosaic.getHeight(91.0, 15.5) == -10000.0 );
+
+        // N48E015 is missing, its south border is taken from N47E015
+        SRTMParser south(TerrainMosaic::getTileName(47, 15));
+        REQUIRE( south.parseData() );
+        REQUIRE( mosaic.getHeight(48.0, 15.5) == south.getHeight(48.0, 15.5) );
+
+        std::vector<std::string> missing = mosaic.getMissingTiles();
+        REQUIRE( missing.size() == 2 );
+        REQUIRE( missing[0] == "N46E015.hgt" );
+        REQUIRE( missing[1] == "N48E015.hgt" );
+
+        removeTestTile(47, 15);
+    }
+
+    SECTION("Cache stays within the memory budget") {
+        writeTestTile(47, 15);
+        writeTestTile(47, 16);
+
+        SRTMParser parser(TerrainMosaic::getTileName(47, 15));
+        REQUIRE( parser.parseData() );
+        const std::size_t tileSize = parser.getMemoryUsage();
+
+        TerrainMosaic mosaic(".", tileSize + tileSize/2);
+        double west = mosaic.getHeight(47.5, 15.5);
+        REQUIRE( mosaic.getCachedTileCount() == 1 );
+        mosaic.getHeight(47.5, 16.5);
+        REQUIRE( mosaic.getCachedTileCount() == 1 );
+        REQUIRE( mosaic.getMemoryUsage() == tileSize );
+
+        // reloaded after eviction
+        REQUIRE( mosaic.getHeight(47.5, 15.5) == west );
+        REQUIRE( mosaic.getMemoryUsage() <= mosaic.getMemoryBudget() );
+
+        removeTestTile(47, 15);
+        removeTestTile(47, 16);
+    }
+
+    SECTION("Prefetching") {
+        for (int lon = 15; lon <= 17; lon++) {
+            writeTestTile(47, lon);
+            writeTestTile(48, lon);
+        }
+
+        SECTION("Area") {
+            TerrainMosaic mosaic(".");
+            mosaic.setPrefetchDepth(4);
+            mosaic.prefetch(47.2, 48.5, 15.2, 16.8);
+            mosaic.waitForPrefetch();
+            REQUIRE( mosaic.getCachedTileCount() == 4 );
+
+            for (int lat = 47; lat <= 48; lat++) {
+                for (int lon = 15; lon <= 16; lon++) {
+                    REQUIRE( mosaic.getHeight(lat + 0.5, lon + 0.5) > -10000.0 );
+                }
+            }
+
+            // no more than the prefetch depth is loaded ahead of use
+            mosaic.setPrefetchDepth(1);
+            mosaic.prefetch(47.2, 48.5, 15.2, 17.8);
+            mosaic.waitForPrefetch();
+            REQUIRE( mosaic.getCachedTileCount() == 5 );
+        }
+
+        SECTION("Path") {
+            TerrainMosaic mosaic(".");
+            mosaic.prefetch({ 47.5, 47.6, 48.5, 48.5 }, { 15.5, 15.6, 15.5, 16.5 });
+            mosaic.waitForPrefetch();
+            REQUIRE( mosaic.getCachedTileCount() == 2 );
+            mosaic.getHeight(47.5, 15.5);
+            mosaic.waitForPrefetch();
+            REQUIRE( mosaic.getCachedTileCount() == 3 );
+        }
+
+        SECTION("Queries keep the explicit prefetches") {
+            TerrainMosaic mosaic(".");
+            mosaic.prefetch({ 48.5 }, { 17.5 });
+            mosaic.getHeights({ 47.5, 47.5 }, { 15.5, 16.5 });
+            mosaic.waitForPrefetch();
+
+            // answered from the cache once the file is gone, the tile guessed from this
+            // query's direction may be missing
+            removeTestTile(48, 17);
+            REQUIRE( mosaic.getHeight(48.5, 17.5) > -10000.0 );
+            const std::vector<std::string> missing = mosaic.getMissingTiles();
+            REQUIRE( std::find(missing.begin(), missing.end(), "N48E017.hgt") == missing.end() );
+            writeTestTile(48, 17);
+        }
+
+        SECTION("Query direction") {
+            TerrainMosaic mosaic(".");
+            mosaic.getHeight(47.5, 15.5);
+            mosaic.getHeight(47.5, 16.5);
+            mosaic.waitForPrefetch();
+            REQUIRE( mosaic.getCachedTileCount() == 3 );
+
+            // moving on to the east leads to a tile which doesn't exist
+            mosaic.getHeight(47.5, 17.5);
+            mosaic.waitForPrefetch();
+            REQUIRE( mosaic.getMissingTiles() == std::vector<std::string>{ "N47E018.hgt" } );
+        }
+
+        SECTION("Concurrent queries") {
+            TerrainMosaic mosaic(".");
+            TerrainMosaic reference(".");
+            reference.setPrefetchDepth(0);
+
+            std::vector<double> latitudes;
+            std::vector<double> longitudes;
+            for (int i = 0; i < 4000; i++) {
+                latitudes.push_back(47.01 + i*0.00045);
+                longitudes.push_back(15.01 + i*0.00069);
+            }
+            std::vector<double> expected = reference.getHeights(latitudes, longitudes, SRTMParser::InterpolationType::LINEAR_INTERPOLATION);
+
+            std::vector<std::vector<double>> results(4);
+            std::vector<std::thread> threads;
+            for (std::size_t t = 0; t < results.size(); t++) {
+                threads.push_back(std::thread([&, t]() {
+                    results[t] = mosaic.getHeights(latitudes, longitudes, SRTMParser::InterpolationType::LINEAR_INTERPOLATION);
+                }));
+            }
+            for (auto& thread : threads) {
+                thread.join();
+            }
+
+            for (const auto& result : results) {
+                REQUIRE( result == expected );
+            }
+        }
+
+        for (int lon = 15; lon <= 17; lon++) {
+            removeTestTile(47, lon);
+            removeTestTile(48, lon);
+        }
+    }
+}
@@ -0,0 +1,117 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 Hans-Peter Schadler <hps@abyle.org>
+**
+** This program is free software: you can redistribute it and/or modify it
+** under the terms of the GNU General Public License as published by the Free
+** Software Foundation, either version 3 of the License, or (at your option)
+** any later version.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT
+** ANY WARRANTY; without even the implied warranty of  MERCHANTABILITY or
+** FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+** more details.
+**
+** You should have received a copy of the GNU General Public License along with
+** this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+****************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <mesh.hpp>
+#include <point.hpp>
+#include <triangle.hpp>
+
+// Helpers shared by the tests
+namespace TestUtils {
+    // Writes a square HGT tile of samples x samples big-endian heights, height(row, col)
+    // gives the sample of a row counted from the north and a column counted from the west
+    inline void writeHgt(const std::string& fileName, const int samples, const std::function<int(int, int)>& height)
+    {
+        std::ofstream file(fileName, std::ios::binary);
+        for (int row = 0; row < samples; row++) {
+            for (int col = 0; col < samples; col++) {
+                const int value = height(row, col);
+                char c[2] = { char((value >> 8) & 0xFF), char(value & 0xFF) };
+                file.write(c, 2);
+            }
+        }
+    }
+
+    // count points in [0, 100) x [0, 100) on a lattice of steps values per axis, the ids are the positions
+    inline std::vector<Point<double>> randomPoints(const unsigned count, unsigned state, const unsigned steps = 1000000)
+    {
+        std::vector<Point<double>> points;
+        for (unsigned id = 0; id < count; id++) {
+            state = state*1103515245u + 12345u;
+            double x = (state >> 4) % steps / (steps/100.0);
+            state = state*1103515245u + 12345u;
+            double y = (state >> 4) % steps / (steps/100.0);
+            points.push_back({ x, y, id });
+        }
+        return points;
+    }
+
+    // Row-major grid points like GridMesh takes them, x is the row, y the column, the ids are the positions
+    inline std::vector<Point<double>> gridPoints(const unsigned rows, const unsigned cols)
+    {
+        std::vector<Point<double>> points;
+        for (unsigned row = 0; row < rows; row++) {
+            for (unsigned col = 0; col < cols; col++) {
+                points.push_back({ double(row), double(col), row*cols + col });
+            }
+        }
+        return points;
+    }
+
+    // Vertex indices of the triangles, sorted, independent of the corner order and the triangle order
+    template <class F>
+    std::set<std::vector<uint32_t>> triangleSet(const Mesh<F>& mesh)
+    {
+        std::set<std::vector<uint32_t>> triangles;
+        for (uint32_t t = 0; t < mesh.getTriangleCount(); t++) {
+            std::vector<uint32_t> corners { mesh.getIndex(t, 0), mesh.getIndex(t, 1), mesh.getIndex(t, 2) };
+            std::sort(corners.begin(), corners.end());
+            triangles.insert(corners);
+        }
+        return triangles;
+    }
+
+    // Ids of the triangle corners, sorted, for comparing triangulations of different point arrays
+    template <class F>
+    std::vector<uint32_t> sortedIds(const Triangle<Point<F>, F>& triangle)
+    {
+        std::vector<uint32_t> ids { triangle.getA().getId(), triangle.getB().getId(), triangle.getC().getId() };
+        std::sort(ids.begin(), ids.end());
+        return ids;
+    }
+
+    template <class F>
+    std::set<std::vector<uint32_t>> triangleIds(const std::vector<Triangle<Point<F>, F>>& triangles)
+    {
+        std::set<std::vector<uint32_t>> ids;
+        for (const auto& triangle : triangles) {
+            ids.insert(sortedIds(triangle));
+        }
+        return ids;
+    }
+
+    template <class F>
+    std::set<std::vector<uint32_t>> triangleIds(const Mesh<F>& mesh)
+    {
+        std::set<std::vector<uint32_t>> ids;
+        for (uint32_t t = 0; t < mesh.getTriangleCount(); t++) {
+            ids.insert(sortedIds(mesh.getTriangle(t)));
+        }
+        return ids;
+    }
+}
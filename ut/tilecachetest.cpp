@@ -0,0 +1,229 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 Hans-Peter Schadler <hps@abyle.org>
+**
+** This program is free software: you can redistribute it and/or modify it
+** under the terms of the GNU General Public License as published by the Free
+** Software Foundation, either version 3 of the License, or (at your option)
+** any later version.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT
+** ANY WARRANTY; without even the implied warranty of  MERCHANTABILITY or
+** FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+** more details.
+**
+** You should have received a copy of the GNU General Public License along with
+** this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+****************************************************************************/
+
+
+
+#include <catch.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <terrainmosaic.h>
+#include <testutils.h>
+#include <tilecache.h>
+
+namespace {
+    void writeTestHgt(const std::string& fileName, const int samples)
+    {
+        TestUtils::writeHgt(fileName, samples, [](const int row, const int col) {
+            if ((row == 3 && col == 5) || (row == 1000 && col == 1000)) {
+                return int(HgtDecoder::VOID_VALUE);
+            }
+            return (row*17 + col*29) % 3500 - 400;
+        });
+    }
+}
+
+TEST_CASE( "TileCache tests", "[tilecache]" ) {
+    const std::string hgtFileName = "N47E015.hgt";
+    const std::string cacheFileName = std::string("N47E015.hgt") + TileCache::FILE_EXTENSION;
+
+    SECTION("Written caches read back the tile") {
+        const int samples = GENERATE(1201, 3601);
+        writeTestHgt(hgtFileName, samples);
+
+        SRTMParser parser(hgtFileName);
+        REQUIRE( parser.parseData() );
+        REQUIRE( parser.writeCache(cacheFileName) );
+        REQUIRE( TileCache::isTileCache(cacheFileName) );
+        REQUIRE( not TileCache::isTileCache(hgtFileName) );
+
+        TileCache tileCache;
+        REQUIRE( tileCache.open(cacheFileName) );
+        REQUIRE( tileCache.getLatOrigin() == 47 );
+        REQUIRE( tileCache.getLonOrigin() == 15 );
+        REQUIRE( tileCache.getSampleCount() == samples );
+        REQUIRE( tileCache.getStatistics().voidCount == 2 );
+        REQUIRE( tileCache.getStatistics().min == parser.getStatistics().min );
+        REQUIRE( tileCache.getStatistics().max == parser.getStatistics().max );
+
+        const HeightRaster expected = parser.getHeightData();
+        const HeightRaster heightData = tileCache.getHeightData();
+        REQUIRE( not heightData.isWritable() );
+        REQUIRE( reinterpret_cast<std::uintptr_t>(heightData.data()) % HeightRaster::ALIGNMENT == 0 );
+        int mismatches = 0;
+        for (int row = 0; row < samples; row++) {
+            mismatches += not std::equal(expected.rowData(row), expected.rowData(row) + samples, heightData.rowData(row));
+        }
+        REQUIRE( mismatches == 0 );
+
+        // block summary
+        const int blockSize = tileCache.getBlockSize();
+        REQUIRE( blockSize == TileCache::DEFAULT_BLOCK_SIZE );
+        REQUIRE( tileCache.getBlockCount() == (samples + blockSize - 1)/blockSize );
+        for (int blockRow = 0; blockRow < tileCache.getBlockCount(); blockRow += 3) {
+            for (int blockCol = 0; blockCol < tileCache.getBlockCount(); blockCol += 5) {
+                int16_t blockMin = INT16_MAX;
+                int16_t blockMax = INT16_MIN;
+                for (int row = blockRow*blockSize; row < std::min(samples, (blockRow + 1)*blockSize); row++) {
+                    for (int col = blockCol*blockSize; col < std::min(samples, (blockCol + 1)*blockSize); col++) {
+                        if (expected.at(row, col) != HgtDecoder::VOID_VALUE) {
+                            blockMin = std::min(blockMin, expected.at(row, col));
+                            blockMax = std::max(blockMax, expected.at(row, col));
+                        }
+                    }
+                }
+                REQUIRE( tileCache.getBlockMin(blockRow, blockCol) == blockMin );
+                REQUIRE( tileCache.getBlockMax(blockRow, blockCol) == blockMax );
+            }
+        }
+
+        // the parser answers the same from the cache, in both load modes
+        for (auto loadMode : { SRTMParser::LoadMode::LOAD_READ, SRTMParser::LoadMode::LOAD_MMAP }) {
+            SRTMParser cached(cacheFileName);
+            REQUIRE( cached.parseData(loadMode) );
+            REQUIRE( cached.getLatOrigin() == 47 );
+            REQUIRE( cached.getStatistics().voidCount == 2 );
+            for (double lat = 47.0; lat <= 48.0; lat += 0.0731) {
+                for (double lon = 15.0; lon <= 16.0; lon += 0.0917) {
+                    REQUIRE( cached.getHeight(lat, lon, SRTMParser::InterpolationType::LINEAR_INTERPOLATION) ==
+                             parser.getHeight(lat, lon, SRTMParser::InterpolationType::LINEAR_INTERPOLATION) );
+                }
+            }
+        }
+
+        std::remove(hgtFileName.c_str());
+        std::remove(cacheFileName.c_str());
+    }
+
+    SECTION("Writers of the same tile don't share the temporary file") {
+        writeTestHgt(hgtFileName, 1201);
+        SRTMParser parser(hgtFileName);
+        REQUIRE( parser.parseData() );
+        const HeightRaster expected = parser.getHeightData();
+
+        std::atomic<int> failures(0);
+        std::vector<std::thread> writers;
+        for (int writer = 0; writer < 4; writer++) {
+            writers.push_back(std::thread([&]() {
+                for (int run = 0; run < 5; run++) {
+                    failures += not TileCache::write(cacheFileName, expected, 47, 15, parser.getStatistics());
+                }
+            }));
+        }
+        for (auto& writer : writers) {
+            writer.join();
+        }
+        REQUIRE( failures == 0 );
+
+        TileCache tileCache;
+        REQUIRE( tileCache.open(cacheFileName) );
+        const HeightRaster heightData = tileCache.getHeightData();
+        int mismatches = 0;
+        for (int row = 0; row < 1201; row++) {
+            mismatches += not std::equal(expected.rowData(row), expected.rowData(row) + 1201, heightData.rowData(row));
+        }
+        REQUIRE( mismatches == 0 );
+
+        std::remove(hgtFileName.c_str());
+        std::remove(cacheFileName.c_str());
+    }
+
+    SECTION("Caches of another version or damaged caches are rejected") {
+        writeTestHgt(hgtFileName, 1201);
+        SRTMParser parser(hgtFileName);
+        REQUIRE( parser.parseData() );
+        REQUIRE( parser.writeCache(cacheFileName) );
+
+        {
+            std::fstream file(cacheFileName, std::ios::binary | std::ios::in | std::ios::out);
+            file.seekp(8);
+            char version = char(TileCache::VERSION + 1);
+            file.write(&version, 1);
+        }
+        TileCache tileCache;
+        REQUIRE( not tileCache.open(cacheFileName) );
+
+        // truncated
+        REQUIRE( parser.writeCache(cacheFileName) );
+        std::string content;
+        {
+            std::ifstream file(cacheFileName, std::ios::binary);
+            content.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        }
+        {
+            std::ofstream file(cacheFileName, std::ios::binary | std::ios::trunc);
+            file.write(content.data(), content.size() - 100);
+        }
+        REQUIRE( not tileCache.open(cacheFileName) );
+
+        // header fields overwritten with little-endian values
+        auto corrupt = [&cacheFileName, &content](const std::streamoff offset, const uint64_t value, const int bytes) {
+            std::ofstream file(cacheFileName, std::ios::binary | std::ios::trunc);
+            file.write(content.data(), content.size());
+            file.seekp(offset);
+            for (int i = 0; i < bytes; i++) {
+                const char byte = char((value >> (8*i)) & 0xFF);
+                file.write(&byte, 1);
+            }
+        };
+        const uint64_t stride = HeightRaster::alignedStride(1201);
+
+        // an offset which wraps around the end of the address range
+        corrupt(48, 0 - 1201*stride*sizeof(int16_t), 8);
+        REQUIRE( not tileCache.open(cacheFileName) );
+        // rows overlapping each other
+        corrupt(24, 1200, 4);
+        REQUIRE( not tileCache.open(cacheFileName) );
+        // rows not aligned
+        corrupt(24, 1201, 4);
+        REQUIRE( not tileCache.open(cacheFileName) );
+        corrupt(24, stride, 4);
+        REQUIRE( tileCache.open(cacheFileName) );
+
+        std::remove(hgtFileName.c_str());
+        std::remove(cacheFileName.c_str());
+    }
+
+    SECTION("The mosaic fills and uses the cache folder") {
+        writeTestHgt(hgtFileName, 1201);
+
+        double height;
+        {
+            TerrainMosaic mosaic(".");
+            mosaic.setCacheFolder(".");
+            height = mosaic.getHeight(47.51, 15.49, SRTMParser::InterpolationType::LINEAR_INTERPOLATION);
+        }
+        REQUIRE( TileCache::isTileCache(cacheFileName) );
+
+        // the cache is enough from now on
+        std::remove(hgtFileName.c_str());
+        TerrainMosaic mosaic(".");
+        mosaic.setCacheFolder(".");
+        REQUIRE( mosaic.getHeight(47.51, 15.49, SRTMParser::InterpolationType::LINEAR_INTERPOLATION) == height );
+
+        std::remove(cacheFileName.c_str());
+    }
+}
@@ -0,0 +1,192 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 Hans-Peter Schadler <hps@abyle.org>
+**
+** This program is free software: you can redistribute it and/or modify it
+** under the terms of the GNU General Public License as published by the Free
+** Software Foundation, either version 3 of the License, or (at your option)
+** any later version.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT
+** ANY WARRANTY; without even the implied warranty of  MERCHANTABILITY or
+** FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+** more details.
+**
+** You should have received a copy of the GNU General Public License along with
+** this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+****************************************************************************/
+
+
+#include <catch.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <predicates.hpp>
+#include <testutils.h>
+#include <tinbuilder.h>
+
+namespace {
+    const int SAMPLES = 1201;
+
+    std::string writeTile(const std::function<int(int, int)>& height)
+    {
+        const std::string fileName = "N46E014.hgt";
+        TestUtils::writeHgt(fileName, SAMPLES, height);
+        return fileName;
+    }
+
+    // Largest distance of the samples to the mesh, the vertex ids are the sample indices
+    double maxMeshError(const Mesh<double>& mesh, const std::function<int(int, int)>& height, std::size_t& visited)
+    {
+        double maxError = 0.0;
+        visited = 0;
+        for (uint32_t t = 0; t < mesh.getTriangleCount(); t++) {
+            double x[3], y[3], h[3];
+            for (unsigned c = 0; c < 3; c++) {
+                const unsigned id = mesh.getCorner(t, c).getId();
+                x[c] = id % SAMPLES;
+                y[c] = id / SAMPLES;
+                h[c] = height(y[c], x[c]);
+            }
+            const double area = Predicates::orient2d(x[0], y[0], x[1], y[1], x[2], y[2]);
+            if (area <= 0) {
+                return -1.0;
+            }
+
+            const int minX = std::min(x[0], std::min(x[1], x[2])), maxX = std::max(x[0], std::max(x[1], x[2]));
+            const int minY = std::min(y[0], std::min(y[1], y[2])), maxY = std::max(y[0], std::max(y[1], y[2]));
+            for (int row = minY; row <= maxY; row++) {
+                for (int col = minX; col <= maxX; col++) {
+                    const double w0 = Predicates::orient2d(x[1], y[1], x[2], y[2], col, row)/area;
+                    const double w1 = Predicates::orient2d(x[2], y[2], x[0], y[0], col, row)/area;
+                    const double w2 = Predicates::orient2d(x[0], y[0], x[1], y[1], col, row)/area;
+                    if (w0 < 0 || w1 < 0 || w2 < 0) {
+                        continue;
+                    }
+                    visited++;
+                    maxError = std::max(maxError, std::fabs(height(row, col) - (w0*h[0] + w1*h[1] + w2*h[2])));
+                }
+            }
+        }
+        return maxError;
+    }
+}
+
+TEST_CASE( "TinBuilder tests", "[tinbuilder]" ) {
+    SECTION("Planar tile needs the corners only") {
+        auto plane = [](int row, int col) { return 100 + row + 2*col; };
+        const std::string fileName = writeTile(plane);
+        SRTMParser parser(fileName);
+        REQUIRE( parser.parseData() );
+
+        TinBuilder tin(parser);
+        REQUIRE( tin.getTolerance() == TinBuilder::DEFAULT_TOLERANCE );
+        REQUIRE( tin.build() );
+
+        const Mesh<double>& mesh = tin.getMesh();
+        REQUIRE( mesh.getVertexCount() == 4 );
+        REQUIRE( mesh.getTriangleCount() == 2 );
+        REQUIRE( tin.getMaxError() <= TinBuilder::DEFAULT_TOLERANCE );
+
+        // corners in latitude and longitude with their heights
+        for (std::size_t v = 0; v < mesh.getVertexCount(); v++) {
+            const unsigned id = mesh.getVertex(v).getId();
+            const int row = id / SAMPLES, col = id % SAMPLES;
+            REQUIRE( mesh.getVertex(v).getX() == Approx(47.0 - row/1200.0) );
+            REQUIRE( mesh.getVertex(v).getY() == Approx(14.0 + col/1200.0) );
+            REQUIRE( tin.getHeights()[v] == plane(row, col) );
+        }
+
+        std::remove(fileName.c_str());
+    }
+
+    SECTION("Error bound") {
+        auto hills = [](int row, int col) { return int(300.0*std::sin(row/90.0)*std::cos(col/130.0) + 0.2*row); };
+        const std::string fileName = writeTile(hills);
+        SRTMParser parser(fileName);
+        REQUIRE( parser.parseData() );
+
+        TinBuilder tin(parser);
+        tin.setTolerance(3.0);
+        REQUIRE( tin.build() );
+        const Mesh<double>& mesh = tin.getMesh();
+
+        REQUIRE( mesh.getVertexCount() > 4 );
+        REQUIRE( mesh.getVertexCount() < std::size_t(SAMPLES)*SAMPLES/50 );
+        REQUIRE( tin.getMaxError() <= 3.0 );
+
+        // every sample is covered and within the tolerance
+        std::size_t visited = 0;
+        REQUIRE( maxMeshError(mesh, hills, visited) <= 3.0 + 1e-9 );
+        REQUIRE( visited >= std::size_t(SAMPLES)*SAMPLES );
+
+        // the neighbours match the shared edges
+        Mesh<double> rebuilt = mesh;
+        rebuilt.buildAdjacency();
+        REQUIRE( rebuilt.getNeighbours() == mesh.getNeighbours() );
+
+        std::remove(fileName.c_str());
+    }
+
+    SECTION("Vertex budget") {
+        auto hills = [](int row, int col) { return int(300.0*std::sin(row/40.0)*std::cos(col/30.0)); };
+        const std::string fileName = writeTile(hills);
+        SRTMParser parser(fileName);
+        REQUIRE( parser.parseData() );
+
+        TinBuilder tin(parser);
+        tin.setTolerance(0.0);
+        tin.setMaxVertices(100);
+        REQUIRE( tin.build() );
+
+        REQUIRE( tin.getMesh().getVertexCount() == 100 );
+        REQUIRE( tin.getMaxError() > 0.0 );
+
+        std::size_t visited = 0;
+        REQUIRE( maxMeshError(tin.getMesh(), hills, visited) == Approx(tin.getMaxError()) );
+
+        std::remove(fileName.c_str());
+    }
+
+    SECTION("Void corner") {
+        // the north-west 3x3 samples are void, the first valid ring around the corner has 500 m
+        auto voidCorner = [](int row, int col) { return (row < 3 && col < 3) ? -32768 : 500 + (row + col)/100; };
+        const std::string fileName = writeTile(voidCorner);
+        SRTMParser parser(fileName);
+        REQUIRE( parser.parseData() );
+
+        TinBuilder tin(parser);
+        REQUIRE( tin.build() );
+        const Mesh<double>& mesh = tin.getMesh();
+
+        bool hasCorner = false;
+        for (std::size_t v = 0; v < mesh.getVertexCount(); v++) {
+            hasCorner = hasCorner || mesh.getVertex(v).getId() == 0;
+            if (mesh.getVertex(v).getId() == 0) {
+                REQUIRE( tin.getHeights()[v] == 500.0 );
+            }
+            REQUIRE( tin.getHeights()[v] >= 500.0 );
+        }
+        REQUIRE( hasCorner );
+        REQUIRE( tin.getMaxError() <= TinBuilder::DEFAULT_TOLERANCE );
+
+        std::remove(fileName.c_str());
+    }
+
+    SECTION("Void tile") {
+        const std::string fileName = writeTile([](int, int) { return -32768; });
+        SRTMParser parser(fileName);
+        REQUIRE( parser.parseData() );
+
+        TinBuilder tin(parser);
+        REQUIRE( not tin.build() );
+
+        std::remove(fileName.c_str());
+    }
+}
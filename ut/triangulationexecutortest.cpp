@@ -0,0 +1,127 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 Hans-Peter Schadler <hps@abyle.org>
+**
+** This program is free software: you can redistribute it and/or modify it
+** under the terms of the GNU General Public License as published by the Free
+** Software Foundation, either version 3 of the License, or (at your option)
+** any later version.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT
+** ANY WARRANTY; without even the implied warranty of  MERCHANTABILITY or
+** FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+** more details.
+**
+** You should have received a copy of the GNU General Public License along with
+** this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+****************************************************************************/
+
+
+#include <catch.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <set>
+#include <vector>
+
+#include <delaunay.hpp>
+#include <gridmesh.hpp>
+#include <testutils.h>
+#include <triangulationexecutor.hpp>
+
+namespace {
+    // Heights with varying slopes, so the height diagonal differs from cell to cell
+    std::vector<double> gridHeights(const unsigned rows, const unsigned cols)
+    {
+        std::vector<double> heights;
+        for (unsigned row = 0; row < rows; row++) {
+            for (unsigned col = 0; col < cols; col++) {
+                heights.push_back(double((row*row*7 + col*13 + row*col*5) % 23));
+            }
+        }
+        return heights;
+    }
+}
+
+TEST_CASE( "TriangulationExecutor Class tests", "[triangulationexecutor]" ) {
+    SECTION("TriangulationExecutor - point sets and grids on several threads") {
+        TriangulationExecutor<double> executor(3);
+        REQUIRE( executor.getThreads() == 3 );
+
+        // point sets of very different size, so the workers have to steal
+        std::vector<std::set<std::vector<uint32_t>>> expected;
+        std::vector<std::vector<double>> expectedHeights;
+        for (unsigned job = 0; job < 12; job++) {
+            const unsigned count = (job % 4 == 0) ? 20000 : 200 + 50*job;
+            REQUIRE( executor.addPoints([count, job](std::vector<Point<double>>& points, std::vector<double>& heights) {
+                points = TestUtils::randomPoints(count, job + 1, 100000);
+                heights.assign(points.size(), double(job));
+            }) == job );
+
+            Delaunay<double> delaunay(TestUtils::randomPoints(count, job + 1, 100000));
+            delaunay.triangulate();
+            expected.push_back(TestUtils::triangleSet(delaunay.getMesh()));
+            expectedHeights.push_back(std::vector<double>(count, double(job)));
+        }
+        for (unsigned job = 12; job < 16; job++) {
+            REQUIRE( executor.addGrid(job, 30, [job](std::vector<Point<double>>& points, std::vector<double>& heights) {
+                points = TestUtils::gridPoints(job, 30);
+                heights = gridHeights(job, 30);
+            }, GridMesh<double>::HEIGHT_DIAGONAL) == job );
+
+            Mesh<double> mesh;
+            REQUIRE( GridMesh<double>::build(TestUtils::gridPoints(job, 30), job, 30, mesh, GridMesh<double>::HEIGHT_DIAGONAL, gridHeights(job, 30)) );
+            expected.push_back(TestUtils::triangleSet(mesh));
+            expectedHeights.push_back(gridHeights(job, 30));
+
+            // the heights pick other diagonals than the forward ones
+            Mesh<double> forward;
+            GridMesh<double>::build(TestUtils::gridPoints(job, 30), job, 30, forward);
+            REQUIRE( TestUtils::triangleSet(forward) != expected.back() );
+        }
+        REQUIRE( executor.getJobCount() == 16 );
+
+        std::mutex mutex;
+        std::vector<unsigned> written(16, 0);
+        std::vector<std::set<std::vector<uint32_t>>> results(16);
+        std::vector<char> heightsPassed(16, 0);
+        const std::size_t failed = executor.run([&](const std::size_t job, const Mesh<double>& mesh, const std::vector<double>& heights) {
+            // Catch assertions are not thread safe, check on the main thread
+            std::set<std::vector<uint32_t>> triangles = TestUtils::triangleSet(mesh);
+            std::lock_guard<std::mutex> lock(mutex);
+            written[job]++;
+            results[job] = triangles;
+            heightsPassed[job] = heights.size() == mesh.getVertexCount() && heights == expectedHeights[job];
+        });
+
+        REQUIRE( failed == 0 );
+        REQUIRE( executor.getJobCount() == 0 );
+        REQUIRE( written == std::vector<unsigned>(16, 1) );
+        REQUIRE( results == expected );
+        REQUIRE( heightsPassed == std::vector<char>(16, 1) );
+        REQUIRE( executor.getMemoryUsage() > 0 );
+    }
+
+    SECTION("TriangulationExecutor - failed jobs are not written") {
+        TriangulationExecutor<double> executor(2);
+        executor.addGrid(4, 4, [](std::vector<Point<double>>& points, std::vector<double>&) {
+            points = TestUtils::gridPoints(4, 3);
+        });
+        executor.addPoints([](std::vector<Point<double>>& points, std::vector<double>&) {
+            points = TestUtils::randomPoints(100, 7, 100000);
+        });
+
+        std::vector<std::size_t> written;
+        std::mutex mutex;
+        REQUIRE( executor.run([&](const std::size_t job, const Mesh<double>&, const std::vector<double>&) {
+            std::lock_guard<std::mutex> lock(mutex);
+            written.push_back(job);
+        }) == 1 );
+        REQUIRE( written == std::vector<std::size_t>{ 1 } );
+
+        // nothing left to run
+        REQUIRE( executor.run([](const std::size_t, const Mesh<double>&, const std::vector<double>&) {}) == 0 );
+    }
+}
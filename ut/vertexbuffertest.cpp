@@ -0,0 +1,90 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 Hans-Peter Schadler <hps@abyle.org>
+**
+** This program is free software: you can redistribute it and/or modify it
+** under the terms of the GNU General Public License as published by the Free
+** Software Foundation, either version 3 of the License, or (at your option)
+** any later version.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT
+** ANY WARRANTY; without even the implied warranty of  MERCHANTABILITY or
+** FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+** more details.
+**
+** You should have received a copy of the GNU General Public License along with
+** this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+****************************************************************************/
+
+
+#include <catch.hpp>
+
+#include <vector>
+
+#include <delaunay.hpp>
+#include <point.hpp>
+#include <vertexbuffer.hpp>
+
+TEST_CASE( "VertexBuffer Class tests", "[vertexbuffer]" ) {
+    SECTION("Add vertices") {
+        VertexBuffer<double> vertices;
+        REQUIRE( vertices.empty() );
+
+        vertices.add(1.5, -2.0, 300.0, 4);
+        vertices.add(Point<double>(0.1, 0.2, 5), 12.0);
+
+        REQUIRE( vertices.size() == 2 );
+        REQUIRE( vertices.getXs() == (std::vector<double>{ 1.5, 0.1 }) );
+        REQUIRE( vertices.getYs() == (std::vector<double>{ -2.0, 0.2 }) );
+        REQUIRE( vertices.getZs() == (std::vector<double>{ 300.0, 12.0 }) );
+        REQUIRE( vertices.getIds() == (std::vector<unsigned>{ 4, 5 }) );
+        REQUIRE( vertices.getPoint(1) == Point<double>(0.1, 0.2) );
+        REQUIRE( vertices.getPoint(1).getId() == 5 );
+        REQUIRE( vertices.getPoint2(0) == Point2<double>(1.5, -2.0) );
+
+        vertices.clear();
+        REQUIRE( vertices.empty() );
+    }
+
+    SECTION("Convert from and to points") {
+        std::vector<Point<double>> points { { 0.0, 1.0, 10 }, { 2.0, 3.0, 11 }, { 4.0, 5.0, 12 } };
+
+        VertexBuffer<double> flat(points);
+        REQUIRE( flat.getZs() == (std::vector<double>{ 0.0, 0.0, 0.0 }) );
+
+        VertexBuffer<double> vertices(points, std::vector<double>{ 100.0, 200.0, 300.0 });
+        REQUIRE( vertices.getZ(2) == 300.0 );
+
+        std::vector<Point<double>> back = vertices.toPoints();
+        REQUIRE( back == points );
+        for (std::size_t i = 0; i < points.size(); i++) {
+            REQUIRE( back[i].getId() == points[i].getId() );
+        }
+
+        // heights have to match the points
+        REQUIRE( not vertices.assign(points, std::vector<double>{ 1.0 }) );
+        REQUIRE( vertices.empty() );
+    }
+
+    SECTION("Triangulate a vertex buffer") {
+        VertexBuffer<double> vertices;
+        unsigned id = 0;
+        for (int row = 0; row < 10; row++) {
+            for (int col = 0; col < 10; col++) {
+                vertices.add(col, row, row*col, id++);
+            }
+        }
+
+        Delaunay<double> delaunay;
+        delaunay.setPoints(vertices);
+        delaunay.triangulate();
+
+        const Mesh<double>& mesh = delaunay.getMesh();
+        REQUIRE( mesh.getTriangleCount() == 2*9*9 );
+        REQUIRE( mesh.getVertexCount() == vertices.size() );
+        for (uint32_t v = 0; v < mesh.getVertexCount(); v++) {
+            REQUIRE( mesh.getVertices()[v].getId() == vertices.getId(v) );
+        }
+    }
+}